@@ -0,0 +1,219 @@
+#include <string.h>
+
+#include "defs.h"
+#include "types.h"
+#include "fold.h"
+#include "alias.h"
+
+typedef struct mem_access MemAccess;
+
+/// A memory access, reduced to the variable it is based on.
+struct mem_access {
+	SymEntry* var;			// Variable the access is based on, or NULL if unknown
+	bool object;			// The variable is the accessed object itself, rather than a pointer to it
+	bool restricted;		// The pointer the access is based on is restrict-qualified
+	bool offsetKnown;
+	long long offset;		// Byte offset from the start of the object, or from the pointer
+	PrimordialType type;
+	int size;
+};
+
+static bool ListContains(DbLnkList* list, SymEntry* var){
+	for(; list != NULL; list = list->next)
+		if(list->val == var)
+			return true;
+	return false;
+}
+
+static void DescribeAccess(ASTNode* node, MemAccess* access){
+	access->var = NULL;
+	access->object = false;
+	access->restricted = false;
+	access->offsetKnown = true;
+	access->offset = 0;
+	access->type = node->type;
+	access->size = GetTypeSize(node->type, node->cType);
+	if(node->op == A_VarRef){
+		access->var = node->symbol;
+		access->object = true;
+		return;
+	}
+	if(node->op != A_Dereference)
+		return;
+	// Walk the address down to the pointer or object it is based on
+	ASTNode* address = node->lhs;
+	while(address != NULL){
+		long long value = 0;
+		switch(address->op){
+			case A_Cast:
+				address = address->lhs;
+				break;
+			case A_Add:
+				if(EvaluateConstant(address->rhs, &value)){
+					access->offset += value;
+					address = address->lhs;
+				}
+				else if(EvaluateConstant(address->lhs, &value)){
+					access->offset += value;
+					address = address->rhs;
+				}
+				else if(IsPointer(address->lhs->type) != IsPointer(address->rhs->type)){
+					access->offsetKnown = false;
+					address = IsPointer(address->lhs->type) ? address->lhs : address->rhs;
+				}
+				else
+					return;
+				break;
+			case A_Subtract:
+				if(EvaluateConstant(address->rhs, &value))
+					access->offset -= value;
+				else
+					access->offsetKnown = false;
+				address = address->lhs;
+				break;
+			case A_AddressOf:
+				if(address->lhs->op == A_Dereference){
+					address = address->lhs->lhs;
+					break;
+				}
+				if(address->lhs->op == A_VarRef){
+					access->var = address->lhs->symbol;
+					access->object = true;
+				}
+				return;
+			case A_VarRef:
+				// Arrays decay to their own address, while pointers hold the address of something else
+				access->var = address->symbol;
+				access->object = !address->lvalue;
+				access->restricted = !access->object && (address->qualifiers & Q_Restrict);
+				return;
+			default:
+				return;
+		}
+	}
+}
+
+static bool IsPrivate(MemAccess* access, AliasContext* context){
+	return access->object && access->var != NULL
+		&& ListContains(context->locals, access->var) && !ListContains(context->addressTaken, access->var);
+}
+
+/// @brief Reduce a type to the class of types that may access it; Signedness doesn't matter.
+static PrimordialType AliasClass(PrimordialType type){
+	PrimordialType base = type & 0xF0;
+	if(base >= P_UChar && base <= P_ULongLong)
+		return type - P_UNSIGNED_DIFF;
+	return type;
+}
+
+static bool TypesMayAlias(PrimordialType lhs, PrimordialType rhs){
+	lhs = AliasClass(lhs);
+	rhs = AliasClass(rhs);
+	// Character types may access any object
+	if(lhs == P_Char || rhs == P_Char)
+		return true;
+	// Composites contain members of other types
+	if((lhs & 0xF0) == P_Composite || (rhs & 0xF0) == P_Composite)
+		return true;
+	if((lhs & 0xF0) == P_Undefined || (rhs & 0xF0) == P_Undefined || (lhs & 0xF0) == P_Void || (rhs & 0xF0) == P_Void)
+		return true;
+	return lhs == rhs;
+}
+
+bool MayAlias(ASTNode* lhs, ASTNode* rhs, AliasContext* context){
+	MemAccess a;
+	MemAccess b;
+	DescribeAccess(lhs, &a);
+	DescribeAccess(rhs, &b);
+	if(a.var != NULL && b.var != NULL){
+		if(a.object == b.object && a.var == b.var){
+			// Accesses from the same base overlap unless constant offsets keep them apart
+			if(!a.offsetKnown || !b.offsetKnown)
+				return true;
+			return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+		}
+		if(a.object && b.object)
+			return false;
+		// Objects accessed through a restrict pointer are accessed only through it
+		if((a.object || a.restricted) && (b.object || b.restricted))
+			return false;
+	}
+	if(IsPrivate(&a, context) || IsPrivate(&b, context))
+		return false;
+	return TypesMayAlias(a.type, b.type);
+}
+
+bool ReadsAliased(ASTNode* expr, ASTNode* store, AliasContext* context){
+	if(expr == NULL)
+		return false;
+	switch(expr->op){
+		case A_AddressOf:
+			// Taking an address doesn't read the object
+			if(expr->lhs->op == A_Dereference)
+				return ReadsAliased(expr->lhs->lhs, store, context);
+			return expr->lhs->op != A_VarRef && ReadsAliased(expr->lhs, store, context);
+		case A_VarRef:
+			return expr->lvalue && MayAlias(expr, store, context);
+		case A_Dereference:
+			if(MayAlias(expr, store, context))
+				return true;
+			break;
+		case A_FunctionCall:
+			// Pure functions may read any memory which isn't private to the caller
+			if((expr->attributes & AT_Pure) && !(expr->attributes & AT_Const) && !IsPrivateAccess(store, context))
+				return true;
+			break;
+		default:
+			break;
+	}
+	if(ReadsAliased(expr->lhs, store, context) || ReadsAliased(expr->mid, store, context) || ReadsAliased(expr->rhs, store, context))
+		return true;
+	ASTNodeList* list = expr->list;
+	if(expr->op == A_FunctionCall || expr->op == A_BuiltinCall)
+		list = expr->secondaryValue.ptrVal;
+	if(list != NULL)
+		for(int i = 0; i < list->count; i++)
+			if(ReadsAliased(list->nodes[i], store, context))
+				return true;
+	return false;
+}
+
+bool IsPrivateAccess(ASTNode* lvalue, AliasContext* context){
+	MemAccess access;
+	DescribeAccess(lvalue, &access);
+	return access.offsetKnown && IsPrivate(&access, context);
+}
+
+/// @brief Find every variable whose address may escape, ignoring the address taken to access a composite member.
+static void CollectAddressTaken(ASTNode* node, AliasContext* context){
+	if(node == NULL)
+		return;
+	if(node->op == A_AddressOf && node->lhs->op == A_VarRef)
+		context->addressTaken = MakeDbLnkList((void*)node->lhs->symbol, NULL, context->addressTaken);
+	// Arrays decay to their address whenever they are used
+	if(node->op == A_Declare && node->mid != NULL)
+		context->addressTaken = MakeDbLnkList((void*)node->symbol, NULL, context->addressTaken);
+	if(node->op == A_Dereference && node->lhs->op == A_Add && node->lhs->lhs->op == A_AddressOf && node->lhs->lhs->lhs->op == A_VarRef)
+		CollectAddressTaken(node->lhs->rhs, context);
+	else{
+		CollectAddressTaken(node->lhs, context);
+		CollectAddressTaken(node->mid, context);
+		CollectAddressTaken(node->rhs, context);
+	}
+	ASTNodeList* list = node->list;
+	if(node->op == A_FunctionCall || node->op == A_BuiltinCall)
+		list = node->secondaryValue.ptrVal;
+	if(list != NULL)
+		for(int i = 0; i < list->count; i++)
+			CollectAddressTaken(list->nodes[i], context);
+}
+
+AliasContext* MakeAliasContext(ASTNode* function){
+	AliasContext* context = malloc(sizeof(AliasContext));
+	context->locals = NULL;
+	context->addressTaken = NULL;
+	for(Parameter* param = function->secondaryValue.ptrVal; param != NULL; param = param->next)
+		context->locals = MakeDbLnkList((void*)param->symbol, NULL, context->locals);
+	CollectAddressTaken(function->lhs, context);
+	return context;
+}
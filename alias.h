@@ -0,0 +1,26 @@
+#ifndef ALIAS_INCLUDED
+#define ALIAS_INCLUDED
+
+#include "defs.h"
+#include "types.h"
+
+typedef struct alias_context AliasContext;
+
+/// Facts about the enclosing function needed to answer alias queries.
+struct alias_context {
+	DbLnkList* locals;			// Entries of the locals and parameters in scope, innermost first
+	DbLnkList* addressTaken;	// Entries of variables whose address is taken anywhere in the function
+};
+
+/// @brief Collect the parameters and address-taken variables of a function.
+AliasContext* MakeAliasContext(ASTNode* function);
+/// @brief Determine whether two lvalues may refer to overlapping memory.
+/// Distinct variables never overlap, locals whose address is never taken can only be accessed by name,
+/// restrict pointers are disjoint, and accesses of different types don't overlap unless either is a character access.
+bool MayAlias(ASTNode* lhs, ASTNode* rhs, AliasContext* context);
+/// @brief Determine whether evaluating an expression may read memory written by a store to an lvalue.
+bool ReadsAliased(ASTNode* expr, ASTNode* store, AliasContext* context);
+/// @brief Determine whether an lvalue is part of a local that can only be accessed by name, and so can't be modified by calls.
+bool IsPrivateAccess(ASTNode* lvalue, AliasContext* context);
+
+#endif
@@ -0,0 +1,1372 @@
+#include "defs.h"
+#include "types.h"
+#include "symTable.h"
+#include "fold.h"
+#include "alias.h"
+
+// Operator traits, used to drive folding
+#define FOLD_UNARY			0x01
+#define FOLD_BINARY			0x02
+#define FOLD_COMMUTATIVE	0x04
+#define FOLD_ASSOCIATIVE	0x08
+#define FOLD_COMPARISON		0x10
+#define FOLD_LOGICAL		0x20
+#define FOLD_SHIFT			0x40
+
+#define SIGN_BIT ((long long)1 << 63)
+
+// Budgets for evaluating calls at compile time; Calls exceeding them are left to run at runtime
+#define FOLD_CALL_STEP_BUDGET	100000
+#define FOLD_CALL_DEPTH_BUDGET	64
+
+static int FoldTraits(NodeType op){
+	switch(op){
+		case A_Negate:
+		case A_BitwiseComplement:
+		case A_LogicalNot:
+		case A_Logicize:			return FOLD_UNARY;
+		case A_Add:
+		case A_Multiply:
+		case A_BitwiseAnd:
+		case A_BitwiseXor:
+		case A_BitwiseOr:			return FOLD_BINARY | FOLD_COMMUTATIVE | FOLD_ASSOCIATIVE;
+		case A_Subtract:
+		case A_Divide:
+		case A_Modulo:				return FOLD_BINARY;
+		case A_LeftShift:
+		case A_RightShift:			return FOLD_BINARY | FOLD_SHIFT;
+		case A_LessThan:
+		case A_GreaterThan:
+		case A_LessOrEqual:
+		case A_GreaterOrEqual:		return FOLD_BINARY | FOLD_COMPARISON;
+		case A_EqualTo:
+		case A_NotEqualTo:			return FOLD_BINARY | FOLD_COMPARISON | FOLD_COMMUTATIVE;
+		case A_LogicalAnd:
+		case A_LogicalOr:			return FOLD_BINARY | FOLD_LOGICAL;
+		default:					return 0;
+	}
+}
+
+/// @brief Get the value which leaves the lhs unchanged when used as the rhs of op.
+/// @return false if op has no such value.
+static bool FoldIdentity(NodeType op, long long* value){
+	switch(op){
+		case A_Add:
+		case A_Subtract:
+		case A_BitwiseOr:
+		case A_BitwiseXor:
+		case A_LeftShift:
+		case A_RightShift:	*value = 0;		return true;
+		case A_Multiply:
+		case A_Divide:		*value = 1;		return true;
+		case A_BitwiseAnd:	*value = -1;	return true;
+		default:			return false;
+	}
+}
+
+/// @brief Get the value which, used as the rhs of op, makes the result independent of the lhs.
+/// @param result [OUT] The result of the operation
+/// @return false if op has no such value.
+static bool FoldAbsorber(NodeType op, long long* value, long long* result){
+	switch(op){
+		case A_Multiply:
+		case A_BitwiseAnd:	*value = 0;		*result = 0;	return true;
+		case A_BitwiseOr:	*value = -1;	*result = -1;	return true;
+		case A_Modulo:		*value = 1;		*result = 0;	return true;
+		default:			return false;
+	}
+}
+
+// Width, in bytes, that an operation producing the given type is carried out in, after integer promotion.
+static int EvalWidth(PrimordialType type){
+	if(IsPointer(type))	return 8;
+	switch(type){
+		case P_Char:
+		case P_UChar:
+		case P_Int:
+		case P_UInt:
+		case P_Long:
+		case P_ULong:		return 4;
+		default:			return 8;
+	}
+}
+
+// Whether an operation producing the given type is carried out unsigned, after integer promotion.
+static bool EvalUnsigned(PrimordialType type){
+	if(IsPointer(type))	return true;
+	switch(type){
+		case P_UInt:
+		case P_ULong:
+		case P_ULongLong:	return true;
+		default:			return false;
+	}
+}
+
+long long NormalizeInt(long long value, int width, bool isUnsigned){
+	if(width <= 0 || width >= 8)	return value;
+	int bits = width * 8;
+	long long mask = ((long long)1 << bits) - 1;
+	value = value & mask;
+	if(!isUnsigned && ((value >> (bits - 1)) & 1))
+		value = value | ~mask;
+	return value;
+}
+
+static bool FoldLessThan(long long lhs, long long rhs, bool isUnsigned){
+	if(isUnsigned)
+		return (lhs ^ SIGN_BIT) < (rhs ^ SIGN_BIT);
+	return lhs < rhs;
+}
+
+/// @brief Evaluate a binary operation as it would be evaluated at runtime for the given type.
+/// @param result [OUT] The result of the operation
+/// @return false if the operation can't be evaluated at compile time (E.G. division by zero).
+static bool EvalBinary(NodeType op, long long lhs, long long rhs, PrimordialType type, long long* result){
+	int width = EvalWidth(type);
+	bool isUnsigned = EvalUnsigned(type);
+	lhs = NormalizeInt(lhs, width, isUnsigned);
+	if(op != A_LeftShift && op != A_RightShift)
+		rhs = NormalizeInt(rhs, width, isUnsigned);
+	long long val = 0;
+	switch(op){
+		case A_Add:				val = (long long)((unsigned long long)lhs + (unsigned long long)rhs);	break;
+		case A_Subtract:		val = (long long)((unsigned long long)lhs - (unsigned long long)rhs);	break;
+		case A_Multiply:		val = (long long)((unsigned long long)lhs * (unsigned long long)rhs);	break;
+		case A_Divide:
+		case A_Modulo:{
+			if(rhs == 0)		return false;
+			long long quotient = 0;
+			if(isUnsigned)
+				quotient = (long long)((unsigned long long)lhs / (unsigned long long)rhs);
+			else if(rhs == -1)
+				quotient = (long long)((unsigned long long)0 - (unsigned long long)lhs);
+			else
+				quotient = lhs / rhs;
+			val = op == A_Divide
+				? quotient
+				: (long long)((unsigned long long)lhs - ((unsigned long long)quotient * (unsigned long long)rhs));
+			break;
+		}
+		case A_LeftShift:
+			if(rhs < 0 || rhs >= width * 8)	return false;
+			val = (long long)((unsigned long long)lhs << rhs);
+			break;
+		case A_RightShift:
+			if(rhs < 0 || rhs >= width * 8)	return false;
+			val = isUnsigned ? (long long)((unsigned long long)lhs >> rhs) : lhs >> rhs;
+			break;
+		case A_BitwiseAnd:		val = lhs & rhs;	break;
+		case A_BitwiseXor:		val = lhs ^ rhs;	break;
+		case A_BitwiseOr:		val = lhs | rhs;	break;
+		// Comparisons and logical operators produce 0 or 1, so there is nothing to normalize
+		case A_LessThan:		*result = FoldLessThan(lhs, rhs, isUnsigned);	return true;
+		case A_GreaterThan:		*result = FoldLessThan(rhs, lhs, isUnsigned);	return true;
+		case A_LessOrEqual:		*result = !FoldLessThan(rhs, lhs, isUnsigned);	return true;
+		case A_GreaterOrEqual:	*result = !FoldLessThan(lhs, rhs, isUnsigned);	return true;
+		case A_EqualTo:			*result = lhs == rhs;							return true;
+		case A_NotEqualTo:		*result = lhs != rhs;							return true;
+		case A_LogicalAnd:		*result = lhs != 0 && rhs != 0;					return true;
+		case A_LogicalOr:		*result = lhs != 0 || rhs != 0;					return true;
+		default:				return false;
+	}
+	*result = NormalizeInt(val, width, isUnsigned);
+	return true;
+}
+
+static bool EvalUnary(NodeType op, long long lhs, PrimordialType type, long long* result){
+	int width = EvalWidth(type);
+	bool isUnsigned = EvalUnsigned(type);
+	lhs = NormalizeInt(lhs, width, isUnsigned);
+	switch(op){
+		case A_Negate:				*result = NormalizeInt((long long)((unsigned long long)0 - (unsigned long long)lhs), width, isUnsigned);	return true;
+		case A_BitwiseComplement:	*result = NormalizeInt(~lhs, width, isUnsigned);	return true;
+		case A_LogicalNot:			*result = lhs == 0;	return true;
+		case A_Logicize:			*result = lhs != 0;	return true;
+		default:					return false;
+	}
+}
+
+bool HasSideEffects(ASTNode* node){
+	if(node == NULL)	return false;
+	switch(node->op){
+		case A_LitInt:
+		case A_LitStr:
+		case A_VarRef:		return false;
+		case A_Assign:
+		case A_AssignSum:
+		case A_AssignDifference:
+		case A_AssignProduct:
+		case A_AssignQuotient:
+		case A_AssignModulus:
+		case A_AssignLeftShift:
+		case A_AssignRightShift:
+		case A_AssignBitwiseAnd:
+		case A_AssignBitwiseXor:
+		case A_AssignBitwiseOr:
+		case A_Increment:
+		case A_Decrement:
+		case A_RawASM:
+		case A_Asm:			return true;
+		case A_BuiltinCall:
+		case A_FunctionCall:{
+			// Pure and const functions only compute a value from their arguments and memory
+			if(node->op == A_BuiltinCall ? !IsPureBuiltin(node) : !(node->attributes & (AT_Pure | AT_Const)))
+				return true;
+			ASTNodeList* args = node->secondaryValue.ptrVal;
+			for(int i = 0; i < args->count; i++)
+				if(HasSideEffects(args->nodes[i]))
+					return true;
+			return false;
+		}
+		default:			break;
+	}
+	if(HasSideEffects(node->lhs) || HasSideEffects(node->mid) || HasSideEffects(node->rhs))
+		return true;
+	if(node->list != NULL)
+		for(int i = 0; i < node->list->count; i++)
+			if(HasSideEffects(node->list->nodes[i]))
+				return true;
+	return false;
+}
+
+static bool IsLitInt(ASTNode* node){
+	return node != NULL && node->op == A_LitInt;
+}
+
+static ASTNode* MakeFoldedLiteral(long long value, PrimordialType type){
+	if(type == P_Undefined || type == P_Void || type == P_Composite || (type == P_Char && (value < 0 || value > 255))){
+		if(value >= 0 && value < 256)							type = P_Char;
+		else if(value >= -2147483647 && value <= 2147483647)	type = P_Int;
+		else													type = P_LongLong;
+	}
+	return MakeASTLeaf(A_LitInt, type, FlexInt(value));
+}
+
+static ASTNode* FoldUnary(ASTNode* node){
+	ASTNode* lhs = node->lhs;
+	if(lhs == NULL)	return node;
+	// A floating literal is negated by its sign
+	if(lhs->op == A_LitFloat && node->op == A_Negate){
+		const char* text = lhs->value.strVal;
+		return MakeASTLeaf(A_LitFloat, lhs->type, FlexStr(text[0] == '-' ? _strdup(text + 1) : strjoin("-", text)));
+	}
+	if(IsLitInt(lhs)){
+		long long result = 0;
+		if(EvalUnary(node->op, lhs->value.intVal, node->type, &result))
+			return MakeFoldedLiteral(result, (node->op == A_LogicalNot || node->op == A_Logicize) ? P_Char : node->type);
+		return node;
+	}
+	switch(node->op){
+		case A_Negate:
+		case A_BitwiseComplement:
+			// -(-x) => x, ~(~x) => x
+			if(lhs->op == node->op)
+				return lhs->lhs;
+			break;
+		case A_LogicalNot:
+			// !!x => (bool)x, !(bool)x => !x
+			if(lhs->op == A_LogicalNot)	return MakeASTUnary(A_Logicize, lhs->lhs, FlexNULL(), NULL);
+			if(lhs->op == A_Logicize)	return MakeASTUnary(A_LogicalNot, lhs->lhs, FlexNULL(), NULL);
+			break;
+		case A_Logicize:
+			// Comparisons and logical operators already produce 0 or 1
+			if(lhs->op == A_LogicalNot || lhs->op == A_Logicize || FoldTraits(lhs->op) & (FOLD_COMPARISON | FOLD_LOGICAL))
+				return lhs;
+			break;
+		default:	break;
+	}
+	return node;
+}
+
+static ASTNode* FoldLogical(ASTNode* node){
+	ASTNode* lhs = node->lhs;
+	ASTNode* rhs = node->rhs;
+	bool isAnd = node->op == A_LogicalAnd;
+	if(IsLitInt(lhs)){
+		// 0 && x => 0, 1 || x => 1
+		if((lhs->value.intVal != 0) != isAnd)
+			return MakeFoldedLiteral(!isAnd, P_Char);
+		// 1 && x => (bool)x, 0 || x => (bool)x
+		return FoldNode(MakeASTUnary(A_Logicize, rhs, FlexNULL(), NULL));
+	}
+	if(IsLitInt(rhs)){
+		// x && 1 => (bool)x, x || 0 => (bool)x
+		if((rhs->value.intVal != 0) == isAnd)
+			return FoldNode(MakeASTUnary(A_Logicize, lhs, FlexNULL(), NULL));
+		// x && 0 => 0, x || 1 => 1
+		if(!HasSideEffects(lhs))
+			return MakeFoldedLiteral(!isAnd, P_Char);
+	}
+	return node;
+}
+
+/// @brief Split an additive node into a non-constant base and a constant offset.
+/// @return The base of the expression, or NULL if node is not of the form (x + c) or (x - c).
+static ASTNode* SplitAdditive(ASTNode* node, long long* offset){
+	if(node->op != A_Add && node->op != A_Subtract)	return NULL;
+	if(!IsLitInt(node->rhs) || IsLitInt(node->lhs))	return NULL;
+	if(IsPointer(node->rhs->type))					return NULL;
+	*offset = node->op == A_Add ? node->rhs->value.intVal : (long long)((unsigned long long)0 - (unsigned long long)node->rhs->value.intVal);
+	return node->lhs;
+}
+
+static ASTNode* Reassociate(ASTNode* node, int traits){
+	ASTNode* lhs = node->lhs;
+	ASTNode* rhs = node->rhs;
+	if(!IsLitInt(rhs) || IsLitInt(lhs))										return node;
+	// Only combine constants when both operations are carried out in the same width and signedness
+	if(EvalWidth(lhs->type) != EvalWidth(node->type))						return node;
+	if(EvalUnsigned(lhs->type) != EvalUnsigned(node->type))					return node;
+	long long combined = 0;
+	if(node->op == A_Add || node->op == A_Subtract){
+		// (x + c1) + c2 => x + (c1 + c2), (x - c1) - c2 => x + (-c1 - c2), ...
+		long long inner = 0;
+		long long outer = 0;
+		ASTNode* base = SplitAdditive(lhs, &inner);
+		if(base == NULL || SplitAdditive(node, &outer) == NULL)				return node;
+		if(!EvalBinary(A_Add, inner, outer, node->type, &combined))			return node;
+		if(combined == 0)													return base;
+		NodeType op = A_Add;
+		if(combined < 0 && combined != SIGN_BIT && !EvalUnsigned(node->type)){
+			op = A_Subtract;
+			combined = -combined;
+		}
+		return MakeASTBinary(op, node->type, base, MakeFoldedLiteral(combined, rhs->type), FlexNULL());
+	}
+	// (x OP c1) OP c2 => x OP (c1 OP c2)
+	if(!(traits & FOLD_ASSOCIATIVE) || lhs->op != node->op)					return node;
+	if(!IsLitInt(lhs->rhs) || IsLitInt(lhs->lhs))							return node;
+	if(!EvalBinary(node->op, lhs->rhs->value.intVal, rhs->value.intVal, node->type, &combined))
+		return node;
+	return FoldNode(MakeASTBinary(node->op, node->type, lhs->lhs, MakeFoldedLiteral(combined, rhs->type), FlexNULL()));
+}
+
+/// @brief Get the type a binary operation is evaluated in at runtime.
+static PrimordialType BinaryEvalType(ASTNode* node, int traits){
+	if(IsPointer(node->lhs->type) || IsPointer(node->rhs->type))
+		return P_ULongLong;
+	// Comparisons are made on the extended operands, unsigned only if one is an unsigned int or wider
+	if(traits & FOLD_COMPARISON){
+		bool isUnsigned =
+			(IsUnsigned(node->lhs->type) && GetPrimSize(node->lhs->type) >= 4)
+			|| (IsUnsigned(node->rhs->type) && GetPrimSize(node->rhs->type) >= 4);
+		return isUnsigned ? P_ULongLong : P_LongLong;
+	}
+	return (traits & FOLD_SHIFT) ? node->lhs->type : node->type;
+}
+
+static ASTNode* FoldBinary(ASTNode* node, int traits){
+	if(node->lhs == NULL || node->rhs == NULL)	return node;
+	// Floating operations are left to run at runtime; Floating literals are only known as text
+	if(IsFloating(node->lhs->type) || IsFloating(node->rhs->type))
+		return node;
+	if(traits & FOLD_LOGICAL)					return FoldLogical(node);
+	PrimordialType evalType = BinaryEvalType(node, traits);
+	long long result = 0;
+	if(IsLitInt(node->lhs) && IsLitInt(node->rhs)){
+		if(!EvalBinary(node->op, node->lhs->value.intVal, node->rhs->value.intVal, evalType, &result))
+			return node;
+		return MakeFoldedLiteral(result, (traits & FOLD_COMPARISON) ? P_Char : node->type);
+	}
+	// Keep constants on the right hand side of commutative operations
+	if((traits & FOLD_COMMUTATIVE) && IsLitInt(node->lhs)){
+		ASTNode* swap = node->lhs;
+		node->lhs = node->rhs;
+		node->rhs = swap;
+	}
+	// 0 / x => 0, 0 % x => 0, 0 << x => 0, 0 >> x => 0
+	if(IsLitInt(node->lhs) && node->lhs->value.intVal == 0 && !HasSideEffects(node->rhs))
+		switch(node->op){
+			case A_Divide:
+			case A_Modulo:
+			case A_LeftShift:
+			case A_RightShift:	return MakeFoldedLiteral(0, node->type);
+			default:			break;
+		}
+	if(!IsLitInt(node->rhs))					return node;
+	if(traits & FOLD_COMPARISON)				return node;
+	long long rhsVal = NormalizeInt(node->rhs->value.intVal, EvalWidth(evalType), EvalUnsigned(evalType));
+	long long special = 0;
+	if(FoldIdentity(node->op, &special) && rhsVal == NormalizeInt(special, EvalWidth(evalType), EvalUnsigned(evalType)))
+		return node->lhs;
+	if(FoldAbsorber(node->op, &special, &result) && rhsVal == NormalizeInt(special, EvalWidth(evalType), EvalUnsigned(evalType)) && !HasSideEffects(node->lhs))
+		return MakeFoldedLiteral(NormalizeInt(result, EvalWidth(evalType), EvalUnsigned(evalType)), node->type);
+	return Reassociate(node, traits);
+}
+
+/// @brief Fold a conversion of a literal to or from a floating type.
+/// Floating literals are only known as text, so only conversions which need no floating arithmetic are folded.
+static ASTNode* FoldFloatingCast(ASTNode* node){
+	ASTNode* lhs = node->lhs;
+	PrimordialType type = node->type;
+	if(IsLitInt(lhs) && IsFloating(type)){
+		const char* format = IsUnsigned(lhs->type) ? "%llu" : "%lld";
+		return MakeASTLeaf(A_LitFloat, type, FlexStr(sngenf(strlen(format) + intlen(lhs->value.intVal) + 1, format, lhs->value.intVal)));
+	}
+	if(lhs->op != A_LitFloat)
+		return node;
+	// A double literal read as a float is rounded once, rather than twice
+	if(type == P_Float)
+		return MakeASTLeaf(A_LitFloat, type, lhs->value);
+	if(IsFloating(type) || IsPointer(type) || !IsArithmetic(type))
+		return node;
+	// Conversion to an integer truncates towards zero, leaving the digits before the decimal point
+	const char* text = lhs->value.strVal;
+	if(strpbrk(text, "eE") != NULL || strcspn(text, ".") > 18)
+		return node;
+	long long value = NormalizeInt(strtoll(text, NULL, 10), GetTypeSize(type, NULL), IsUnsigned(type));
+	return MakeASTLeaf(A_LitInt, type, FlexInt(value));
+}
+
+static ASTNode* FoldCast(ASTNode* node){
+	if(node->lhs != NULL && (IsFloating(node->type) || node->lhs->op == A_LitFloat))
+		return FoldFloatingCast(node);
+	if(!IsLitInt(node->lhs))	return node;
+	PrimordialType type = node->type;
+	if(IsPointer(type)){
+		node->lhs->type = type;
+		node->lhs->cType = node->cType;
+		return node->lhs;
+	}
+	if(type == P_Void || (type & 0xF0) == P_Composite)
+		return node;
+	long long value = NormalizeInt(node->lhs->value.intVal, GetTypeSize(type, NULL), IsUnsigned(type));
+	ASTNode* lit = MakeASTLeaf(A_LitInt, type, FlexInt(value));
+	lit->cType = node->cType;
+	return lit;
+}
+
+static ASTNode* FoldTernary(ASTNode* node){
+	if(!IsLitInt(node->lhs))	return node;
+	if(node->lhs->value.intVal)
+		return node->mid == NULL ? node->lhs : node->mid;
+	return node->rhs;
+}
+
+static ASTNode* FoldRepeatLogicalOr(ASTNode* node){
+	if(node->rhs == NULL || node->rhs->op != A_ExpressionList)	return node;
+	if(!IsLitInt(node->lhs))									return node;
+	ASTNodeList* list = node->rhs->list;
+	long long value = node->lhs->value.intVal;
+	// With a constant lhs, non-matching constants can be dropped, and a matching constant ends the chain
+	ASTNodeList* remaining = MakeASTNodeList();
+	for(int i = 0; i < list->count; i++){
+		ASTNode* item = list->nodes[i];
+		if(!IsLitInt(item)){
+			AddNodeToASTList(remaining, item);
+			continue;
+		}
+		long long equal = 0;
+		if(!EvalBinary(A_EqualTo, value, item->value.intVal, node->type, &equal))
+			return node;
+		if(!equal)
+			continue;
+		if(remaining->count == 0)
+			return MakeFoldedLiteral(1, P_Char);
+		AddNodeToASTList(remaining, item);
+		break;
+	}
+	if(remaining->count == 0)
+		return MakeFoldedLiteral(0, P_Char);
+	node->rhs->list = remaining;
+	return node;
+}
+
+static ASTNode* FoldExpressionList(ASTNode* node){
+	ASTNodeList* list = node->list;
+	if(list == NULL || list->count == 0)	return node;
+	// Only the last expression yields a value; Anything before it without side effects can be dropped
+	ASTNodeList* remaining = MakeASTNodeList();
+	for(int i = 0; i < list->count - 1; i++)
+		if(HasSideEffects(list->nodes[i]))
+			AddNodeToASTList(remaining, list->nodes[i]);
+	if(remaining->count == 0)
+		return list->nodes[list->count - 1];
+	AddNodeToASTList(remaining, list->nodes[list->count - 1]);
+	node->list = remaining;
+	return node;
+}
+
+/// @brief Get the value of a const variable with a constant initializer.
+/// @return false if the variable's value is not known at compile time.
+static bool EvalConstVar(ASTNode* node, long long* value){
+	SymEntry* var = node->symbol;
+	if(var == NULL || !(var->qualifiers & Q_Const))	return false;
+	if(var->init == NULL || var->init->op != A_LitInt)	return false;
+	*value = NormalizeInt(var->init->value.intVal, GetTypeSize(var->type, var->cType), IsUnsigned(var->type));
+	return true;
+}
+
+// Compile time evaluation of function calls
+// Functions are interpreted with a private environment of locals; Anything which would read or write state
+// outside of that environment (globals, pointers, calls to undefined functions, builtins, ...) aborts evaluation.
+// Since nothing outside the environment is ever modified, an aborted evaluation has no effect.
+
+typedef struct fold_binding FoldBinding;
+typedef enum eExecResult ExecResult;
+
+struct fold_binding {
+	SymEntry* var;
+	PrimordialType type;
+	long long value;
+	bool initialized;
+	FoldBinding* next;
+};
+
+enum eExecResult {
+	X_Normal = 0,
+	X_Break,
+	X_Continue,
+	X_Return,
+	X_Fail,
+};
+
+static DbLnkList* foldFunctions = NULL;
+static int foldSteps = 0;
+static int foldDepth = 0;
+
+static bool InterpretExpression(ASTNode* node, FoldBinding** env, long long* value);
+static ExecResult InterpretStatement(ASTNode* node, FoldBinding** env, long long* retVal);
+
+static ASTNode* FindFoldFunction(const char* id){
+	for(DbLnkList* pos = foldFunctions; pos != NULL; pos = pos->next){
+		ASTNode* func = pos->val;
+		if(streq(func->value.strVal, id))
+			return func;
+	}
+	return NULL;
+}
+
+static bool FoldStep(){
+	return ++foldSteps <= FOLD_CALL_STEP_BUDGET;
+}
+
+static bool IsInterpretable(PrimordialType type){
+	return type != P_Void && (type & 0xF0) != P_Composite && !IsPointer(type) && !IsFloating(type);
+}
+
+static FoldBinding* MakeBinding(SymEntry* var, PrimordialType type, long long value, bool initialized, FoldBinding* next){
+	FoldBinding* binding = malloc(sizeof(FoldBinding));
+	binding->var = var;
+	binding->type = type;
+	binding->value = NormalizeInt(value, GetTypeSize(type, NULL), IsUnsigned(type));
+	binding->initialized = initialized;
+	binding->next = next;
+	return binding;
+}
+
+static FoldBinding* FindBinding(FoldBinding* env, SymEntry* var){
+	while(env != NULL && env->var != var)
+		env = env->next;
+	return env;
+}
+
+/// @brief Discard all bindings made since the environment was saved.
+static void PopBindings(FoldBinding** env, FoldBinding* saved){
+	while(*env != saved){
+		FoldBinding* next = (*env)->next;
+		free(*env);
+		*env = next;
+	}
+}
+
+static NodeType CompoundOperator(NodeType op){
+	switch(op){
+		case A_AssignSum:			return A_Add;
+		case A_AssignDifference:	return A_Subtract;
+		case A_AssignProduct:		return A_Multiply;
+		case A_AssignQuotient:		return A_Divide;
+		case A_AssignModulus:		return A_Modulo;
+		case A_AssignLeftShift:		return A_LeftShift;
+		case A_AssignRightShift:	return A_RightShift;
+		case A_AssignBitwiseAnd:	return A_BitwiseAnd;
+		case A_AssignBitwiseXor:	return A_BitwiseXor;
+		case A_AssignBitwiseOr:		return A_BitwiseOr;
+		default:					return A_Undefined;
+	}
+}
+
+static bool InterpretAssignment(ASTNode* node, FoldBinding** env, long long* value){
+	if(node->lhs == NULL || node->lhs->op != A_VarRef)	return false;
+	FoldBinding* var = FindBinding(*env, node->lhs->symbol);
+	if(var == NULL)										return false;	// Only locals may be modified
+	long long rhs = 0;
+	if(!InterpretExpression(node->rhs, env, &rhs))		return false;
+	if(node->op != A_Assign){
+		if(!var->initialized)							return false;
+		NodeType op = CompoundOperator(node->op);
+		PrimordialType evalType = (op == A_LeftShift || op == A_RightShift) ? var->type : GetWidestType(var->type, node->rhs->type);
+		if(evalType == P_Undefined || !EvalBinary(op, var->value, rhs, evalType, &rhs))
+			return false;
+	}
+	var->value = NormalizeInt(rhs, GetTypeSize(var->type, NULL), IsUnsigned(var->type));
+	var->initialized = true;
+	*value = var->value;
+	return true;
+}
+
+static bool InterpretIncrement(ASTNode* node, FoldBinding** env, long long* value){
+	if(node->lhs == NULL || node->lhs->op != A_VarRef)	return false;
+	FoldBinding* var = FindBinding(*env, node->lhs->symbol);
+	if(var == NULL || !var->initialized)				return false;
+	long long old = var->value;
+	long long result = 0;
+	if(!EvalBinary(node->op == A_Increment ? A_Add : A_Subtract, old, 1, var->type, &result))
+		return false;
+	var->value = NormalizeInt(result, GetTypeSize(var->type, NULL), IsUnsigned(var->type));
+	// A value marks prefix operators
+	*value = node->value.intVal ? var->value : old;
+	return true;
+}
+
+static bool InterpretCall(ASTNode* call, FoldBinding** env, long long* value){
+	ASTNode* func = FindFoldFunction(call->value.strVal);
+	if(func == NULL || func->lhs == NULL)			return false;
+	if(foldDepth >= FOLD_CALL_DEPTH_BUDGET)			return false;
+	ASTNodeList* args = call->secondaryValue.ptrVal;
+	Parameter* param = func->secondaryValue.ptrVal;
+	FoldBinding* frame = NULL;
+	bool success = true;
+	for(int i = 0; success && i < args->count; i++){
+		long long arg = 0;
+		if(param == NULL || !IsInterpretable(param->type) || !InterpretExpression(args->nodes[i], env, &arg))
+			success = false;
+		else{
+			frame = MakeBinding(param->symbol, param->type, arg, true, frame);
+			param = param->next;
+		}
+	}
+	ExecResult result = X_Fail;
+	long long retVal = 0;
+	if(success && param == NULL){
+		foldDepth++;
+		result = InterpretStatement(func->lhs, &frame, &retVal);
+		foldDepth--;
+	}
+	PopBindings(&frame, NULL);
+	if(result != X_Return)							return false;
+	*value = NormalizeInt(retVal, GetTypeSize(func->type, NULL), IsUnsigned(func->type));
+	return true;
+}
+
+static bool InterpretExpression(ASTNode* node, FoldBinding** env, long long* value){
+	if(node == NULL || !FoldStep())				return false;
+	if(!IsInterpretable(node->type))			return false;
+	int traits = FoldTraits(node->op);
+	long long lhs = 0;
+	long long rhs = 0;
+	if(traits & FOLD_UNARY){
+		if(!InterpretExpression(node->lhs, env, &lhs))	return false;
+		return EvalUnary(node->op, lhs, node->type, value);
+	}
+	if(traits & FOLD_LOGICAL){
+		if(!InterpretExpression(node->lhs, env, &lhs))	return false;
+		if(node->op == A_LogicalAnd && !lhs){
+			*value = 0;
+			return true;
+		}
+		if(node->op == A_LogicalOr && lhs){
+			*value = 1;
+			return true;
+		}
+		if(!InterpretExpression(node->rhs, env, &rhs))	return false;
+		*value = rhs != 0;
+		return true;
+	}
+	if(traits & FOLD_BINARY){
+		if(!InterpretExpression(node->lhs, env, &lhs))	return false;
+		if(!InterpretExpression(node->rhs, env, &rhs))	return false;
+		return EvalBinary(node->op, lhs, rhs, BinaryEvalType(node, traits), value);
+	}
+	switch(node->op){
+		case A_LitInt:
+			*value = node->value.intVal;
+			return true;
+		case A_VarRef:{
+			FoldBinding* var = FindBinding(*env, node->symbol);
+			if(var == NULL)								return EvalConstVar(node, value);
+			if(!var->initialized)						return false;
+			*value = var->value;
+			return true;
+		}
+		case A_Assign:
+		case A_AssignSum:
+		case A_AssignDifference:
+		case A_AssignProduct:
+		case A_AssignQuotient:
+		case A_AssignModulus:
+		case A_AssignLeftShift:
+		case A_AssignRightShift:
+		case A_AssignBitwiseAnd:
+		case A_AssignBitwiseXor:
+		case A_AssignBitwiseOr:
+			return InterpretAssignment(node, env, value);
+		case A_Increment:
+		case A_Decrement:
+			return InterpretIncrement(node, env, value);
+		case A_Cast:
+			if(!InterpretExpression(node->lhs, env, &lhs))	return false;
+			*value = NormalizeInt(lhs, GetTypeSize(node->type, NULL), IsUnsigned(node->type));
+			return true;
+		case A_Ternary:
+			if(!InterpretExpression(node->lhs, env, &lhs))	return false;
+			if(lhs && node->mid == NULL){
+				*value = lhs;
+				return true;
+			}
+			return InterpretExpression(lhs ? node->mid : node->rhs, env, value);
+		case A_ExpressionList:
+			for(int i = 0; i < node->list->count; i++)
+				if(!InterpretExpression(node->list->nodes[i], env, value))
+					return false;
+			return node->list->count != 0;
+		case A_RepeatLogicalOr:{
+			if(!InterpretExpression(node->lhs, env, &lhs))	return false;
+			ASTNodeList* list = node->rhs->list;
+			*value = 0;
+			for(int i = 0; i < list->count && !*value; i++){
+				if(!InterpretExpression(list->nodes[i], env, &rhs))	return false;
+				if(!EvalBinary(A_EqualTo, lhs, rhs, node->lhs->type, value))	return false;
+			}
+			return true;
+		}
+		case A_FunctionCall:
+			return InterpretCall(node, env, value);
+		case A_Inline:{
+			// The locals of an inlined body have entries of their own, so it shares the enclosing environment
+			long long retVal = 0;
+			if(InterpretStatement(node->lhs, env, &retVal) != X_Return)	return false;
+			*value = NormalizeInt(retVal, GetTypeSize(node->type, NULL), IsUnsigned(node->type));
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+static ExecResult InterpretStatementList(ASTNodeList* list, int start, FoldBinding** env, long long* retVal){
+	for(int i = start; i < list->count; i++){
+		ExecResult result = InterpretStatement(list->nodes[i], env, retVal);
+		if(result != X_Normal)
+			return result;
+	}
+	return X_Normal;
+}
+
+/// @brief Run a loop. The condition is checked before every iteration, except the first when testFirst is false.
+static ExecResult InterpretLoop(ASTNode* condition, ASTNode* body, ASTNode* modifier, bool testFirst, FoldBinding** env, long long* retVal){
+	long long value = 0;
+	for(bool first = true; true; first = false){
+		if(condition != NULL && (testFirst || !first)){
+			if(!InterpretExpression(condition, env, &value))	return X_Fail;
+			if(!value)											return X_Normal;
+		}
+		ExecResult result = InterpretStatement(body, env, retVal);
+		if(result == X_Break)									return X_Normal;
+		if(result == X_Return || result == X_Fail)				return result;
+		if(modifier != NULL && !InterpretExpression(modifier, env, &value))
+			return X_Fail;
+	}
+}
+
+static ExecResult InterpretSwitch(ASTNode* node, FoldBinding** env, long long* retVal){
+	long long value = 0;
+	if(!InterpretExpression(node->lhs, env, &value))	return X_Fail;
+	ASTNodeList* cases = node->list;
+	int target = -1;
+	for(int i = 0; i < cases->count && target < 0; i++){
+		long long equal = 0;
+		if(cases->nodes[i]->op != A_Case)				continue;
+		if(!EvalBinary(A_EqualTo, value, cases->nodes[i]->value.intVal, node->lhs->type, &equal))
+			return X_Fail;
+		if(equal)
+			target = i;
+	}
+	for(int i = 0; i < cases->count && target < 0; i++)
+		if(cases->nodes[i]->op == A_Default)
+			target = i;
+	if(target < 0)										return X_Normal;
+	// Execution falls through into the following cases
+	for(int i = target; i < cases->count; i++){
+		ExecResult result = InterpretStatementList(cases->nodes[i]->list, 0, env, retVal);
+		if(result == X_Break)							return X_Normal;
+		if(result != X_Normal)							return result;
+	}
+	return X_Normal;
+}
+
+static ExecResult InterpretStatement(ASTNode* node, FoldBinding** env, long long* retVal){
+	if(node == NULL)							return X_Normal;
+	if(!FoldStep())								return X_Fail;
+	long long value = 0;
+	FoldBinding* saved = *env;
+	ExecResult result = X_Normal;
+	switch(node->op){
+		case A_Undefined:						return X_Normal;
+		case A_Break:							return X_Break;
+		case A_Continue:						return X_Continue;
+		case A_Return:
+			if(node->lhs == NULL || node->lhs->op == A_Undefined)	return X_Fail;
+			if(!InterpretExpression(node->lhs, env, retVal))		return X_Fail;
+			return X_Return;
+		case A_Declare:
+			if(node->sClass != C_Default || node->mid != NULL || !IsInterpretable(node->type))	return X_Fail;
+			if(node->lhs != NULL && !InterpretExpression(node->lhs, env, &value))
+				return X_Fail;
+			*env = MakeBinding(node->symbol, node->type, value, node->lhs != NULL, *env);
+			return X_Normal;
+		case A_Block:
+			result = InterpretStatementList(node->list, 0, env, retVal);
+			PopBindings(env, saved);
+			return result;
+		case A_If:
+			if(!InterpretExpression(node->lhs, env, &value))		return X_Fail;
+			return InterpretStatement(value ? node->rhs : node->mid, env, retVal);
+		case A_While:
+			return InterpretLoop(node->lhs, node->rhs, NULL, true, env, retVal);
+		case A_Do:
+			return InterpretLoop(node->lhs, node->rhs, NULL, false, env, retVal);
+		case A_For:{
+			ASTNode* header = node->lhs;
+			result = InterpretStatement(header->lhs, env, retVal);
+			if(result == X_Normal)
+				result = InterpretLoop(header->mid, node->rhs, header->rhs, true, env, retVal);
+			PopBindings(env, saved);
+			return result;
+		}
+		case A_Switch:
+			return InterpretSwitch(node, env, retVal);
+		default:
+			return InterpretExpression(node, env, &value) ? X_Normal : X_Fail;
+	}
+}
+
+/// @brief Replace a call to a side effect free function with literal arguments by its result.
+static ASTNode* FoldCall(ASTNode* node){
+	ASTNodeList* args = node->secondaryValue.ptrVal;
+	for(int i = 0; i < args->count; i++)
+		if(!IsLitInt(args->nodes[i]))
+			return node;
+	FoldBinding* env = NULL;
+	long long value = 0;
+	foldSteps = 0;
+	if(!InterpretCall(node, &env, &value))
+		return node;
+	return MakeFoldedLiteral(value, node->type);
+}
+
+/// @brief Evaluate a bit manipulation built-in function of literals, or a hint about a literal.
+static ASTNode* FoldBuiltin(ASTNode* node){
+	ASTNodeList* args = node->secondaryValue.ptrVal;
+	if(!IsPureBuiltin(node) || !IsLitInt(args->nodes[0]))
+		return node;
+	const char* id = node->value.strVal + 15;
+	if(streq(id, "expect") || streq(id, "assume_aligned"))
+		return HasSideEffects(args->nodes[1]) ? node : args->nodes[0];
+	long long value = args->nodes[0]->value.intVal;
+	int bits = GetPrimSize(args->nodes[0]->type) == 8 ? 64 : 32;
+	long long result = 0;
+	if(streq(id, "popcount"))
+		for(int i = 0; i < bits; i++)
+			result += (value >> i) & 1;
+	else if(streq(id, "clz") || streq(id, "ctz")){
+		// Neither is defined for zero
+		if(!NormalizeInt(value, bits / 8, true))
+			return node;
+		bool leading = streq(id, "clz");
+		int i = leading ? bits - 1 : 0;
+		while(!((value >> i) & 1))
+			i += leading ? -1 : 1;
+		result = leading ? bits - 1 - i : i;
+	}
+	else if(strbeg(id, "bswap")){
+		int bytes = streq(id, "bswap16") ? 2 : streq(id, "bswap32") ? 4 : 8;
+		for(int i = 0; i < bytes; i++)
+			result |= ((value >> (8 * i)) & 0xFF) << (8 * (bytes - 1 - i));
+	}
+	else{
+		if(!IsLitInt(args->nodes[1]))
+			return node;
+		bits = 8 * GetPrimSize(node->type);
+		int count = ((args->nodes[1]->value.intVal % bits) + bits) % bits;
+		if(streq(id, "rotr"))
+			count = (bits - count) % bits;
+		for(int i = 0; i < bits; i++)
+			if((value >> i) & 1)
+				result |= (long long)1 << ((i + count) % bits);
+	}
+	return MakeFoldedLiteral(NormalizeInt(result, GetPrimSize(node->type), IsUnsigned(node->type)), node->type);
+}
+
+/// @brief Replace an inlined call which evaluates to a constant by its result.
+static ASTNode* FoldInline(ASTNode* node){
+	FoldBinding* env = NULL;
+	long long value = 0;
+	foldSteps = 0;
+	if(!InterpretExpression(node, &env, &value))
+		return node;
+	return MakeFoldedLiteral(value, node->type);
+}
+
+/// @brief Replace a load of a const variable by its constant initializer.
+static ASTNode* FoldConstLoad(ASTNode* node){
+	ASTNode* init = node->secondaryValue.ptrVal;
+	if(!(node->qualifiers & Q_Const) || init == NULL || init->op != A_LitInt)
+		return node;
+	return MakeASTLeaf(A_LitInt, node->type, FlexInt(NormalizeInt(init->value.intVal, GetTypeSize(node->type, NULL), IsUnsigned(node->type))));
+}
+
+ASTNode* FoldNode(ASTNode* node){
+	if(node == NULL)				return NULL;
+	int traits = FoldTraits(node->op);
+	if(traits & FOLD_UNARY)			return FoldUnary(node);
+	if(traits & FOLD_BINARY)		return FoldBinary(node, traits);
+	switch(node->op){
+		case A_Cast:				return FoldCast(node);
+		case A_Ternary:				return FoldTernary(node);
+		case A_RepeatLogicalOr:		return FoldRepeatLogicalOr(node);
+		case A_ExpressionList:		return FoldExpressionList(node);
+		case A_VarRef:				return FoldConstLoad(node);
+		case A_Inline:				return FoldInline(node);
+		case A_BuiltinCall:			return FoldBuiltin(node);
+		default:					return node;
+	}
+}
+
+ASTNodeList* FoldASTNodeList(ASTNodeList* list){
+	for(int i = 0; i < list->count; i++)
+		list->nodes[i] = FoldASTNodes(list->nodes[i]);
+	return list;
+}
+
+ASTNode* FoldASTNodes(ASTNode* tree){
+	// The address of a const variable is not its value
+	if(tree->lhs != NULL && (tree->op != A_AddressOf || tree->lhs->op != A_VarRef))
+		tree->lhs = FoldASTNodes(tree->lhs);
+	if(tree->mid != NULL)			tree->mid = FoldASTNodes(tree->mid);
+	if(tree->rhs != NULL){
+		// The operand list of =|| is not a comma expression, so it must not be collapsed
+		if(tree->op == A_RepeatLogicalOr && tree->rhs->op == A_ExpressionList)
+			tree->rhs->list = FoldASTNodeList(tree->rhs->list);
+		else
+			tree->rhs = FoldASTNodes(tree->rhs);
+	}
+	if(tree->list != NULL)			tree->list = FoldASTNodeList(tree->list);
+	if(tree->op == A_FunctionCall || tree->op == A_BuiltinCall)
+		tree->secondaryValue.ptrVal = FoldASTNodeList(tree->secondaryValue.ptrVal);
+	if(tree->op == A_FunctionCall)
+		return FoldCall(tree);
+	return FoldNode(tree);
+}
+
+/// @brief Determine whether two expressions are identical, and free of side effects.
+static bool SameExpression(ASTNode* lhs, ASTNode* rhs){
+	if(lhs == NULL || rhs == NULL)				return lhs == rhs;
+	if(lhs->op != rhs->op || lhs->type != rhs->type)	return false;
+	switch(lhs->op){
+		case A_LitInt:		return lhs->value.intVal == rhs->value.intVal;
+		case A_VarRef:		return lhs->symbol == rhs->symbol;
+		case A_Dereference:
+		case A_AddressOf:
+		case A_Cast:
+		case A_Add:
+		case A_Subtract:
+		case A_Multiply:	break;
+		case A_FunctionCall:{
+			// Calls of pure and const functions with the same arguments compute the same value, until memory is modified
+			if(!streq(lhs->value.strVal, rhs->value.strVal) || !(lhs->attributes & (AT_Pure | AT_Const)))
+				return false;
+			ASTNodeList* largs = lhs->secondaryValue.ptrVal;
+			ASTNodeList* rargs = rhs->secondaryValue.ptrVal;
+			if(largs->count != rargs->count)
+				return false;
+			for(int i = 0; i < largs->count; i++)
+				if(!SameExpression(largs->nodes[i], rargs->nodes[i]))
+					return false;
+			return !HasSideEffects(lhs);
+		}
+		default:			return false;
+	}
+	return SameExpression(lhs->lhs, rhs->lhs) && SameExpression(lhs->rhs, rhs->rhs);
+}
+
+/// @brief Determine whether the value stored to an lvalue can be tracked while propagating stores.
+static bool IsTrackable(ASTNode* lvalue){
+	if((lvalue->type & 0xF0) == P_Composite)	return false;
+	if(lvalue->op == A_VarRef)					return lvalue->lvalue;
+	return lvalue->op == A_Dereference && !HasSideEffects(lvalue->lhs);
+}
+
+/// @brief Replace loads of lvalues holding a known constant by the constant, and calls of pure functions by a variable holding their result.
+/// @param known Assignments of constants or pure calls which are known to still hold.
+static ASTNode* SubstituteKnown(ASTNode* node, ASTNodeList* known){
+	if(node == NULL)
+		return NULL;
+	switch(node->op){
+		case A_FunctionCall:{
+			ASTNodeList* args = node->secondaryValue.ptrVal;
+			for(int i = 0; i < args->count; i++)
+				args->nodes[i] = FoldASTNodes(SubstituteKnown(args->nodes[i], known));
+			for(int i = known->count - 1; i >= 0; i--){
+				ASTNode* store = known->nodes[i];
+				if(!IsLitInt(store->rhs) && SameExpression(store->rhs, node)){
+					ASTNode* var = MakeASTLeaf(A_VarRef, store->lhs->type, FlexStr(store->lhs->value.strVal));
+					var->cType = store->lhs->cType;
+					var->symbol = store->lhs->symbol;
+					return var;
+				}
+			}
+			return node;
+		}
+		case A_AddressOf:
+			// Taking an address doesn't load the object
+			if(node->lhs->op == A_Dereference)
+				node->lhs->lhs = FoldASTNodes(SubstituteKnown(node->lhs->lhs, known));
+			return node;
+		case A_Dereference:
+			node->lhs = FoldASTNodes(SubstituteKnown(node->lhs, known));
+			/* fallthrough */
+		case A_VarRef:
+			for(int i = known->count - 1; i >= 0; i--){
+				ASTNode* store = known->nodes[i];
+				if(IsLitInt(store->rhs) && SameExpression(store->lhs, node))
+					return MakeASTLeaf(A_LitInt, node->type, FlexInt(store->rhs->value.intVal));
+			}
+			return node;
+		default:
+			break;
+	}
+	node->lhs = SubstituteKnown(node->lhs, known);
+	node->mid = SubstituteKnown(node->mid, known);
+	node->rhs = SubstituteKnown(node->rhs, known);
+	if(node->list != NULL)
+		for(int i = 0; i < node->list->count; i++)
+			node->list->nodes[i] = SubstituteKnown(node->list->nodes[i], known);
+	return node;
+}
+
+/// @brief Forget known values a store may overwrite, or whose address or computation it may change.
+static void ForgetAliased(ASTNodeList* known, ASTNode* store, AliasContext* context){
+	int count = 0;
+	for(int i = 0; i < known->count; i++)
+		if(!ReadsAliased(known->nodes[i]->lhs, store, context) && !ReadsAliased(known->nodes[i]->rhs, store, context))
+			known->nodes[count++] = known->nodes[i];
+	known->count = count;
+}
+
+/// @brief Determine whether an expression only reads locals that are only accessed by name, and so can't be changed by calls.
+static bool ReadsOnlyPrivate(ASTNode* node, AliasContext* context){
+	if(node == NULL)
+		return true;
+	switch(node->op){
+		case A_LitInt:		return true;
+		case A_VarRef:		return IsPrivateAccess(node, context);
+		case A_FunctionCall:{
+			if(!(node->attributes & AT_Const))
+				return false;
+			ASTNodeList* args = node->secondaryValue.ptrVal;
+			for(int i = 0; i < args->count; i++)
+				if(!ReadsOnlyPrivate(args->nodes[i], context))
+					return false;
+			return true;
+		}
+		case A_Dereference:
+		case A_BuiltinCall:
+		case A_Inline:		return false;
+		default:			break;
+	}
+	return node->list == NULL && ReadsOnlyPrivate(node->lhs, context) && ReadsOnlyPrivate(node->mid, context) && ReadsOnlyPrivate(node->rhs, context);
+}
+
+/// @brief Determine whether a call has been declared to compute its value without modifying memory.
+static bool IsPureCall(ASTNode* node){
+	return node != NULL && node->op == A_FunctionCall && (node->attributes & (AT_Pure | AT_Const));
+}
+
+/// @brief Forget every known value that may be modified by evaluating a node.
+static void ForgetStores(ASTNode* node, ASTNodeList* known, AliasContext* context){
+	if(node == NULL || !known->count)
+		return;
+	switch(node->op){
+		case A_Assign:
+		case A_AssignSum:
+		case A_AssignDifference:
+		case A_AssignProduct:
+		case A_AssignQuotient:
+		case A_AssignModulus:
+		case A_AssignLeftShift:
+		case A_AssignRightShift:
+		case A_AssignBitwiseAnd:
+		case A_AssignBitwiseXor:
+		case A_AssignBitwiseOr:
+		case A_Increment:
+		case A_Decrement:
+			ForgetAliased(known, node->lhs, context);
+			break;
+		case A_Asm:
+			// Outputs may be private locals, which unknown code otherwise can't modify
+			for(int i = 0; i < node->list->count; i++)
+				if(node->list->nodes[i]->lhs->lvalue)
+					ForgetAliased(known, node->list->nodes[i]->lhs, context);
+			// Like a call, the statement may also modify anything that isn't private
+			/* fallthrough */
+		case A_FunctionCall:
+		case A_BuiltinCall:
+		case A_RawASM: {
+			if(IsPureCall(node) || IsPureBuiltin(node))
+				break;
+			// Relaxed atomic operations don't order other accesses, so only the objects they point to may change
+			if(IsAtomicBuiltin(node) && GetAtomicOrder(node) == MO_Relaxed){
+				ASTNodeList* args = node->secondaryValue.ptrVal;
+				for(int i = 0; i < args->count; i++)
+					if(IsPointer(args->nodes[i]->type)){
+						ASTNode* object = MakeASTUnary(A_Dereference, args->nodes[i], FlexNULL(), args->nodes[i]->cType);
+						object->type = args->nodes[i]->type - 1;
+						ForgetAliased(known, object, context);
+					}
+				break;
+			}
+			// Unknown code can modify anything but locals that are only accessed by name
+			int count = 0;
+			for(int i = 0; i < known->count; i++)
+				if(IsPrivateAccess(known->nodes[i]->lhs, context) && ReadsOnlyPrivate(known->nodes[i]->rhs, context))
+					known->nodes[count++] = known->nodes[i];
+			known->count = count;
+			break;
+		}
+		default:
+			break;
+	}
+	ForgetStores(node->lhs, known, context);
+	ForgetStores(node->mid, known, context);
+	ForgetStores(node->rhs, known, context);
+	ASTNodeList* list = node->list;
+	if(node->op == A_FunctionCall || node->op == A_BuiltinCall)
+		list = node->secondaryValue.ptrVal;
+	if(list != NULL)
+		for(int i = 0; i < list->count; i++)
+			ForgetStores(list->nodes[i], known, context);
+}
+
+static void PropagateStatementList(ASTNodeList* list, AliasContext* context);
+
+/// @brief Propagate stores within every statement list nested in a statement.
+static void PropagateNested(ASTNode* node, AliasContext* context){
+	// Inlined bodies are propagated along with the statement containing them
+	if(node == NULL || node->op == A_Inline)
+		return;
+	if(node->list != NULL && (node->op == A_Block || node->op == A_Case || node->op == A_Default)){
+		PropagateStatementList(node->list, context);
+		return;
+	}
+	PropagateNested(node->lhs, context);
+	PropagateNested(node->mid, context);
+	PropagateNested(node->rhs, context);
+	if(node->list != NULL && node->op == A_Switch)
+		for(int i = 0; i < node->list->count; i++)
+			PropagateNested(node->list->nodes[i], context);
+}
+
+/// @brief Propagate known values into the arguments of an inlined call, then stores within its body.
+/// The arguments initialize the leading declarations of the body, and are evaluated in the enclosing statement list.
+static ASTNode* PropagateInline(ASTNode* node, ASTNodeList* known, AliasContext* context){
+	ASTNodeList* body = node->lhs->list;
+	for(int i = 0; i < node->secondaryValue.intVal; i++){
+		ASTNode* param = body->nodes[i];
+		if(!HasSideEffects(param->lhs))
+			param->lhs = FoldASTNodes(SubstituteKnown(param->lhs, known));
+		else
+			ForgetStores(param->lhs, known, context);
+	}
+	PropagateStatementList(body, context);
+	return FoldASTNodes(node);
+}
+
+/// @brief Find the inlined call a statement evaluates, which may only be the statement itself, or its initializer, stored value, or returned value.
+static ASTNode** InlinedCallOf(ASTNode** stmt){
+	ASTNode* node = *stmt;
+	ASTNode** slot = stmt;
+	switch(node->op){
+		case A_Declare:
+		case A_Return:	slot = &node->lhs;	break;
+		case A_Assign:	slot = &node->rhs;	break;
+		default:		break;
+	}
+	if(*slot == NULL || (*slot)->op != A_Inline)
+		return NULL;
+	return slot;
+}
+
+/// @brief Determine whether the result of a pure call stored to a variable can replace later identical calls.
+/// The variable must hold the whole result, and must not be read by the call itself.
+static bool IsReusableCall(ASTNode* call, ASTNode* var, AliasContext* context){
+	return IsPureCall(call) && !HasSideEffects(call) && call->type == var->type && !ReadsAliased(call, var, context);
+}
+
+static void PropagateStatement(ASTNode* stmt, ASTNodeList* known, AliasContext* context){
+	ASTNode** inlined = InlinedCallOf(&stmt);
+	if(inlined != NULL)
+		*inlined = PropagateInline(*inlined, known, context);
+	if(stmt->op == A_Inline){
+		ForgetStores(stmt, known, context);
+		return;
+	}
+	switch(stmt->op){
+		case A_Declare:{
+			ASTNode* var = MakeASTLeaf(A_VarRef, stmt->type, FlexStr(stmt->value.strVal));
+			var->cType = stmt->cType;
+			var->symbol = stmt->symbol;
+			if(stmt->lhs != NULL && stmt->lhs->op != A_Initializer && !HasSideEffects(stmt->lhs))
+				stmt->lhs = FoldASTNodes(SubstituteKnown(stmt->lhs, known));
+			else
+				ForgetStores(stmt->lhs, known, context);
+			if(IsVariableLengthArray(stmt))
+				ForgetStores(stmt->mid, known, context);
+			// Values known from an earlier pass through the declaration no longer hold
+			ForgetAliased(known, var, context);
+			context->locals = MakeDbLnkList((void*)stmt->symbol, NULL, context->locals);
+			// A static local outlives the call, so other calls, including recursive ones, may modify it
+			if(stmt->sClass & C_Static)
+				context->addressTaken = MakeDbLnkList((void*)stmt->symbol, NULL, context->addressTaken);
+			if(stmt->mid == NULL && stmt->sClass == C_Default && (IsLitInt(stmt->lhs) || IsReusableCall(stmt->lhs, var, context)) && IsTrackable(var))
+				AddNodeToASTList(known, MakeASTBinary(A_Assign, stmt->type, var, stmt->lhs, FlexNULL()));
+			return;
+		}
+		case A_Assign:
+			if(HasSideEffects(stmt->rhs) || !IsTrackable(stmt->lhs))
+				break;
+			stmt->rhs = FoldASTNodes(SubstituteKnown(stmt->rhs, known));
+			if(stmt->lhs->op == A_Dereference)
+				stmt->lhs->lhs = FoldASTNodes(SubstituteKnown(stmt->lhs->lhs, known));
+			ForgetAliased(known, stmt->lhs, context);
+			if(IsLitInt(stmt->rhs)){
+				int size = GetTypeSize(stmt->lhs->type, stmt->lhs->cType);
+				long long value = NormalizeInt(stmt->rhs->value.intVal, size, IsUnsigned(stmt->lhs->type));
+				AddNodeToASTList(known, MakeASTBinary(A_Assign, stmt->lhs->type, stmt->lhs, MakeASTLeaf(A_LitInt, stmt->lhs->type, FlexInt(value)), FlexNULL()));
+			}
+			else if(stmt->lhs->op == A_VarRef && IsReusableCall(stmt->rhs, stmt->lhs, context))
+				AddNodeToASTList(known, MakeASTBinary(A_Assign, stmt->lhs->type, stmt->lhs, stmt->rhs, FlexNULL()));
+			return;
+		case A_Return:
+			if(stmt->lhs != NULL && !HasSideEffects(stmt->lhs))
+				stmt->lhs = FoldASTNodes(SubstituteKnown(stmt->lhs, known));
+			return;
+		case A_If:
+			if(!HasSideEffects(stmt->lhs))
+				stmt->lhs = FoldASTNodes(SubstituteKnown(stmt->lhs, known));
+			break;
+		default:
+			break;
+	}
+	// Otherwise, values are only known after the statement if it can't modify them
+	PropagateNested(stmt, context);
+	ForgetStores(stmt, known, context);
+}
+
+/// @brief Propagate constants stored to memory through a statement list, to later loads which no intervening store may alias.
+/// A statement list may be entered by a jump to any case label, so nothing is known at its start.
+/// Likewise, nothing is known at or after a statement containing a label, which may be jumped to from anywhere in the function.
+/// Calls of pure functions whose value is discarded are removed, as is anything following a call which never returns or is unreachable, up to the next label.
+static void PropagateStatementList(ASTNodeList* list, AliasContext* context){
+	DbLnkList* locals = context->locals;
+	ASTNodeList* known = MakeASTNodeList();
+	int count = 0;
+	bool reachable = true;
+	for(int i = 0; i < list->count; i++){
+		ASTNode* stmt = list->nodes[i];
+		bool labeled = ContainsLabel(stmt);
+		if(labeled){
+			known->count = 0;
+			reachable = true;
+		}
+		// Declarations are kept, as statements after a later label may still use the variable
+		if(!reachable && stmt->op != A_Declare)
+			continue;
+		PropagateStatement(stmt, known, context);
+		if(labeled)
+			known->count = 0;
+		if(IsPureCall(stmt) && !HasSideEffects(stmt))
+			continue;
+		list->nodes[count++] = stmt;
+		if(stmt->op == A_FunctionCall && (stmt->attributes & AT_NoReturn))
+			reachable = false;
+		if(stmt->op == A_BuiltinCall && streq(stmt->value.strVal, "__SCC_BUILTIN__unreachable"))
+			reachable = false;
+	}
+	list->count = count;
+	context->locals = locals;
+}
+
+ASTNodeList* FoldProgram(ASTNodeList* program){
+	// Definitions of earlier translation units compiled by the same invocation aren't visible to this one
+	while(foldFunctions != NULL){
+		DbLnkList* next = foldFunctions->next;
+		free(foldFunctions);
+		foldFunctions = next;
+	}
+	// Register every definition first, so calls may be evaluated regardless of definition order
+	for(int i = 0; i < program->count; i++){
+		ASTNode* node = program->nodes[i];
+		if(node->op == A_Function && node->lhs != NULL)
+			foldFunctions = MakeDbLnkList(node, NULL, foldFunctions);
+	}
+	program = FoldASTNodeList(program);
+	for(int i = 0; i < program->count; i++){
+		ASTNode* node = program->nodes[i];
+		if(node->op == A_Function && node->lhs != NULL)
+			PropagateNested(node->lhs, MakeAliasContext(node));
+	}
+	return program;
+}
+
+bool EvaluateConstant(ASTNode* node, long long* value){
+	if(node == NULL)							return false;
+	int traits = FoldTraits(node->op);
+	long long lhs = 0;
+	long long rhs = 0;
+	if(traits & FOLD_UNARY){
+		if(!EvaluateConstant(node->lhs, &lhs))	return false;
+		return EvalUnary(node->op, lhs, node->type, value);
+	}
+	if(traits & FOLD_LOGICAL){
+		if(!EvaluateConstant(node->lhs, &lhs))	return false;
+		// Short circuit; The rhs need not be constant if it is never evaluated
+		if(node->op == A_LogicalAnd && !lhs){
+			*value = 0;
+			return true;
+		}
+		if(node->op == A_LogicalOr && lhs){
+			*value = 1;
+			return true;
+		}
+		if(!EvaluateConstant(node->rhs, &rhs))	return false;
+		*value = rhs != 0;
+		return true;
+	}
+	if(traits & FOLD_BINARY){
+		if(!EvaluateConstant(node->lhs, &lhs))	return false;
+		if(!EvaluateConstant(node->rhs, &rhs))	return false;
+		return EvalBinary(node->op, lhs, rhs, BinaryEvalType(node, traits), value);
+	}
+	switch(node->op){
+		case A_LitInt:
+			*value = node->value.intVal;
+			return true;
+		case A_VarRef:
+			return EvalConstVar(node, value);
+		case A_Cast:
+			if(node->type == P_Void || (node->type & 0xF0) == P_Composite || IsFloating(node->type))	return false;
+			if(!EvaluateConstant(node->lhs, &lhs))	return false;
+			*value = IsPointer(node->type) ? lhs : NormalizeInt(lhs, GetTypeSize(node->type, NULL), IsUnsigned(node->type));
+			return true;
+		case A_Ternary:
+			if(!EvaluateConstant(node->lhs, &lhs))	return false;
+			if(lhs && node->mid == NULL){
+				*value = lhs;
+				return true;
+			}
+			return EvaluateConstant(lhs ? node->mid : node->rhs, value);
+		default:
+			return false;
+	}
+}
@@ -0,0 +1,24 @@
+#ifndef FOLD_INCLUDED
+#define FOLD_INCLUDED
+
+#include "defs.h"
+#include "types.h"
+
+/// Fold a single node whose children have already been folded.
+/// Used both inline by the parser and by the fold stage.
+ASTNode* FoldNode(ASTNode* node);
+ASTNode* FoldASTNodes(ASTNode* tree);
+ASTNodeList* FoldASTNodeList(ASTNodeList* list);
+/// Fold a whole translation unit.
+/// Calls to side effect free functions defined in it are evaluated when all arguments are literals.
+ASTNodeList* FoldProgram(ASTNodeList* program);
+/// Truncate a value to the given width in bytes, then sign or zero extend it back to 64 bits.
+long long NormalizeInt(long long value, int width, bool isUnsigned);
+bool HasSideEffects(ASTNode* node);
+/// @brief Evaluate an integer constant expression without modifying it.
+/// Enum values and sizeof have already been reduced to literals by the parser; const variables are resolved in the current scope.
+/// @param value [OUT] The value of the expression.
+/// @return false if the expression is not a constant expression.
+bool EvaluateConstant(ASTNode* node, long long* value);
+
+#endif
@@ -1,23 +1,46 @@
+#include <ctype.h>
 #include <string.h>
 
 #include "defs.h"
 #include "types.h"
 #include "symTable.h"
+#include "fold.h"
 
 static int unresolvedPushes = 0;
+static int callAreaSize = 0;	// Stack reserved for the arguments of calls whose arguments are being evaluated
 static int labelPref = 9;
 static char* data_section;
+static char* rodata_section;
+static char* tls_section;	// Initial images of thread-local variables, copied for each thread
+static char* local_bss;	// Uninitialized static locals, which unlike global BSS variables aren't visible to other translation units
+static int staticLocals = 0;
+static DbLnkList* string_pool = NULL; // String literals already emitted, holding their label as the secondary value
 static DbLnkList* bss_vars = NULL;
 static Parameter* curFuncParams = NULL;
+static const char* curFuncName = NULL;
+static char* coldCode = NULL;	// Branches of the current function which aren't expected to be taken, placed after its epilogue
+static char* resultAddress = NULL;	// Location of the address a composite result is copied to, if the current function returns one by reference
+static bool flatFrame = false;	// The function has labels or allocates stack at runtime, so every block's locals are allocated with the frame
+static int flatStackSize = 0;	// Stack needed by the blocks generated so far at the current nesting level, in a flat frame
+static DbLnkList* stackSaves = NULL;	// Slots holding the stack pointer on entry to the enclosing blocks which release variable-length arrays, innermost first
+static const char* stackMark = NULL;	// Slot holding the stack pointer expected at this point of such a block, or NULL outside of them
 
 static const char* GenExpressionAsm(ASTNode* node);
 static const char* GenStatementAsm(ASTNode* node);
 static const char* GenerateAsmFromList(ASTNodeList* list);
 static const char* GenCompoundAssignment(ASTNode* node);
+static const char* GenBlockAsm(ASTNode* node);
+static const char* GenInline(ASTNode* node);
+static char* GenCast(ASTNode* node);
+static char* AsmRegisterName(int reg, int size);
+static const char* MoveSuffix(int size);
 
 struct {
 	int lbreak;
 	int lcontinue;
+	int lreturn; // Label returns jump to inside an inlined body, or -1 to return from the function
+	DbLnkList* breakSaves;		// Stack saves of the blocks enclosing the target of 'break'
+	DbLnkList* continueSaves;	// Stack saves of the blocks enclosing the target of 'continue'
 } labels;
 
 enum paramMode {
@@ -50,6 +73,35 @@ static char* CalculateParamPosition(int n, enum paramMode mode){
 	return _strdup(loc);
 }
 
+/// @brief Get the assembler symbol of a label of the current function.
+static char* LabelSymbol(const char* label){
+	const char* format = "L%s.%s";
+	return sngenf(strlen(format) + strlen(curFuncName) + strlen(label) + 1, format, curFuncName, label);
+}
+
+/// @brief Account for the locals of a scope which has been generated.
+/// In a flat frame, a jump between blocks must leave %rsp unchanged, so the stack is allocated once by the function instead.
+/// @param outer The stack needed by the blocks preceding this scope at its nesting level.
+/// @return The stack the scope should allocate itself.
+static int FlattenScopeStack(int size, int outer){
+	if(!flatFrame){
+		flatStackSize = outer;
+		return size;
+	}
+	if(size + flatStackSize > outer)
+		outer = size + flatStackSize;
+	flatStackSize = outer;
+	return 0;
+}
+
+/// @return An alignment directive, or an empty string if no alignment beyond that of the preceding data is needed.
+static char* GenAlignDirective(int alignment){
+	if(alignment <= 1)
+		return calloc(1, sizeof(char));
+	const char* format = "	.align	%d\n";
+	return sngenf(strlen(format) + intlen(alignment) + 1, format, alignment);
+}
+
 static const char* GenLitInt(ASTNode* node){
 	if(node == NULL)			FatalM("Expected an AST node, got NULL instead.", Line);
 	if(node->op != A_LitInt)	FatalM("Expected literal int in expression!", Line);
@@ -64,23 +116,71 @@ static const char* GenLitInt(ASTNode* node){
 	return sngenf(strlen(format) + intlen(value) + 1, format, value);
 }
 
+// Floating values are kept in %rax as their bits, and only moved to SSE registers to be operated on
+static char SSESuffix(PrimordialType type){
+	return type == P_Float ? 's' : 'd';
+}
+
+static const char* FloatDirective(PrimordialType type){
+	return type == P_Float ? "float" : "double";
+}
+
+/// @brief Get the instruction moving a floating value from %rax to %xmm0, or from %rcx to %xmm1.
+static const char* MoveToSSE(PrimordialType type, bool second){
+	if(type == P_Float)
+		return second ? "	movd	%ecx,	%xmm1\n" : "	movd	%eax,	%xmm0\n";
+	return second ? "	movq	%rcx,	%xmm1\n" : "	movq	%rax,	%xmm0\n";
+}
+
+/// @brief Get the instruction moving a floating value from %xmm0 to %rax.
+static const char* MoveFromSSE(PrimordialType type){
+	return type == P_Float ? "	movd	%xmm0,	%eax\n" : "	movq	%xmm0,	%rax\n";
+}
+
+/// @brief Emit a floating literal to read-only data; Its text is converted by the assembler.
+static char* GenLitFloat(ASTNode* node){
+	const char* format =
+		"	.align	8\n"
+		"L%d:\n"
+		"	.%s	%s\n"
+	;
+	const char* directive = FloatDirective(node->type);
+	char* buffer = sngenf(strlen(format) + intlen(lVar) + strlen(directive) + strlen(node->value.strVal) + 1, format, lVar, directive, node->value.strVal);
+	strapp(&rodata_section, buffer);
+	free(buffer);
+	format = node->type == P_Float ? "	movl	L%d(%%rip),	%%eax\n" : "	movq	L%d(%%rip),	%%rax\n";
+	buffer = sngenf(strlen(format) + intlen(lVar) + 1, format, lVar);
+	lVar++;
+	return buffer;
+}
+
+/// @brief Emit a string literal to read-only data, unless an identical literal already has been.
+/// @return The label of the string literal.
+static int GenStringLiteral(const char* str){
+	for(DbLnkList* pooled = string_pool; pooled != NULL; pooled = pooled->next){
+		ASTNode* literal = pooled->val;
+		if(streq(literal->value.strVal, str))
+			return literal->secondaryValue.intVal;
+	}
+	ASTNode* literal = MakeASTLeaf(A_LitStr, P_Char + 1, FlexStr(str));
+	literal->secondaryValue = FlexInt(lVar);
+	string_pool = MakeDbLnkList(literal, NULL, string_pool);
+	const char* format =
+		"L%d:\n"
+		"	.ascii \"%s\\0\"\n"
+	;
+	char* buffer = sngenf(strlen(format) + strlen(str) + intlen(lVar) + 1, format, lVar, str);
+	strapp(&rodata_section, buffer);
+	free(buffer);
+	return lVar++;
+}
+
 static char* GenLitStr(ASTNode* node){
 	if(node == NULL)			FatalM("Expected an AST node, got NULL instead.", Line);
 	if(node->op != A_LitStr)	FatalM("Expected literal String in expression!", Line);
 	const char* format = "	leaq	L%d(%%rip),	%%rax\n";
-	char* buffer = sngenf(strlen(format) + strlen(node->value.strVal) + (2 * intlen(lVar)) + 1, format, lVar);
-	{
-		// .data
-		const char* format =
-			"L%d:\n"
-			"	.ascii \"%s\\0\"\n"
-		;
-		char* buffer = sngenf(strlen(format) + strlen(node->value.strVal) + intlen(lVar) + 1, format, lVar, node->value.strVal);
-		strapp(&data_section, buffer);
-		free(buffer);
-	}
-	lVar++;
-	return buffer;
+	int label = GenStringLiteral(node->value.strVal);
+	return sngenf(strlen(format) + intlen(label) + 1, format, label);
 }
 
 static char* GenExpressionList(ASTNode* node){
@@ -90,39 +190,124 @@ static char* GenExpressionList(ASTNode* node){
 	return ret;
 }
 
+#define COPY_UNROLL_MAX	64	// Largest composite copied by a sequence of moves rather than a string instruction
+
+/// @brief Generate a copy of a composite from the address in %rax to the address in %rcx, both of which are preserved.
+/// Small composites are copied by moves of decreasing width through %xmm0 and %rdx, larger ones by rep movs.
+static char* GenCompositeCopy(int size){
+	char* str = calloc(1, sizeof(char));
+	if(size > COPY_UNROLL_MAX){
+		bool quadwords = size % 8 == 0;
+		const char* format =
+			"	pushq	%%rsi\n"
+			"	pushq	%%rdi\n"
+			"	movq	%%rax,	%%rsi\n"
+			"	movq	%%rcx,	%%rdi\n"
+			"	movq	$%d,	%%rcx\n"
+			"	cld\n"
+			"	rep %s\n"
+			"	leaq	-%d(%%rdi),	%%rcx\n"
+			"	popq	%%rdi\n"
+			"	popq	%%rsi\n"
+		;
+		free(str);
+		return sngenf(strlen(format) + (2 * intlen(size)) + 6, format, quadwords ? size / 8 : size, quadwords ? "movsq" : "movsb", size);
+	}
+	int offset = 0;
+	while(offset < size){
+		const char* format = NULL;
+		int width = 1;
+		if(size - offset >= 16){
+			format = "	movdqu	%d(%%rax),	%%xmm0\n	movdqu	%%xmm0,	%d(%%rcx)\n";
+			width = 16;
+		}
+		else if(size - offset >= 8){
+			format = "	movq	%d(%%rax),	%%rdx\n	movq	%%rdx,	%d(%%rcx)\n";
+			width = 8;
+		}
+		else if(size - offset >= 4){
+			format = "	movl	%d(%%rax),	%%edx\n	movl	%%edx,	%d(%%rcx)\n";
+			width = 4;
+		}
+		else if(size - offset >= 2){
+			format = "	movw	%d(%%rax),	%%dx\n	movw	%%dx,	%d(%%rcx)\n";
+			width = 2;
+		}
+		else
+			format = "	movb	%d(%%rax),	%%dl\n	movb	%%dl,	%d(%%rcx)\n";
+		char* buffer = sngenf(strlen(format) + (2 * intlen(offset)) + 1, format, offset, offset);
+		strapp(&str, buffer);
+		free(buffer);
+		offset += width;
+	}
+	return str;
+}
+
+/// @brief Reserve space in the frame of the current scope for a composite which only exists while an expression is evaluated.
+/// The space is aligned to 16 bytes, as the ABI requires of copies passed by reference.
+/// @return The location of the space, relative to the frame pointer.
+static char* ReserveTemporary(int size){
+	int n = stackIndex[scope] = (stackIndex[scope] - size) & -16;
+	ReserveLocalStack(scope, size + 15);
+	return sngenf(7 + intlen(n), "%d(%%rbp)", n);
+}
+
+/// @brief Generate a copy of the composite addressed by %rax to a location, leaving the location's address in %rax.
+static char* GenCopyTo(const char* loc, int size){
+	const char* format = "	leaq	%s,	%%rcx\n";
+	char* str = sngenf(strlen(format) + strlen(loc) + 1, format, loc);
+	char* copy = GenCompositeCopy(size);
+	strapp(&str, copy);
+	strapp(&str, "	movq	%rcx,	%rax\n");
+	free(copy);
+	return str;
+}
+
 static const char* GenFuncCall(ASTNode* node){
 	if(node == NULL)				FatalM("Expected an AST node, got NULL instead! (In gen.h)", __LINE__);
 	if(node->op != A_FunctionCall)	FatalM("Expected variable reference in expression! (In gen.h)", __LINE__);
 	const char* id = node->value.strVal;
 	ASTNodeList* params = node->secondaryValue.ptrVal;
-	int pCount = params->count;
+	// Composites which don't fit in a register are returned through a pointer passed before the arguments
+	int hidden = IsMemoryComposite(node->type, node->cType) ? 1 : 0;
+	int pCount = params->count + hidden;
 	char* paramInit = calloc(1, sizeof(char));
 	char* paramRecall = calloc(1, sizeof(char));
 	int offset = pCount < 4 ? 32 : 32 + 8 * (pCount - 4);
 	offset = offset % 16 ? (offset / 16 + 1) * 16 : offset;
-	for (int i = pCount - 1; i >= 0; i--) {
-		ASTNode* curNode = params->nodes[i];
+	if(unresolvedPushes % 2)
+		offset += 8;
+	callAreaSize += offset;
+	for (int i = pCount - 1; i >= hidden; i--) {
+		ASTNode* curNode = params->nodes[i - hidden];
 		const char* const format = "%s	movq	%%rax,	%s\n";
 		char* pos = CalculateParamPosition(i, P_MODE_SHADOW);
 		const char* inner = GenExpressionAsm(curNode);
-		if(curNode->cType != NULL && GetTypeSize(curNode->type, curNode->cType) > 8){
-			switch(curNode->op){
-				case A_Dereference:
-					if(curNode->lhs->op != A_VarRef){
-						inner = GenExpressionAsm(curNode->lhs); // Loads the address into %eax
-						break;
-					}
-					// continue
-					FatalM("Composite dereference in function call!", Line);
-				case A_VarRef:		FatalM("Composite variable reference in function call!", Line);
-				default:			FatalM("Unhandled lvalue in function call composite! (Internal @ gen.h)", __LINE__);
-			}
+		// Composites which don't fit in a register are passed by the address of a copy the callee may modify
+		if(IsMemoryComposite(curNode->type, curNode->cType)){
+			int size = GetTypeSize(curNode->type, curNode->cType);
+			char* temporary = ReserveTemporary(size);
+			char* copy = GenCopyTo(temporary, size);
+			inner = strjoin(inner, copy);
+			free(temporary);
+			free(copy);
 		}
 		char* buffer = sngenf(strlen(inner) + strlen(format) + strlen(pos) + 1, format, inner, pos);
 		strapp(&paramInit, buffer);
 		free(pos);
 		free(buffer);
 	}
+	if(hidden){
+		char* result = ReserveTemporary(GetTypeSize(node->type, node->cType));
+		const char* format =
+			"	leaq	%s,	%%rax\n"
+			"	movq	%%rax,	(%%rsp)\n"
+		;
+		char* buffer = sngenf(strlen(format) + strlen(result) + 1, format, result);
+		strapp(&paramInit, buffer);
+		free(buffer);
+		free(result);
+	}
 	int shadowPCount = pCount <= 4 ? pCount : 4;
 	for (int i = 0; i < shadowPCount; i++){
 		const char* format = "	movq	%s,	%s\n";
@@ -132,18 +317,318 @@ static const char* GenFuncCall(ASTNode* node){
 		strapp(&paramRecall, buffer);
 		free(pos);
 		free(buffer);
+		// Floating arguments are passed in the SSE register of their position; Variadic callees read the integer register
+		PrimordialType type = i < hidden ? node->type : params->nodes[i - hidden]->type;
+		if(IsFloating(type)){
+			format = "	movs%c	%s,	%%xmm%d\n";
+			buffer = sngenf(strlen(format) + strlen(shadowPos) + 1, format, SSESuffix(type), shadowPos, i);
+			strapp(&paramRecall, buffer);
+			free(buffer);
+		}
+		free(shadowPos);
 	}
 	strapp(&paramInit, paramRecall);
 	free(paramRecall);
-	if(unresolvedPushes % 2)
-		offset += 8;
+	callAreaSize -= offset;
+	if(node->attributes & AT_NoReturn){
+		// Nothing follows a call which never returns, so the stack needn't be restored
+		const char* format =
+			"	subq	$%d,	%%rsp\n"
+			"%s"	// ParamInit
+			"	call	%s\n"
+		;
+		return sngenf(strlen(format) + strlen(paramInit) + intlen(offset) + strlen(id) + 1, format, offset, paramInit, id);
+	}
+	// Floating results are returned in %xmm0
+	const char* result = IsFloating(node->type) ? MoveFromSSE(node->type) : "";
 	const char* format =
 		"	subq	$%d,	%%rsp\n"
 		"%s"	// ParamInit
 		"	call	%s\n"
+		"%s"	// Result
 		"	addq	$%d,	%%rsp\n"
 	;
-	return sngenf(strlen(format) + strlen(paramInit) + (2 * intlen(offset)) + strlen(id) + 1, format, offset, paramInit, id, offset);
+	return sngenf(strlen(format) + strlen(paramInit) + (2 * intlen(offset)) + strlen(id) + strlen(result) + 1, format, offset, paramInit, id, result, offset);
+}
+
+/// @brief Get the directive including the file of an embed builtin, with its path escaped for the assembler.
+static char* GenIncbin(ASTNode* node){
+	const char* path = ((ASTNodeList*)node->secondaryValue.ptrVal)->nodes[0]->value.strVal;
+	char* escaped = malloc((2 * strlen(path) + 1) * sizeof(char));
+	int length = 0;
+	for(int i = 0; path[i] != '\0'; i++){
+		if(path[i] == '\\' || path[i] == '"')
+			escaped[length++] = '\\';
+		escaped[length++] = path[i];
+	}
+	escaped[length] = '\0';
+	const char* format = "	.incbin	\"%s\"\n";
+	char* line = sngenf(strlen(format) + length + 1, format, escaped);
+	free(escaped);
+	return line;
+}
+
+/// @brief Emit the file of an embed builtin to read-only data.
+/// @return The label of the embedded data.
+static int GenEmbed(ASTNode* node){
+	char* incbin = GenIncbin(node);
+	const char* format =
+		"L%d:\n"
+		"%s"	// Incbin
+	;
+	char* buffer = sngenf(strlen(format) + intlen(lVar) + strlen(incbin) + 1, format, lVar, incbin);
+	strapp(&rodata_section, buffer);
+	free(buffer);
+	free(incbin);
+	return lVar++;
+}
+
+/// @brief Get the instruction extending a value held in the low bits of %rax to the width of the register.
+static const char* SizedExtension(PrimordialType type){
+	switch(GetPrimSize(type)){
+		case 1:		return IsUnsigned(type) ? "	movzbq	%al,	%rax\n" : "	movsbq	%al,	%rax\n";
+		case 4:		return IsUnsigned(type) ? "	movl	%eax,	%eax\n" : "	movslq	%eax,	%rax\n";
+		default:	return "";
+	}
+}
+
+/// @brief Generate an atomic built-in function, the object of which is addressed by its first argument.
+/// x86 loads and stores already have acquire and release semantics, so only sequentially consistent stores
+/// and thread fences need a locked instruction or a fence. Any memory order prevents reordering by the store propagation.
+static char* GenAtomicBuiltin(ASTNode* node, const char* op){
+	ASTNodeList* params = node->secondaryValue.ptrVal;
+	MemoryOrder order = GetAtomicOrder(node);
+	if(params->count == 1)
+		return _strdup(streq(op, "thread_fence") && order == MO_SeqCst ? "	mfence\n" : "");
+	PrimordialType type = params->nodes[0]->type - 1;
+	int size = GetPrimSize(type);
+	const char* suffix = MoveSuffix(size);
+	char* value = AsmRegisterName(0, size);
+	char* str = NULL;
+	if(streq(op, "load")){
+		str = _strdup(GenExpressionAsm(params->nodes[0]));
+		const char* format = "	mov%s	(%%rax),	%s\n";
+		char* buffer = sngenf(strlen(format) + strlen(suffix) + strlen(value) + 1, format, suffix, value);
+		strapp(&str, buffer);
+		strapp(&str, SizedExtension(type));
+		free(buffer);
+		free(value);
+		return str;
+	}
+	bool compare = streq(op, "compare_exchange");
+	// The operand is evaluated first, then the expected value's address, leaving the object's address in %rdx
+	str = _strdup(GenExpressionAsm(params->nodes[compare ? 2 : 1]));
+	strapp(&str, "	push	%rax\n");
+	unresolvedPushes++;
+	if(compare){
+		strapp(&str, GenExpressionAsm(params->nodes[1]));
+		strapp(&str, "	push	%rax\n");
+		unresolvedPushes++;
+	}
+	strapp(&str, GenExpressionAsm(params->nodes[0]));
+	strapp(&str, "	movq	%rax,	%rdx\n");
+	if(compare){
+		strapp(&str, "	pop		%r8\n");
+		unresolvedPushes--;
+	}
+	strapp(&str, "	pop		%rax\n");
+	unresolvedPushes--;
+	char* operand = AsmRegisterName(2, size);
+	char* scratch = AsmRegisterName(6, size);
+	const char* format = NULL;
+	char* buffer = NULL;
+	if(streq(op, "store")){
+		// A sequentially consistent store must not be reordered with later loads, which the implicit lock of xchg prevents
+		format = order == MO_SeqCst ? "	xchg%s	%s,	(%%rdx)\n" : "	mov%s	%s,	(%%rdx)\n";
+		buffer = sngenf(strlen(format) + strlen(suffix) + strlen(value) + 1, format, suffix, value);
+	}
+	else if(streq(op, "exchange")){
+		format = "	xchg%s	%s,	(%%rdx)\n";
+		buffer = sngenf(strlen(format) + strlen(suffix) + strlen(value) + 1, format, suffix, value);
+	}
+	else if(streq(op, "fetch_add")){
+		format = "	lock xadd%s	%s,	(%%rdx)\n";
+		buffer = sngenf(strlen(format) + strlen(suffix) + strlen(value) + 1, format, suffix, value);
+	}
+	else if(streq(op, "fetch_or")){
+		// There's no instruction returning the previous value of an or, so it's retried until no other store intervenes
+		labelPref++;
+		format =
+			"	movq	%%rax,	%%rcx\n"
+			"	mov%s	(%%rdx),	%s\n"
+			"%d1:\n"
+			"	mov%s	%s,	%s\n"
+			"	or%s	%s,	%s\n"
+			"	lock cmpxchg%s	%s,	(%%rdx)\n"
+			"	jne		%d1b\n"
+		;
+		buffer = sngenf(strlen(format) + (4 * strlen(suffix)) + (3 * strlen(value)) + (3 * strlen(scratch)) + strlen(operand) + (2 * intlen(labelPref)) + 1, format,
+			suffix, value, labelPref, suffix, value, scratch, suffix, operand, scratch, suffix, scratch, labelPref);
+	}
+	else{
+		// The value found is written back to the expected value, which is unchanged if the exchange succeeded
+		format =
+			"	movq	%%rax,	%%rcx\n"
+			"	mov%s	(%%r8),	%s\n"
+			"	lock cmpxchg%s	%s,	(%%rdx)\n"
+			"	mov%s	%s,	(%%r8)\n"
+			"	movq	$0,		%%rax\n"
+			"	sete	%%al\n"
+		;
+		buffer = sngenf(strlen(format) + (3 * strlen(suffix)) + (2 * strlen(value)) + strlen(operand) + 1, format, suffix, value, suffix, operand, suffix, value);
+	}
+	strapp(&str, buffer);
+	if(!compare && !streq(op, "store"))
+		strapp(&str, SizedExtension(type));
+	free(buffer);
+	free(value);
+	free(operand);
+	free(scratch);
+	return str;
+}
+
+/// @brief Allocate the number of bytes in %rax on the stack, leaving the address of the allocation in %rax.
+/// The allocation is rounded to 16 bytes to keep the stack aligned. Anything pushed or stored below the stack pointer
+/// by the expression being evaluated is moved down past the allocation, so the allocation lies above it.
+static char* GenStackAllocation(){
+	int temporaries = unresolvedPushes * 8 + callAreaSize;
+	char* str = _strdup(
+		"	addq	$15,	%rax\n"
+		"	andq	$-16,	%rax\n"
+		"	subq	%rax,	%rsp\n"
+	);
+	for(int offset = 0; offset < temporaries; offset += 8){
+		const char* format =
+			"	movq	%d(%%rsp,%%rax),	%%rcx\n"
+			"	movq	%%rcx,	%d(%%rsp)\n"
+		;
+		char* buffer = sngenf(strlen(format) + (2 * intlen(offset)) + 1, format, offset, offset);
+		strapp(&str, buffer);
+		free(buffer);
+	}
+	if(!temporaries){
+		strapp(&str, "	movq	%rsp,	%rax\n");
+		return str;
+	}
+	const char* format = "	leaq	%d(%%rsp),	%%rax\n";
+	char* buffer = sngenf(strlen(format) + intlen(temporaries) + 1, format, temporaries);
+	strapp(&str, buffer);
+	free(buffer);
+	return str;
+}
+
+/// @brief Generate a bit manipulation or hint built-in function.
+/// Instructions outside the x86-64 baseline are only used if the target is declared to have them; Otherwise an equivalent sequence is.
+static char* GenIntrinsicBuiltin(ASTNode* node, const char* id){
+	ASTNodeList* params = node->secondaryValue.ptrVal;
+	if(streq(id, "unreachable"))
+		return _strdup("	ud2\n");
+	// Hints don't change the value of their operand
+	if(streq(id, "expect") || streq(id, "assume_aligned"))
+		return _strdup(GenExpressionAsm(params->nodes[0]));
+	if(streq(id, "prefetch")){
+		// There's no baseline instruction prefetching for a write, so writes are prefetched as reads
+		const char* instr = NULL;
+		int locality = params->nodes[2]->value.intVal;
+		switch(locality){
+			case 0:		instr = "	prefetchnta	(%rax)\n";	break;
+			case 1:		instr = "	prefetcht2	(%rax)\n";	break;
+			case 2:		instr = "	prefetcht1	(%rax)\n";	break;
+			default:	instr = "	prefetcht0	(%rax)\n";	break;
+		}
+		return strjoin(GenExpressionAsm(params->nodes[0]), instr);
+	}
+	ASTNode* operand = params->nodes[0];
+	bool wide = GetPrimSize(operand->type) == 8;
+	if(streq(id, "alloca")){
+		char* str = _strdup(GenExpressionAsm(operand));
+		strapp(&str, SizedExtension(operand->type));
+		char* allocation = GenStackAllocation();
+		strapp(&str, allocation);
+		free(allocation);
+		return str;
+	}
+	if(streq(id, "rotl") || streq(id, "rotr")){
+		int size = GetPrimSize(operand->type);
+		char* value = AsmRegisterName(0, size);
+		char* str = _strdup(GenExpressionAsm(params->nodes[1]));
+		strapp(&str, "	push	%rax\n");
+		unresolvedPushes++;
+		strapp(&str, GenExpressionAsm(operand));
+		unresolvedPushes--;
+		const char* format =
+			"	pop		%%rcx\n"
+			"	ro%c%s	%%cl,	%s\n"
+		;
+		char* buffer = sngenf(strlen(format) + strlen(value) + 2, format, id[3], MoveSuffix(size), value);
+		strapp(&str, buffer);
+		strapp(&str, SizedExtension(operand->type));
+		free(buffer);
+		free(value);
+		return str;
+	}
+	const char* instr = NULL;
+	if(streq(id, "popcount")){
+		if(USE_POPCNT)
+			instr = wide ? "	popcntq	%rax,	%rax\n" : "	popcntl	%eax,	%eax\n";
+		else
+			// Bits are summed in pairs, then nibbles, then bytes, which the multiplication sums into the top byte
+			instr = wide
+				?	"	movq	%rax,	%rcx\n"
+					"	shrq	$1,		%rcx\n"
+					"	movabsq	$0x5555555555555555,	%rdx\n"
+					"	andq	%rdx,	%rcx\n"
+					"	subq	%rcx,	%rax\n"
+					"	movabsq	$0x3333333333333333,	%rdx\n"
+					"	movq	%rax,	%rcx\n"
+					"	shrq	$2,		%rax\n"
+					"	andq	%rdx,	%rcx\n"
+					"	andq	%rdx,	%rax\n"
+					"	addq	%rcx,	%rax\n"
+					"	movq	%rax,	%rcx\n"
+					"	shrq	$4,		%rcx\n"
+					"	addq	%rcx,	%rax\n"
+					"	movabsq	$0x0F0F0F0F0F0F0F0F,	%rdx\n"
+					"	andq	%rdx,	%rax\n"
+					"	movabsq	$0x0101010101010101,	%rdx\n"
+					"	imulq	%rdx,	%rax\n"
+					"	shrq	$56,	%rax\n"
+				:	"	movl	%eax,	%ecx\n"
+					"	shrl	$1,		%ecx\n"
+					"	andl	$0x55555555,	%ecx\n"
+					"	subl	%ecx,	%eax\n"
+					"	movl	%eax,	%ecx\n"
+					"	shrl	$2,		%eax\n"
+					"	andl	$0x33333333,	%ecx\n"
+					"	andl	$0x33333333,	%eax\n"
+					"	addl	%ecx,	%eax\n"
+					"	movl	%eax,	%ecx\n"
+					"	shrl	$4,		%ecx\n"
+					"	addl	%ecx,	%eax\n"
+					"	andl	$0x0F0F0F0F,	%eax\n"
+					"	imull	$0x01010101,	%eax\n"
+					"	shrl	$24,	%eax\n";
+	}
+	else if(streq(id, "clz")){
+		// The index of the highest set bit is subtracted from the highest index, by flipping its bits
+		if(USE_LZCNT)
+			instr = wide ? "	lzcntq	%rax,	%rax\n" : "	lzcntl	%eax,	%eax\n";
+		else
+			instr = wide ? "	bsrq	%rax,	%rax\n	xorq	$63,	%rax\n" : "	bsrl	%eax,	%eax\n	xorl	$31,	%eax\n";
+	}
+	else if(streq(id, "ctz")){
+		if(USE_BMI)
+			instr = wide ? "	tzcntq	%rax,	%rax\n" : "	tzcntl	%eax,	%eax\n";
+		else
+			instr = wide ? "	bsfq	%rax,	%rax\n" : "	bsfl	%eax,	%eax\n";
+	}
+	else if(streq(id, "bswap16"))
+		instr = "	rolw	$8,		%ax\n	movzwl	%ax,	%eax\n";
+	else if(streq(id, "bswap32"))
+		instr = "	bswap	%eax\n";
+	else
+		instr = "	bswap	%rax\n";
+	return strjoin(GenExpressionAsm(operand), instr);
 }
 
 static char* GenBuiltinCall(ASTNode* node){
@@ -177,18 +662,84 @@ static char* GenBuiltinCall(ASTNode* node){
 		free(buffer);
 		return _strdup(ret);
 	}
+	if(strbeg(idStr, "atomic_"))
+		return GenAtomicBuiltin(node, idStr + 7);
+	if(IsPureBuiltin(node) || streq(idStr, "prefetch") || streq(idStr, "unreachable") || streq(idStr, "alloca"))
+		return GenIntrinsicBuiltin(node, idStr);
+	if(streq(idStr, "embed")){
+		const char* format = "	leaq	L%d(%%rip),	%%rax\n";
+		int label = GenEmbed(node);
+		return sngenf(strlen(format) + intlen(label) + 1, format, label);
+	}
 	FatalM("Unknown built-in function! (Internal @ gen.h)", NOLINE);
 }
 
-static const char* GenVarRef(ASTNode* node){
-	if(node == NULL)			FatalM("Expected an AST node, got NULL instead! (In gen.h)", __LINE__);
-	if(node->op != A_VarRef)	FatalM("Expected variable reference in expression! (In gen.h)", __LINE__);
-	const char* id = node->value.strVal;
-	SymEntry* var = FindVar(id, scope);
-	if(var == NULL)				FatalM("Variable not defined!", Line);
+static Location* InitLocation(Location* location, LocationKind kind, const char* name, int offset){
+	location->kind = kind;
+	location->name = name;
+	location->offset = offset;
+	return location;
+}
+
+/// @brief Format the operand of an instruction accessing a location, displaced by a number of bytes.
+static char* GenOperand(const Location* location, int displacement){
+	int offset = location->offset + displacement;
+	switch(location->kind){
+		case L_Frame:{
+			const char* format = "%d(%%rbp)";
+			return sngenf(strlen(format) + intlen(offset) + 1, format, offset);
+		}
+		case L_Symbol:{
+			const char* format = offset ? "%s%+d(%%rip)" : "%s(%%rip)";
+			return sngenf(strlen(format) + strlen(location->name) + intlen(offset) + 1, format, location->name, offset);
+		}
+		case L_Register:
+			if(offset)	FatalM("Variables held in registers can't be displaced! (Internal @ gen.h)", __LINE__);
+			return _strdup(location->name);
+		default:
+			FatalM("Variable has no location which can be used as an operand! (Internal @ gen.h)", __LINE__);
+	}
+}
+
+/// @brief Fold the address of a member or element at a constant offset in a variable into a single memory operand.
+/// @return The operand, or NULL if the address must be computed at runtime.
+static char* GenDirectOperand(ASTNode* address){
+	long long displacement = 0;
+	while(address->op == A_Add || address->op == A_Subtract || (address->op == A_AddressOf && address->lhs->op == A_Dereference)){
+		if(address->op == A_AddressOf)
+			address = address->lhs->lhs;
+		else if(address->rhs->op == A_LitInt){
+			displacement += address->op == A_Add ? address->rhs->value.intVal : -address->rhs->value.intVal;
+			address = address->lhs;
+		}
+		else if(address->op == A_Add && address->lhs->op == A_LitInt){
+			displacement += address->lhs->value.intVal;
+			address = address->rhs;
+		}
+		else
+			return NULL;
+		// Displacements are signed 32-bit
+		if(displacement > 2147483647 || displacement < -2147483647)
+			return NULL;
+	}
+	SymEntry* var = NULL;
+	if(address->op == A_AddressOf && address->lhs->op == A_VarRef)
+		var = address->lhs->symbol;
+	// Arrays and composites which don't fit in a register are referred to by their address
+	else if(address->op == A_VarRef){
+		var = address->symbol;
+		if(var != NULL && !var->length && !IsMemoryComposite(var->type, var->cType))
+			return NULL;
+	}
+	if(var == NULL || (var->location.kind != L_Frame && var->location.kind != L_Symbol))
+		return NULL;
+	return GenOperand(&var->location, displacement);
+}
+
+/// @brief Generate a load of an object of a size into %rax, extended according to its signedness.
+static char* GenLoad(const char* operand, int size, bool isUnsigned){
 	const char* format = NULL;
-	bool isUnsigned = IsUnsigned(node->type);
-	switch(GetTypeSize(var->type, var->cType)){
+	switch(size){
 		case 1:		format = isUnsigned 
 						? "	movzbq	%s,	%%rax\n"
 						: "	movsbq	%s,	%%rax\n";
@@ -204,81 +755,172 @@ static const char* GenVarRef(ASTNode* node){
 		case 8:		format = "	movq	%s,	%%rax\n";	break;
 		default:	format = "	movq	%s,	%%rax\n";	break;
 	};
-	return sngenf(strlen(format) + strlen(var->value.strVal) + 1, format, var->value);
+	return sngenf(strlen(format) + strlen(operand) + 1, format, operand);
+}
+
+/// @brief Generate a store of the value in %rax, of a size, to an operand.
+static char* GenStore(const char* operand, int size){
+	const char* format = NULL;
+	switch(size){
+		case 1:		format = "	movb	%%al,	%s\n";	break;
+		case 2:		format = "	movw	%%ax,	%s\n";	break;
+		case 4:		format = "	movl	%%eax,	%s\n";	break;
+		case 8:		format = "	movq	%%rax,	%s\n";	break;
+		default:	FatalM("Non-standard sizes not yet supported in assignments! (Internal @ gen.h)", __LINE__);
+	}
+	return sngenf(strlen(format) + strlen(operand) + 1, format, operand);
+}
+
+/// @brief Generate the address of a thread-local variable, at its offset in the calling thread's copy of the TLS section.
+static char* GenThreadLocalAddress(SymEntry* var){
+	const char* format =
+		"	movl	_tls_index(%%rip),	%%eax\n"
+		"	shlq	$3,	%%rax\n"
+		"	addq	%%gs:88,	%%rax\n"	// ThreadLocalStoragePointer of the thread environment block
+		"	movq	(%%rax),	%%rax\n"
+		"	leaq	%s@secrel32(%%rax),	%%rax\n"
+	;
+	return sngenf(strlen(format) + strlen(var->location.name) + 1, format, var->location.name);
+}
+
+static const char* GenVarRef(ASTNode* node){
+	if(node == NULL)			FatalM("Expected an AST node, got NULL instead! (In gen.h)", __LINE__);
+	if(node->op != A_VarRef)	FatalM("Expected variable reference in expression! (In gen.h)", __LINE__);
+	SymEntry* var = node->symbol;
+	if(var == NULL)				FatalM("Variable not defined!", Line);
+	char* operand = NULL;
+	char* str = NULL;
+	// Arrays decay to a pointer to their first element, and composites which don't fit in a register are handled by their address
+	if(var->length || IsMemoryComposite(var->type, var->cType)){
+		if(var->sValue.intVal & C_ThreadLocal)
+			return GenThreadLocalAddress(var);
+		const char* format = "	leaq	%s,	%%rax\n";
+		operand = GenOperand(&var->location, 0);
+		str = sngenf(strlen(format) + strlen(operand) + 1, format, operand);
+	}
+	else {
+		operand = GenOperand(&var->location, 0);
+		str = GenLoad(operand, GetTypeSize(var->type, var->cType), IsUnsigned(node->type));
+	}
+	free(operand);
+	return str;
 }
 
 static char* GenAddressOf(ASTNode* node){
 	if(node->lhs->op != A_VarRef){
 		if(node->lhs->op == A_Dereference)
 			return _strdup(GenExpressionAsm(node->lhs->lhs));
+		// Members of composites returned or assigned by value are accessed through the address of the value
+		if(IsMemoryComposite(node->lhs->type, node->lhs->cType))
+			return _strdup(GenExpressionAsm(node->lhs));
+		if(node->lhs->type == P_Composite){
+			char* temporary = ReserveTemporary(8);
+			const char* format =
+				"%s"
+				"	movq	%%rax,	%s\n"
+				"	leaq	%s,	%%rax\n"
+			;
+			const char* value = GenExpressionAsm(node->lhs);
+			char* str = sngenf(strlen(format) + strlen(value) + (2 * strlen(temporary)) + 1, format, value, temporary, temporary);
+			free(temporary);
+			return str;
+		}
 		FatalM("Unsupported lvalue! (Internal @ gen.h)", __LINE__);
 	}
 	const char* format = "	leaq	%s,	%%rax\n";
-	SymEntry* varInfo = FindVar(node->lhs->value.strVal, scope);
-	const char* offset = varInfo->value.strVal;
-	return sngenf(strlen(format) + strlen(offset) + 1, format, offset);
+	SymEntry* varInfo = node->lhs->symbol;
+	if(varInfo->sValue.intVal & C_ThreadLocal)
+		return GenThreadLocalAddress(varInfo);
+	char* operand = GenOperand(&varInfo->location, 0);
+	char* str = sngenf(strlen(format) + strlen(operand) + 1, format, operand);
+	free(operand);
+	return str;
 }
 
 static char* GenDereference(ASTNode* node){
-	const char* format;
-	const char* offset;
-	if(node->lhs->op == A_VarRef){
-		format =
-			"	movq	%s,	%%rax\n"	// Offset
-			"	movq	(%%rax),	%%rax\n"
-		;
-		switch(GetTypeSize(node->type, node->cType)){
-			case 1:
-				format = 
-					"	movq	%s,	%%rax\n"	// Offset
-					"	movzbq	(%%rax),	%%rax\n"
-				;
-				break;
-			case 4:
-				format = 
-					"	movq	%s,	%%rax\n"	// Offset
-					"	movslq	(%%rax),	%%rax\n"
-				;
-				break;
-			case 8:		break;
-			default:	break;
-		}
-		SymEntry* varInfo = FindVar(node->lhs->value.strVal, scope);
-		if(varInfo == NULL)	FatalM("Failed to find variable!", Line);
-		offset = varInfo->value.strVal;
+	// Composites which don't fit in a register are handled by their address
+	if(IsMemoryComposite(node->type, node->cType))
+		return _strdup(GenExpressionAsm(node->lhs));
+	int size = GetTypeSize(node->type, node->cType);
+	bool isUnsigned = IsUnsigned(node->type);
+	// Members and elements at a constant offset in a variable are loaded directly
+	char* operand = GenDirectOperand(node->lhs);
+	if(operand != NULL){
+		char* str = GenLoad(operand, size, isUnsigned);
+		free(operand);
+		return str;
 	}
-	else{
+	char* load = GenLoad("(%rax)", size, isUnsigned);
+	char* str = strjoin(GenExpressionAsm(node->lhs), load);
+	free(load);
+	return str;
+}
+
+/// @brief Generate a conversion to or from a floating type.
+/// Conversions to integers go through a 64-bit integer, so unsigned 64-bit results are only correct below 2^63.
+static char* GenFloatingCast(ASTNode* node){
+	PrimordialType from = node->lhs->type;
+	PrimordialType to = node->type;
+	char* str = _strdup(GenExpressionAsm(node->lhs));
+	if(IsFloating(from) && IsFloating(to)){
+		strapp(&str, MoveToSSE(from, false));
+		strapp(&str, from == P_Float ? "	cvtss2sd	%xmm0,	%xmm0\n" : "	cvtsd2ss	%xmm0,	%xmm0\n");
+		strapp(&str, MoveFromSSE(to));
+		return str;
+	}
+	if(IsFloating(from)){
+		strapp(&str, MoveToSSE(from, false));
+		strapp(&str, from == P_Float ? "	cvttss2si	%xmm0,	%rax\n" : "	cvttsd2si	%xmm0,	%rax\n");
+		// Narrower results are truncated, and extended again as any other value of their type
+		ASTNode* narrow = MakeASTNode(A_Cast, to, MakeASTLeaf(A_RawASM, P_LongLong, FlexStr(str)), NULL, NULL, FlexNULL(), NULL);
+		return GenCast(narrow);
+	}
+	// Integers narrower than 64 bits are extended first, as they may have been computed in a wider register
+	if(GetPrimSize(from) < 8){
+		ASTNode* wide = MakeASTNode(A_Cast, from, MakeASTLeaf(A_RawASM, P_LongLong, FlexStr(str)), NULL, NULL, FlexNULL(), NULL);
+		str = GenCast(wide);
+	}
+	char suffix = SSESuffix(to);
+	const char* format =
+		"%s"
+		"	cvtsi2s%cq	%%rax,	%%xmm0\n"
+		"%s"
+	;
+	// Unsigned values with the top bit set are halved to convert them, keeping the lowest bit to round correctly, then doubled
+	if(IsUnsigned(from) && GetPrimSize(from) == 8){
+		labelPref++;
 		format =
-			"%s"						// Inner ASM
-			"	movq	(%%rax),	%%rax\n"
+			"%s"
+			"	testq	%%rax,	%%rax\n"
+			"	js		%d1f\n"
+			"	cvtsi2s%cq	%%rax,	%%xmm0\n"
+			"	jmp		%d2f\n"
+			"%d1:\n"
+			"	movq	%%rax,	%%rcx\n"
+			"	shrq	%%rcx\n"
+			"	andl	$1,		%%eax\n"
+			"	orq		%%rax,	%%rcx\n"
+			"	cvtsi2s%cq	%%rcx,	%%xmm0\n"
+			"	adds%c	%%xmm0,	%%xmm0\n"
+			"%d2:\n"
+			"%s"
 		;
-		switch(GetTypeSize(node->type, node->cType)){
-			case 1:
-				format = 
-					"%s"
-					"	movzbq	(%%rax),	%%rax\n"
-				;
-				break;
-			case 4:
-				format = 
-					"%s"
-					"	movslq	(%%rax),	%%rax\n"
-				;
-				break;
-			case 8:		break;
-			default:	break;
-		}
-		offset = GenExpressionAsm(node->lhs);
+		const char* move = MoveFromSSE(to);
+		return sngenf(strlen(format) + strlen(str) + (4 * intlen(labelPref)) + strlen(move) + 1, format, str, labelPref, suffix, labelPref, labelPref, suffix, suffix, labelPref, move);
 	}
-	return sngenf(strlen(format) + strlen(offset) + 1, format, offset);
+	const char* move = MoveFromSSE(to);
+	return sngenf(strlen(format) + strlen(str) + strlen(move) + 1, format, str, suffix, move);
 }
 
 static char* GenCast(ASTNode* node){
+	if(IsFloating(node->type) || IsFloating(node->lhs->type))
+		return GenFloatingCast(node);
 	const char* format = NULL;
+	bool isUnsigned = IsUnsigned(node->type);
 	switch(GetTypeSize(node->type, node->cType)){
-		case 1:		format = "%s	movzbq	%%al,	%%rax\n";	break;
-		case 2:		format = "%s	movzwq	%%ax,	%%rax\n";	break;
-		case 4:		format = "%s	movslq	%%eax,	%%rax\n";	break;
+		case 1:		format = isUnsigned ? "%s	movzbq	%%al,	%%rax\n" : "%s	movsbq	%%al,	%%rax\n";	break;
+		case 2:		format = isUnsigned ? "%s	movzwq	%%ax,	%%rax\n" : "%s	movswq	%%ax,	%%rax\n";	break;
+		case 4:		format = isUnsigned ? "%s	movl	%%eax,	%%eax\n" : "%s	movslq	%%eax,	%%rax\n";	break;
 		case 8:		format = "%s	movq	%%rax,	%%rax\n";	break;
 		default:	FatalM("Unhandled cast type size! (Internal @ gen.h)", __LINE__);
 	}
@@ -290,7 +932,8 @@ static const char* GenUnary(ASTNode* node){
 	if(node->lhs == NULL)	FatalM("Expected expression after unary operator!", Line);
 	const char* instr = NULL;
 	switch(node->op){
-		case A_Negate:				instr = "	neg		%rax\n";	break;
+		// Floating values are negated by flipping their sign bit
+		case A_Negate:				instr = node->type == P_Double ? "	btcq	$63,	%rax\n" : node->type == P_Float ? "	btcl	$31,	%eax\n" : "	neg		%rax\n";	break;
 		case A_BitwiseComplement:	instr = "	not		%rax\n";	break;
 		case A_Logicize:
 			instr =
@@ -310,6 +953,52 @@ static const char* GenUnary(ASTNode* node){
 	return strjoin(GenExpressionAsm(node->lhs), instr);
 }
 
+/// @brief Get the instructions of a floating binary operation, its operands being in %rax and %rcx.
+/// Operations which aren't commutative must have their lhs in %rax.
+static char* GenFloatingBinary(ASTNode* node){
+	PrimordialType type = node->lhs->type;
+	const char* format = NULL;
+	bool comparison = true;
+	switch(node->op){
+		case A_Add:				format = "	adds%c	%%xmm1,	%%xmm0\n";	comparison = false;	break;
+		case A_Subtract:		format = "	subs%c	%%xmm1,	%%xmm0\n";	comparison = false;	break;
+		case A_Multiply:		format = "	muls%c	%%xmm1,	%%xmm0\n";	comparison = false;	break;
+		case A_Divide:			format = "	divs%c	%%xmm1,	%%xmm0\n";	comparison = false;	break;
+		// Comparisons with NaN are unordered, which sets the parity flag; Only != holds for them
+		case A_EqualTo:
+			format =
+				"	ucomis%c	%%xmm1,	%%xmm0\n"
+				"	movq	$0,		%%rax\n"
+				"	sete	%%al\n"
+				"	setnp	%%cl\n"
+				"	andb	%%cl,	%%al\n"
+			;
+			break;
+		case A_NotEqualTo:
+			format =
+				"	ucomis%c	%%xmm1,	%%xmm0\n"
+				"	movq	$0,		%%rax\n"
+				"	setne	%%al\n"
+				"	setp	%%cl\n"
+				"	orb		%%cl,	%%al\n"
+			;
+			break;
+		case A_GreaterThan:		format = "	ucomis%c	%%xmm1,	%%xmm0\n	movq	$0,		%%rax\n	seta	%%al\n";	break;
+		case A_GreaterOrEqual:	format = "	ucomis%c	%%xmm1,	%%xmm0\n	movq	$0,		%%rax\n	setae	%%al\n";	break;
+		// The operands are swapped, as below is also set by unordered operands
+		case A_LessThan:		format = "	ucomis%c	%%xmm0,	%%xmm1\n	movq	$0,		%%rax\n	seta	%%al\n";	break;
+		case A_LessOrEqual:		format = "	ucomis%c	%%xmm0,	%%xmm1\n	movq	$0,		%%rax\n	setae	%%al\n";	break;
+		default:				FatalM("Floating operands are not valid for this operator!", Line);
+	}
+	char* str = strjoin(MoveToSSE(type, false), MoveToSSE(type, true));
+	char* instr = sngenf(strlen(format) + 1, format, SSESuffix(type));
+	strapp(&str, instr);
+	free(instr);
+	if(!comparison)
+		strapp(&str, MoveFromSSE(type));
+	return str;
+}
+
 static const char* GenLTRBinary(ASTNode* node){
 	if(node->lhs == NULL)	FatalM("Expected factor before binary operator!", Line);
 	if(node->rhs == NULL)	FatalM("Expected factor after binary operator!", Line);
@@ -337,6 +1026,8 @@ static const char* GenLTRBinary(ASTNode* node){
 			;
 			break;
 	}
+	if(IsFloating(node->lhs->type))
+		instr = GenFloatingBinary(node);
 	const char* lhs = GenExpressionAsm(node->lhs);
 	unresolvedPushes++;
 	const char* rhs = GenExpressionAsm(node->rhs);
@@ -352,6 +1043,10 @@ static const char* GenRTLBinary(ASTNode* node){
 	const char* popInstr	= "	pop		%rcx\n";
 	const char* instr = NULL;
 	bool isUnsigned = IsUnsigned(node->lhs->type) || IsUnsigned(node->rhs->type);
+	// Unsigned types narrower than int are promoted to int before comparison
+	bool unsignedCompare =
+		(IsUnsigned(node->lhs->type) && GetPrimSize(node->lhs->type) >= 4)
+		|| (IsUnsigned(node->rhs->type) && GetPrimSize(node->rhs->type) >= 4);
 	switch(node->op){
 		case A_Subtract:	instr = "	subq	%rcx,	%rax\n";	break;
 		case A_LeftShift:	instr = "	shl		%rcx,	%rax\n";	break;
@@ -367,34 +1062,28 @@ static const char* GenRTLBinary(ASTNode* node){
 				: "	cqo\n""	idiv	%rcx\n""	movq	%rdx,	%rax\n";
 			break;
 		case A_LessThan:
-			instr =
-				"	cmp		%rcx,	%rax\n"
-				"	movq	$0,		%rax\n"
-				"	setl	%al\n"
-			;
+			instr = unsignedCompare
+				? "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	setb	%al\n"
+				: "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	setl	%al\n";
 			break;
 		case A_GreaterThan:
-			instr =
-				"	cmp		%rcx,	%rax\n"
-				"	movq	$0,		%rax\n"
-				"	setg	%al\n"
-			;
+			instr = unsignedCompare
+				? "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	seta	%al\n"
+				: "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	setg	%al\n";
 			break;
 		case A_LessOrEqual:
-			instr =
-				"	cmp		%rcx,	%rax\n"
-				"	movq	$0,		%rax\n"
-				"	setle	%al\n"
-			;
+			instr = unsignedCompare
+				? "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	setbe	%al\n"
+				: "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	setle	%al\n";
 			break;
 		case A_GreaterOrEqual:
-			instr =
-				"	cmp		%rcx,	%rax\n"
-				"	movq	$0,		%rax\n"
-				"	setge	%al\n"
-			;
+			instr = unsignedCompare
+				? "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	setae	%al\n"
+				: "	cmp		%rcx,	%rax\n""	movq	$0,		%rax\n""	setge	%al\n";
 			break;
 	}
+	if(IsFloating(node->lhs->type))
+		instr = GenFloatingBinary(node);
 	unresolvedPushes++;
 	const char* lhs = GenExpressionAsm(node->lhs);
 	unresolvedPushes--;
@@ -403,14 +1092,147 @@ static const char* GenRTLBinary(ASTNode* node){
 	return sngenf(charCount, "%s%s%s%s%s", rhs, pushInstr, lhs, popInstr, instr);
 }
 
+#define SET_LINEAR_MAX	3	// Most constants of a set compared one at a time
+#define SET_VECTOR_MAX	16	// Most constants of a set compared at once in SSE registers
+
+static bool FitsImmediate(long long value){
+	return value >= -2147483647 - 1 && value <= 2147483647;
+}
+
+/// @brief Generate a test of whether %rax holds any of a run of constant operands of =||.
+/// Small sets are compared one at a time, sets spanning fewer than 64 values are tested as a bitmask,
+/// sets of up to 16 values are compared branchlessly two at a time, and larger sets are binary searched.
+/// @return Instructions which jump to the local label pref1 forward if no constant matches, and otherwise either fall through or jump to pref2 forward.
+static char* GenConstantSetTest(ASTNodeList* list, int start, int end, int pref){
+	long long* values = malloc((end - start) * sizeof(long long));
+	int count = 0;
+	// Sorted and without duplicates, as the order of constants can't be observed
+	for(int i = start; i < end; i++){
+		long long value = list->nodes[i]->value.intVal;
+		int pos = count;
+		while(pos > 0 && values[pos - 1] > value)
+			pos--;
+		if(pos > 0 && values[pos - 1] == value)
+			continue;
+		for(int j = count; j > pos; j--)
+			values[j] = values[j - 1];
+		values[pos] = value;
+		count++;
+	}
+	char* str = calloc(1, sizeof(char));
+	char* buffer = NULL;
+	const char* format = NULL;
+	unsigned long long span = (unsigned long long)values[count - 1] - (unsigned long long)values[0];
+	if(count <= SET_LINEAR_MAX){
+		for(int i = 0; i < count; i++){
+			bool last = i == count - 1;
+			if(FitsImmediate(values[i]))
+				format = last ? "	cmpq	$%lld,	%%rax\n	jne		%d1f\n" : "	cmpq	$%lld,	%%rax\n	je		%d2f\n";
+			else
+				format = last
+					? "	movabsq	$%lld,	%%rcx\n	cmpq	%%rcx,	%%rax\n	jne		%d1f\n"
+					: "	movabsq	$%lld,	%%rcx\n	cmpq	%%rcx,	%%rax\n	je		%d2f\n";
+			buffer = sngenf(strlen(format) + intlen(values[i]) + intlen(pref) + 1, format, values[i], pref);
+			strapp(&str, buffer);
+			free(buffer);
+		}
+	}
+	else if(span < 64){
+		// Values below the least constant wrap around to large unsigned offsets, failing the range check as well
+		long long mask = 0;
+		for(int i = 0; i < count; i++)
+			mask |= (long long)1 << (values[i] - values[0]);
+		format =
+			"	movq	%%rax,	%%rcx\n"
+			"	movabsq	$%lld,	%%rdx\n"
+			"	subq	%%rdx,	%%rcx\n"
+			"	cmpq	$%d,	%%rcx\n"
+			"	ja		%d1f\n"
+			"	movabsq	$%lld,	%%rdx\n"
+			"	btq		%%rcx,	%%rdx\n"
+			"	jnc		%d1f\n"
+		;
+		int range = span;
+		free(str);
+		str = sngenf(strlen(format) + intlen(values[0]) + intlen(range) + (2 * intlen(pref)) + intlen(mask) + 1, format, values[0], range, pref, mask, pref);
+	}
+	else{
+		// The constants are placed in read-only data, padded to whole SSE registers
+		int label = lVar++;
+		int padded = count <= SET_VECTOR_MAX ? count + count % 2 : count;
+		buffer = sngenf(15 + intlen(label), "	.align	16\nL%d:\n", label);
+		strapp(&rodata_section, buffer);
+		free(buffer);
+		for(int i = 0; i < padded; i++){
+			buffer = sngenf(10 + intlen(values[i < count ? i : 0]), "	.quad	%lld\n", values[i < count ? i : 0]);
+			strapp(&rodata_section, buffer);
+			free(buffer);
+		}
+		if(count <= SET_VECTOR_MAX){
+			// pcmpeqq isn't baseline, so quadwords are equal where both of their doublewords are
+			free(str);
+			str = _strdup(
+				"	movq	%rax,	%xmm0\n"
+				"	punpcklqdq	%xmm0,	%xmm0\n"
+				"	pxor	%xmm3,	%xmm3\n"
+			);
+			format =
+				"	movdqa	%%xmm0,	%%xmm1\n"
+				"	pcmpeqd	L%d+%d(%%rip),	%%xmm1\n"
+				"	pshufd	$0xB1,	%%xmm1,	%%xmm2\n"
+				"	pand	%%xmm2,	%%xmm1\n"
+				"	por		%%xmm1,	%%xmm3\n"
+			;
+			for(int i = 0; i < padded; i += 2){
+				buffer = sngenf(strlen(format) + intlen(label) + intlen(i * 8) + 1, format, label, i * 8);
+				strapp(&str, buffer);
+				free(buffer);
+			}
+			format =
+				"	pmovmskb	%%xmm3,	%%eax\n"
+				"	testl	%%eax,	%%eax\n"
+				"	je		%d1f\n"
+			;
+			buffer = sngenf(strlen(format) + intlen(pref) + 1, format, pref);
+		}
+		else{
+			format =
+				"	leaq	L%d(%%rip),	%%rdx\n"
+				"	xorl	%%ecx,	%%ecx\n"
+				"	movl	$%d,	%%r8d\n"
+				"%d3:\n"
+				"	cmpq	%%r8,	%%rcx\n"
+				"	jae		%d1f\n"
+				"	leaq	(%%rcx,%%r8),	%%r9\n"
+				"	shrq	$1,		%%r9\n"
+				"	cmpq	(%%rdx,%%r9,8),	%%rax\n"
+				"	je		%d2f\n"
+				"	jl		%d4f\n"
+				"	leaq	1(%%r9),	%%rcx\n"
+				"	jmp		%d3b\n"
+				"%d4:\n"
+				"	movq	%%r9,	%%r8\n"
+				"	jmp		%d3b\n"
+			;
+			buffer = sngenf(strlen(format) + intlen(label) + intlen(count) + (7 * intlen(pref)) + 1, format, label, count, pref, pref, pref, pref, pref, pref, pref);
+		}
+		strapp(&str, buffer);
+		free(buffer);
+	}
+	free(values);
+	return str;
+}
+
+/// @brief Generate =||, comparing the lhs to each operand until one is equal.
+/// Runs of constant operands are tested together, as they have no side effects to short-circuit.
 static char* GenRepeatingShortCircuitingOr(ASTNode* node){
 	if(node->lhs == NULL)					FatalM("Got NULL as lhs of node! (Internal @ gen.h)", __LINE__);
 	if(node->rhs == NULL)					FatalM("Got NULL as rhs of node! (Internal @ gen.h)", __LINE__);
 	if(node->rhs->op != A_ExpressionList)	FatalM("Expected rhs of node to be A_ExpressionList! (Internal @ gen.h)", __LINE__);
-	unresolvedPushes++;
 	int endLabel = lVar++;
 	char* Asm = _strdup(GenExpressionAsm(node->lhs));
 	strapp(&Asm, "	pushq	%rax\n");
+	unresolvedPushes++;
 	ASTNodeList* list = node->rhs->list;
 	int count = list->count;
 	int localLabelPref = ++labelPref;
@@ -422,17 +1244,37 @@ static char* GenRepeatingShortCircuitingOr(ASTNode* node){
 		"	jmp		L%d\n"				// End
 	;
 	char* shortCircuit = sngenf(strlen(scFormat) + intlen(localLabelPref) + intlen(endLabel) + 1, scFormat, localLabelPref, endLabel);
-	for(int i = 0; i < count; i++){
+	const char* setFormat =
+		"%d2:\n"
+		"	movq	$1,		%%rax\n"
+		"	jmp		L%d\n"				// End
+	;
+	char* setMatch = sngenf(strlen(setFormat) + intlen(localLabelPref) + intlen(endLabel) + 1, setFormat, localLabelPref, endLabel);
+	int i = 0;
+	while(i < count){
 		strapp(&Asm, caseStart);
-		strapp(&Asm, GenExpressionAsm(list->nodes[i]));
-		strapp(&Asm, shortCircuit);
+		if(list->nodes[i]->op != A_LitInt){
+			strapp(&Asm, GenExpressionAsm(list->nodes[i]));
+			strapp(&Asm, shortCircuit);
+			i++;
+			continue;
+		}
+		int run = i;
+		while(run < count && list->nodes[run]->op == A_LitInt)
+			run++;
+		strapp(&Asm, "	movq	(%rsp),	%rax\n");
+		char* test = GenConstantSetTest(list, i, run, localLabelPref);
+		strapp(&Asm, test);
+		strapp(&Asm, setMatch);
+		free(test);
+		i = run;
 	}
 	strapp(&Asm, caseStart);
 	strapp(&Asm, "	movq	$0,		%rax\n");
 	char* buffer = sngenf(intlen(endLabel) + 4, "L%d:\n", endLabel);
 	strapp(&Asm, buffer);
 	free(buffer);
-	strapp(&Asm, "	subq	$8,		%rsp\n"); // Remove pushed item
+	strapp(&Asm, "	addq	$8,		%rsp\n"); // Remove pushed item
 	unresolvedPushes--;
 	return Asm;
 }
@@ -519,22 +1361,25 @@ static const char* GenTernary(ASTNode* node){
 static const char* GenAssignment(ASTNode* node){
 	if(node == NULL)				FatalM("Expected an AST node, got NULL instead! (In gen.h)", __LINE__);
 	if(node->op != A_Assign)		FatalM("Expected assignment in expression! (In gen.h)", __LINE__);
-	if (node->lhs->op == A_VarRef) {
-		const char* id = node->lhs->value.strVal;
+	bool composite = IsMemoryComposite(node->lhs->type, node->lhs->cType);
+	int size = GetTypeSize(node->lhs->type, node->lhs->cType);
+	char* operand = NULL;
+	if(node->lhs->op == A_VarRef){
+		SymEntry* var = node->lhs->symbol;
+		if(var == NULL)					FatalM("Variable not defined!", Line);
+		operand = GenOperand(&var->location, 0);
+	}
+	else if(node->lhs->op == A_Dereference)
+		operand = GenDirectOperand(node->lhs->lhs);
+	else								FatalM("Unsupported assignment target! (In gen.h)", __LINE__);
+	if(operand != NULL){
 		const char* rhs = GenExpressionAsm(node->rhs);
-		SymEntry* var = FindVar(id, scope);
-		if (var == NULL)				FatalM("Variable not defined!", Line);
-		const char* offset = var->value.strVal;
-		const char* format = NULL;
-		switch(GetPrimSize(var->type)){
-			case 1:		format = "%s	movb	%%al,	%s\n";	break;
-			case 4:		format = "%s	movl	%%eax,	%s\n";	break;
-			case 8:		format = "%s	movq	%%rax,	%s\n";	break;
-			default:	FatalM("Non-standard sizes not yet supported in assignments! (Internal @ gen.h)", __LINE__);
-		}
-		return sngenf(strlen(format) + strlen(rhs) + strlen(offset) + 1, format, rhs, offset);
+		char* store = composite ? GenCopyTo(operand, size) : GenStore(operand, size);
+		char* str = strjoin(rhs, store);
+		free(store);
+		free(operand);
+		return str;
 	}
-	if(node->lhs->op != A_Dereference)	FatalM("Unsupported assignment target! (In gen.h)", __LINE__);
 	const char* derefASM = GenExpressionAsm(node->lhs->lhs);
 	const char* format = 
 		"%s" // lhs
@@ -543,17 +1388,20 @@ static const char* GenAssignment(ASTNode* node){
 		"	pop		%%rcx\n"
 		"%s" // instr
 	;
-	const char* instr = NULL;
-	switch(GetTypeSize(node->lhs->type, node->lhs->cType)){
-		case 1:		instr = "	movb	%al,	(%rcx)\n";	break;
-		case 4:		instr = "	movl	%eax,	(%rcx)\n";	break;
-		case 8:		instr = "	movq	%rax,	(%rcx)\n";	break;
-		default:	FatalM("Non-standard sizes not yet supported in assignments! (Internal @ gen.h)", __LINE__);
+	char* instr = NULL;
+	if(composite){
+		char* copy = GenCompositeCopy(size);
+		instr = strjoin(copy, "	movq	%rcx,	%rax\n");
+		free(copy);
 	}
+	else
+		instr = GenStore("(%rcx)", size);
 	unresolvedPushes++;
 	const char* innerASM = GenExpressionAsm(node->rhs);
 	unresolvedPushes--;
-	return sngenf(strlen(format) + strlen(derefASM) + strlen(innerASM) + strlen(instr) + 1, format, derefASM, innerASM, instr);
+	char* str = sngenf(strlen(format) + strlen(derefASM) + strlen(innerASM) + strlen(instr) + 1, format, derefASM, innerASM, instr);
+	free(instr);
+	return str;
 }
 
 static const char* GenIncDec(ASTNode* node){
@@ -572,83 +1420,69 @@ static const char* GenIncDec(ASTNode* node){
 		strapp(&val, "	pop		%rax\n");
 		return val;
 	}
+	const char* preface = "";
+	char* operand = NULL;
 	switch(node->lhs->op){
 		case A_VarRef:{
-			const char* move = NULL;
-			const char* action =  NULL;
-			switch(GetTypeSize(node->lhs->type, node->lhs->cType)){
-				case 1:
-					move = "	movb	%s,	%%al\n";
-					action = (node->op == A_Increment) ? "	incb	%s\n" : "	decb	%s\n";	break;
-					break;
-				case 2:
-					move = "	movw	%s,	%%ax\n";
-					action = (node->op == A_Increment) ? "	incw	%s\n" : "	decw	%s\n";	break;
-					break;
-				case 4:
-					move = "	movl	%s,	%%eax\n";
-					action = (node->op == A_Increment) ? "	incl	%s\n" : "	decl	%s\n";	break;
-					break;
-				case 8:
-					move = "	movq	%s,	%%rax\n";
-					action = (node->op == A_Increment) ? "	incq	%s\n" : "	decq	%s\n";	break;
-					break;
-				default:	FatalM("Unhandled type size! (Internal @ gen.h)", __LINE__);
-			}
-			char* format = (node->value.intVal) ? strjoin(action, move) : strjoin(move, action);
-			const char* id = node->lhs->value.strVal;
-			SymEntry* var = FindVar(id, scope);
+			SymEntry* var = node->lhs->symbol;
 			if(var == NULL)	FatalM("Variable not defined!", Line);
-			const char* location = var->value.strVal;
-			return sngenf(strlen(format) + (2 * strlen(location)) + 1, format, location, location);
+			operand = GenOperand(&var->location, 0);
+			break;
 		}
 		case A_Dereference:{
 			ASTNode* innerNode = node->lhs->lhs;
 			if(innerNode == NULL)	FatalM("Expected inner node, got NULL instead! (Internal @ gen.h)", __LINE__);
-			const char* format = 
-				"%s"	// ASM of dereference's lhs
-				"	movq	%%rax,	%%rcx\n"	// clear %rax for return
-				"%s"	// mov		OR inc/dec
-				"%s"	// inc/dec	OR mov
-			;
-			const char* move = NULL;
-			const char* action = NULL;
-			switch(GetTypeSize(innerNode->type, innerNode->cType)){
-				case 1:
-					move	= "	movb	(%rcx),	%al\n";
-					action	= (node->op == A_Increment) ? "	incb	(%rcx)\n" : "	decb	(%rcx)\n";
-					break;
-				case 2:
-					move	= "	movw	(%rcx),	%ax\n";
-					action	= (node->op == A_Increment) ? "	incw	(%rcx)\n" : "	decw	(%rcx)\n";
-					break;
-				case 4:
-					move	= "	movl	(%rcx),	%eax\n";
-					action	= (node->op == A_Increment) ? "	incl	(%rcx)\n" : "	decl	(%rcx)\n";
-					break;
-				case 8:
-					move	= "	movq	(%rcx),	%rax\n";
-					action	= (node->op == A_Increment) ? "	incq	(%rcx)\n" : "	decq	(%rcx)\n";
-					break;
-				default:	FatalM("Unhandled type size! (Internal @ gen.h)", __LINE__);
-			}
-			const char* inner = GenExpressionAsm(innerNode);
-			int charCount = strlen(action) + strlen(move) + strlen(format) + strlen(inner) + 1;
-			return (node->value.intVal)
-				? sngenf(charCount, format, inner, action, move)
-				: sngenf(charCount, format, inner, move, action);
+			operand = GenDirectOperand(innerNode);
+			if(operand != NULL)
+				break;
+			// The address is kept in %rcx, clearing %rax for the result
+			preface = strjoin(GenExpressionAsm(innerNode), "	movq	%rax,	%rcx\n");
+			operand = _strdup("(%rcx)");
+			break;
 		}
 		default:
 			FatalM("Unsupported lvalue in increment / decrement!", Line);
 	}
+	const char* move = NULL;
+	const char* action =  NULL;
+	// The width is that of the object incremented, not of a pointer to it
+	switch(GetTypeSize(node->lhs->type, node->lhs->cType)){
+		case 1:
+			move = "	movb	%s,	%%al\n";
+			action = (node->op == A_Increment) ? "	incb	%s\n" : "	decb	%s\n";
+			break;
+		case 2:
+			move = "	movw	%s,	%%ax\n";
+			action = (node->op == A_Increment) ? "	incw	%s\n" : "	decw	%s\n";
+			break;
+		case 4:
+			move = "	movl	%s,	%%eax\n";
+			action = (node->op == A_Increment) ? "	incl	%s\n" : "	decl	%s\n";
+			break;
+		case 8:
+			move = "	movq	%s,	%%rax\n";
+			action = (node->op == A_Increment) ? "	incq	%s\n" : "	decq	%s\n";
+			break;
+		default:	FatalM("Unhandled type size! (Internal @ gen.h)", __LINE__);
+	}
+	char* format = (node->value.intVal) ? strjoin(action, move) : strjoin(move, action);
+	char* str = sngenf(strlen(format) + (2 * strlen(operand)) + 1, format, operand, operand);
+	free(format);
+	free(operand);
+	char* ret = strjoin(preface, str);
+	free(str);
+	return ret;
 }
 
 static const char* GenCompoundAssignment(ASTNode* node){
 	if(node == NULL)	FatalM("Expected an AST node, got NULL instead! (In gen.h)", __LINE__);
-	const char* offset = NULL;
+	char* offset = NULL;
 	const char* preface = GenExpressionAsm(node->rhs);
 	switch(node->lhs->op){
 		case A_Dereference:{
+			offset = GenDirectOperand(node->lhs->lhs);
+			if(offset != NULL)
+				break;
 			char* buffer = _strdup(GenExpressionAsm(node->lhs->lhs));
 			strapp(&buffer, "	push	%rax\n"); // Deref's addr => stack
 			unresolvedPushes++;
@@ -656,19 +1490,41 @@ static const char* GenCompoundAssignment(ASTNode* node){
 			unresolvedPushes--;
 			strapp(&buffer, "	pop		%r8\n"); // Load deref's addr => r8
 			preface = buffer;
-			offset = "(%r8)";
+			offset = _strdup("(%r8)");
 			break;
 		}
 		case A_VarRef:{
-			const char* id = node->lhs->value.strVal;
-			
-			SymEntry* var = FindVar(id, scope);
+			SymEntry* var = node->lhs->symbol;
 			if(var == NULL)		FatalM("Variable not defined!", Line);
-			offset = var->value.strVal;
+			offset = GenOperand(&var->location, 0);
 			break;
 		}
 		default:			FatalM("Unsupported lvalue in compound assignment! (Internal @ gen.h)", __LINE__);
 	}
+	if(IsFloating(node->lhs->type)){
+		const char* op = NULL;
+		switch(node->op){
+			case A_AssignSum:			op = "add";	break;
+			case A_AssignDifference:	op = "sub";	break;
+			case A_AssignProduct:		op = "mul";	break;
+			case A_AssignQuotient:		op = "div";	break;
+			default:					FatalM("Floating operands are not valid for this operator!", Line);
+		}
+		char suffix = SSESuffix(node->lhs->type);
+		const char* format =
+			"%s"							// preface
+			"	movq	%%rax,	%%xmm1\n"
+			"	movs%c	%s,	%%xmm0\n"		// suffix, offset
+			"	%ss%c	%%xmm1,	%%xmm0\n"	// op, suffix
+			"	movs%c	%%xmm0,	%s\n"		// suffix, offset
+			"%s"							// Result => rax
+		;
+		const char* move = MoveFromSSE(node->lhs->type);
+		int charCount = strlen(format) + strlen(preface) + (2 * strlen(offset)) + strlen(op) + strlen(move) + 1;
+		char* str = sngenf(charCount, format, preface, suffix, offset, op, suffix, suffix, offset, move);
+		free(offset);
+		return str;
+	}
 	// val, op, mov -> offset
 	char* format = NULL;
 	const char* fb_format = NULL;
@@ -803,6 +1659,7 @@ static const char* GenCompoundAssignment(ASTNode* node){
 	int charCount = strlen(format) + strlen(preface) + (2 * strlen(offset)) + 1;
 	char* str = sngenf(charCount, format, preface, offset, offset);
 	free(format);
+	free(offset);
 	return str;
 }
 
@@ -810,6 +1667,7 @@ static const char* GenExpressionAsm(ASTNode* node){
 	if(node == NULL)					FatalM("Expected an AST node, got NULL instead! (In gen.h)", __LINE__);
 	switch(node->op){
 		case A_LitInt:				return GenLitInt(node);
+		case A_LitFloat:			return GenLitFloat(node);
 		case A_LitStr:				return GenLitStr(node);
 		case A_VarRef:				return GenVarRef(node);
 		case A_Ternary:				return GenTernary(node);
@@ -821,6 +1679,14 @@ static const char* GenExpressionAsm(ASTNode* node){
 		case A_Cast:				return GenCast(node);
 		case A_ExpressionList:		return GenExpressionList(node);
 		case A_RepeatLogicalOr:		return GenRepeatingShortCircuitingOr(node);
+		case A_Inline:				return GenInline(node);
+		case A_LabelAddress:{
+			char* label = LabelSymbol(node->value.strVal);
+			const char* format = "	leaq	%s(%%rip),	%%rax\n";
+			char* str = sngenf(strlen(format) + strlen(label) + 1, format, label);
+			free(label);
+			return str;
+		}
 		// Compound Assignment
 		case A_AssignSum:
 		case A_AssignDifference:
@@ -871,12 +1737,34 @@ static const char* GenExpressionAsm(ASTNode* node){
 static const char* GenReturnStatementAsm(ASTNode* node){
 	if(node == NULL)			FatalM("Expected an AST node, got NULL instead.", Line);
 	if(node->op != A_Return)	FatalM("Expected Return Statement in function!", Line);
+	if(labels.lreturn >= 0){
+		const char* innerAsm = node->lhs == NULL ? "	movq	$0,		%rax\n" : GenExpressionAsm(node->lhs);
+		const char* format =
+			"%s"
+			"	jmp		L%d\n"
+		;
+		return sngenf(strlen(innerAsm) + strlen(format) + intlen(labels.lreturn) + 1, format, innerAsm, labels.lreturn);
+	}
 	if(node->lhs == NULL)
 		return
 			"	movq	$0,		%eax\n"
 			"	jmp		7f\n"
 		;
 	const char* innerAsm = GenExpressionAsm(node->lhs);
+	if(resultAddress != NULL){
+		// The result is copied to the caller's object, the address of which is also returned
+		char* copy = GenCompositeCopy(GetTypeSize(node->lhs->type, node->lhs->cType));
+		const char* format =
+			"%s"
+			"	movq	%s,	%%rcx\n"
+			"%s"
+			"	movq	%%rcx,	%%rax\n"
+			"	jmp		7f\n"
+		;
+		char* str = sngenf(strlen(innerAsm) + strlen(format) + strlen(resultAddress) + strlen(copy) + 1, format, innerAsm, resultAddress, copy);
+		free(copy);
+		return str;
+	}
 	const char* format =
 		"%s"
 		"	jmp		7f\n"
@@ -884,9 +1772,88 @@ static const char* GenReturnStatementAsm(ASTNode* node){
 	return sngenf(strlen(innerAsm) + strlen(format) + 1, format, innerAsm);
 }
 
+/// @brief Generate an inlined call. The result is left in rax, as if the function had been called.
+/// Returns jump to the end of the body, possibly out of nested blocks, so the stack pointer is saved on entry and restored there.
+static const char* GenInline(ASTNode* node){
+	int lreturn = labels.lreturn;
+	labels.lreturn = lVar++;
+	EnterScope();
+	int n = stackIndex[scope] -= 8;
+	char* frame = sngenf(7 + intlen(n), "%d(%%rbp)", n);
+	const char* body = GenBlockAsm(node->lhs);
+	ExitScope();
+	const char* format =
+		"	subq	$16,	%%rsp\n"
+		"	movq	%%rsp,	%s\n"
+		"%s"
+		"L%d:\n"
+		"	movq	%s,	%%rsp\n"
+		"	addq	$16,	%%rsp\n"
+	;
+	char* str = sngenf(strlen(format) + (2 * strlen(frame)) + strlen(body) + intlen(labels.lreturn) + 1, format, frame, body, labels.lreturn, frame);
+	free(frame);
+	labels.lreturn = lreturn;
+	return str;
+}
+
+/// @brief Determine whether a condition is given an expected value by the expect built-in function.
+/// @return 1 if the condition is expected to hold, 0 if it isn't, or -1 if nothing is expected of it.
+static int ExpectedCondition(ASTNode* node){
+	bool negated = false;
+	while(node->op == A_LogicalNot){
+		negated = !negated;
+		node = node->lhs;
+	}
+	if(node->op != A_BuiltinCall || !streq(node->value.strVal, "__SCC_BUILTIN__expect"))
+		return -1;
+	long long value = 0;
+	if(!EvaluateConstant(((ASTNodeList*)node->secondaryValue.ptrVal)->nodes[1], &value))
+		return -1;
+	return (value != 0) != negated;
+}
+
+/// @brief Generate an if statement with a branch which isn't expected to be taken.
+/// The branch is moved after the epilogue of the function, so the expected path falls through without a taken jump.
+/// Branches moved out of the branch must follow it, as it jumps forward to them.
+static const char* GenUnlikelyIf(ASTNode* node, bool expected){
+	ASTNode* cold = expected ? node->mid : node->rhs;
+	ASTNode* hot = expected ? node->rhs : node->mid;
+	char* outer = coldCode;
+	coldCode = calloc(1, sizeof(char));
+	const char* coldAsm = GenStatementAsm(cold);
+	char* nested = coldCode;
+	coldCode = outer;
+	const char* hotAsm = hot == NULL ? "" : GenStatementAsm(hot);
+	const char* lhs = GenExpressionAsm(node->lhs);
+	labelPref++;
+	const char* format =
+		"%s"
+		"	cmp		$0,		%%rax\n"
+		"	j%s		%d1f\n"
+		"%s"
+		"%d2:\n"
+	;
+	const char* jump = expected ? "e" : "ne";
+	char* str = sngenf(strlen(format) + strlen(lhs) + strlen(jump) + strlen(hotAsm) + (2 * intlen(labelPref)) + 1, format, lhs, jump, labelPref, hotAsm, labelPref);
+	format =
+		"%d1:\n"
+		"%s"
+		"	jmp		%d2b\n"
+	;
+	char* buffer = sngenf(strlen(format) + strlen(coldAsm) + (2 * intlen(labelPref)) + 1, format, labelPref, coldAsm, labelPref);
+	strapp(&coldCode, buffer);
+	strapp(&coldCode, nested);
+	free(buffer);
+	free(nested);
+	return str;
+}
+
 static const char* GenIfStatement(ASTNode* node){
 	if(node->lhs == NULL)	FatalM("Expected condition in if statement!", Line);
 	if(node->rhs == NULL)	FatalM("Expected action in if statememt!", Line);
+	int expected = ExpectedCondition(node->lhs);
+	if(expected == 0 || (expected == 1 && node->mid != NULL))
+		return GenUnlikelyIf(node, expected);
 	const char* format;
 	if(node->mid == NULL){
 		format =
@@ -919,22 +1886,223 @@ static const char* GenIfStatement(ASTNode* node){
 		: sngenf(charCount, format, lhs, labelPref, rhs, labelPref);
 }
 
+/// @brief Resolve an address constant, as used by static initializers.
+/// @param offset Byte offset already accumulated from enclosing additions.
+/// @return The assembler expression of the address, or NULL if it is not an address constant.
+static char* GenStaticAddress(ASTNode* node, long long offset){
+	long long value = 0;
+	switch(node->op){
+		case A_LitInt:
+			return sngenf(intlen(node->value.intVal + offset) + 1, "%lld", node->value.intVal + offset);
+		case A_Cast:
+			return GenStaticAddress(node->lhs, offset);
+		case A_Add:
+			if(EvaluateConstant(node->rhs, &value))
+				return GenStaticAddress(node->lhs, offset + value);
+			if(EvaluateConstant(node->lhs, &value))
+				return GenStaticAddress(node->rhs, offset + value);
+			return NULL;
+		case A_Subtract:
+			if(EvaluateConstant(node->rhs, &value))
+				return GenStaticAddress(node->lhs, offset - value);
+			return NULL;
+		case A_LabelAddress: {
+			char* label = LabelSymbol(node->value.strVal);
+			if(!offset)
+				return label;
+			char* address = sngenf(strlen(label) + intlen(offset) + 2, "%s%+lld", label, offset);
+			free(label);
+			return address;
+		}
+		case A_LitStr: {
+			const char* format = offset ? "L%d%+lld" : "L%d";
+			int label = GenStringLiteral(node->value.strVal);
+			return sngenf(strlen(format) + intlen(label) + intlen(offset) + 1, format, label, offset);
+		}
+		case A_BuiltinCall: {
+			if(!streq(node->value.strVal, "__SCC_BUILTIN__embed"))
+				return NULL;
+			const char* format = offset ? "L%d%+lld" : "L%d";
+			int label = GenEmbed(node);
+			return sngenf(strlen(format) + intlen(label) + intlen(offset) + 1, format, label, offset);
+		}
+		case A_AddressOf:
+			if(node->lhs->op == A_Dereference)
+				return GenStaticAddress(node->lhs->lhs, offset);
+			if(node->lhs->op != A_VarRef)
+				return NULL;
+			break;
+		case A_VarRef:
+			break;
+		default:
+			return NULL;
+	}
+	// Only the address of a global, or a global array decaying to its first element, is constant
+	SymEntry* var = node->op == A_VarRef ? node->symbol : node->lhs->symbol;
+	if(var == NULL)												FatalM("Variable not defined!", Line);
+	if(node->op == A_VarRef && !var->length)
+		return NULL;
+	if(var->location.kind != L_Symbol)
+		return NULL;
+	offset += var->location.offset;
+	const char* format = offset ? "%s%+lld" : "%s";
+	return sngenf(strlen(format) + strlen(var->location.name) + intlen(offset) + 1, format, var->location.name, offset);
+}
+
+/// @brief Generate the static image of an initializer, zero filling anything not explicitly initialized.
+/// @param stores If not NULL, fields which are not constant are zeroed in the image, and the code storing them is appended here instead.
+/// @param varLoc Frame offset of the initialized variable, used when generating stores.
+static char* GenStaticImage(ASTNode* init, char** stores, int varLoc){
+	char* buffer = calloc(1, sizeof(char));
+	long long position = 0;
+	for(int i = 0; i < init->list->count; i++){
+		ASTNode* field = init->list->nodes[i];
+		long long offset = field->value.intVal;
+		int size = field->secondaryValue.intVal;
+		char* line = NULL;
+		if(offset > position){
+			line = sngenf(12 + intlen(offset - position), "	.zero	%lld\n", offset - position);
+			strapp(&buffer, line);
+			free(line);
+		}
+		position = offset + size;
+		if(field->lhs->op == A_BuiltinCall){
+			line = GenIncbin(field->lhs);
+			strapp(&buffer, line);
+			free(line);
+			long long padding = size - field->lhs->mid->value.intVal;
+			if(padding > 0){
+				line = sngenf(12 + intlen(padding), "	.zero	%lld\n", padding);
+				strapp(&buffer, line);
+				free(line);
+			}
+			continue;
+		}
+		// Character arrays hold the characters of a string, while pointers hold the address of one
+		if(field->lhs->op == A_LitStr && !IsPointer(field->type)){
+			const char* str = field->lhs->value.strVal;
+			const char* format = "	.ascii	\"%s\"\n";
+			line = sngenf(strlen(format) + strlen(str) + 1, format, str);
+			strapp(&buffer, line);
+			free(line);
+			long long padding = size - GetStringLength(str);
+			if(padding > 0){
+				line = sngenf(12 + intlen(padding), "	.zero	%lld\n", padding);
+				strapp(&buffer, line);
+				free(line);
+			}
+			continue;
+		}
+		if(field->lhs->op == A_LitFloat){
+			const char* directive = FloatDirective(field->lhs->type);
+			const char* format = "	.%s	%s\n";
+			line = sngenf(strlen(format) + strlen(directive) + strlen(field->lhs->value.strVal) + 1, format, directive, field->lhs->value.strVal);
+			strapp(&buffer, line);
+			free(line);
+			continue;
+		}
+		const char* format = NULL;
+		switch(size){
+			case 1:		format = "	.byte	%s\n";	break;
+			case 2:		format = "	.short	%s\n";	break;
+			case 4:		format = "	.long	%s\n";	break;
+			case 8:		format = "	.quad	%s\n";	break;
+			default:	FatalM("Unsupported type size! (Internal @ gen.h)", __LINE__);
+		}
+		char* value = field->lhs->op == A_LitInt || size == 8 ? GenStaticAddress(field->lhs, 0) : NULL;
+		if(value == NULL){
+			if(stores == NULL)									FatalM("Non-constant expression used in global variable initializer!", Line);
+			value = _strdup("0");
+			const char* storeFormat = "%s	movq	%%rax,	%lld(%%rbp)\n";
+			switch(size){
+				case 1:		storeFormat = "%s	movb	%%al,	%lld(%%rbp)\n";	break;
+				case 2:		storeFormat = "%s	movw	%%ax,	%lld(%%rbp)\n";	break;
+				case 4:		storeFormat = "%s	movl	%%eax,	%lld(%%rbp)\n";	break;
+				default:	break;
+			}
+			const char* expr = GenExpressionAsm(field->lhs);
+			line = sngenf(strlen(storeFormat) + strlen(expr) + intlen(varLoc + offset) + 1, storeFormat, expr, varLoc + offset);
+			strapp(stores, line);
+			free(line);
+		}
+		line = sngenf(strlen(format) + strlen(value) + 1, format, value);
+		strapp(&buffer, line);
+		free(line);
+		free(value);
+	}
+	if(init->value.intVal > position){
+		char* line = sngenf(12 + intlen(init->value.intVal - position), "	.zero	%lld\n", init->value.intVal - position);
+		strapp(&buffer, line);
+		free(line);
+	}
+	return buffer;
+}
+
+/// @brief Generate the declaration of a variable-length array, which is allocated on the stack as it's declared.
+/// The array is held by a pointer to its first element, with its size in bytes kept beside it for sizeof.
+static char* GenVariableLengthArray(ASTNode* node){
+	int size = stackIndex[scope] -= 8;
+	int n = stackIndex[scope] -= 8;
+	Location sizeLocation;
+	Location varLocation;
+	char* sizeLoc = GenOperand(InitLocation(&sizeLocation, L_Frame, NULL, size), 0);
+	char* varLoc = GenOperand(InitLocation(&varLocation, L_Frame, NULL, n), 0);
+	char* str = _strdup(GenExpressionAsm(node->mid));
+	const char* format = "	movq	%%rax,	%s\n";
+	char* buffer = sngenf(strlen(format) + strlen(sizeLoc) + 1, format, sizeLoc);
+	strapp(&str, buffer);
+	free(buffer);
+	char* allocation = GenStackAllocation();
+	strapp(&str, allocation);
+	free(allocation);
+	buffer = sngenf(strlen(format) + strlen(varLoc) + 1, format, varLoc);
+	strapp(&str, buffer);
+	free(buffer);
+	free(sizeLoc);
+	free(varLoc);
+	// From here on the array is a pointer to its first element, while its size is kept in the entry the parser made for it
+	SymEntry* var = node->symbol;
+	var->type = node->type + 1;
+	var->length = 0;
+	PlaceVar(var->value.ptrVal, &sizeLocation, scope);
+	PlaceVar(var, &varLocation, scope);
+	// Labels after the declaration expect the array to remain allocated
+	if(stackMark != NULL){
+		int mark = stackIndex[scope] -= 8;
+		ReserveLocalStack(scope, 8);
+		stackMark = sngenf(7 + intlen(mark), "%d(%%rbp)", mark);
+		const char* format = "	movq	%%rsp,	%s\n";
+		buffer = sngenf(strlen(format) + strlen(stackMark) + 1, format, stackMark);
+		strapp(&str, buffer);
+		free(buffer);
+	}
+	return str;
+}
+
 static char* GenDeclaration(ASTNode* node){
 	if(node == NULL)											FatalM("Expected an AST Node, got NULL instead", Line);
 	if(node->op != A_Declare)									FatalM("Expected declaration!", Line);
-	SymEntry* existing = FindLocalVar(node->value.strVal, scope);
-	if(existing != NULL && existing->sValue.intVal != C_Extern)	FatalM("Local variable redeclaration!", Line);
-	char* varLoc = malloc(10 * sizeof(char));
+	if(node->symbol == NULL)									FatalM("Declaration isn't bound to a variable! (Internal @ gen.h)", __LINE__);
+	if(IsVariableLengthArray(node))
+		return GenVariableLengthArray(node);
+	Location location;
+	char* varLoc = NULL;
 	char* expr = _strdup("");
-	if(!scope){
-		// Global variable
-		free(varLoc);
+	int length = node->mid != NULL ? node->mid->value.intVal : 0;
+	if(!scope || (node->sClass & C_Static)){
+		// Global variable, or static local, which is given a symbol unique to the translation unit
 		const char* id = node->value.strVal;
-		varLoc = _strdup(id);
-		strapp(&varLoc, "(%rip)");
-		InsertVar(node->value.strVal, varLoc, node->type, node->cType, (StorageClass)node->secondaryValue.intVal, scope);
+		if(scope){
+			const char* format = "%s.%s.%d";
+			id = sngenf(strlen(format) + strlen(curFuncName) + strlen(id) + intlen(staticLocals) + 1, format, curFuncName, id, staticLocals);
+			staticLocals++;
+		}
+		// Thread-local variables are located by their offset in the TLS section instead
+		InitLocation(&location, node->sClass & C_ThreadLocal ? L_ThreadLocal : L_Symbol, id, 0);
+		PlaceVar(node->symbol, &location, scope);
+		node->symbol->attributes = MergeAttributes(node->symbol->attributes, node->attributes);
 		for(DbLnkList* bss = bss_vars; bss != NULL; bss = bss->next){
-			if(!streq(bss->val, id))
+			if(bss->val != node->symbol)
 				continue;
 			bss->prev->next = bss->next;
 			bss->next->prev = bss->prev;
@@ -945,18 +2113,97 @@ static char* GenDeclaration(ASTNode* node){
 		// int a; extern int a;
 		// is treated the same as 
 		// extern int a;
-		if(node->sClass == C_Extern)
+		if(node->sClass & C_Extern)
 			return calloc(1, sizeof(char));
+		int alignment = GetExplicitAlignment(node->type, node->cType, node->attributes);
+		// There's no thread-local BSS, so uninitialized thread-local variables are zeroed in the TLS section
+		if((node->sClass & C_ThreadLocal) && node->lhs == NULL){
+			const char* format = node->sClass & C_Static
+				? "%s%s:\n	.zero	%d\n"
+				: "	.globl	%s\n%s%s:\n	.zero	%d\n";
+			char* directive = GenAlignDirective(alignment);
+			int size = GetSymbolSize(node->symbol);
+			int charCount = strlen(format) + (2 * strlen(id)) + strlen(directive) + intlen(size) + 1;
+			char* buffer = node->sClass & C_Static
+				? sngenf(charCount, format, directive, id, size)
+				: sngenf(charCount, format, id, directive, id, size);
+			strapp(&tls_section, buffer);
+			free(buffer);
+			free(directive);
+			return calloc(1, sizeof(char));
+		}
+		if(node->lhs == NULL && scope){
+			const char* format = "%s%s:\n	.zero	%d\n";
+			char* directive = GenAlignDirective(alignment);
+			int size = GetSymbolSize(node->symbol);
+			char* buffer = sngenf(strlen(format) + strlen(directive) + strlen(id) + intlen(size) + 1, format, directive, id, size);
+			strapp(&local_bss, buffer);
+			free(buffer);
+			free(directive);
+			return calloc(1, sizeof(char));
+		}
 		if(node->lhs == NULL){
-			DbLnkList* bss = MakeDbLnkList((void*)id, NULL, bss_vars);
+			DbLnkList* bss = MakeDbLnkList((void*)node->symbol, NULL, bss_vars);
 			bss_vars->prev = bss;
 			bss_vars = bss;
 			return calloc(1, sizeof(char));
 		}
-		if (node->lhs->op != A_LitInt)
-			FatalM("Non-constant expression used in global variable declaration!", Line);
+		// Const objects are placed in read-only data, so they can't be modified at runtime
+		char** section = node->qualifiers & Q_Const ? &rodata_section : &data_section;
+		if(node->sClass & C_ThreadLocal)
+			section = &tls_section;
+		if(node->lhs->op == A_Initializer){
+			char* image = GenStaticImage(node->lhs, NULL, 0);
+			const char* format = node->sClass & C_Static
+				? "	.align	%d\n%s:\n%s"
+				: "	.globl	%s\n	.align	%d\n%s:\n%s";
+			if(alignment < 8)
+				alignment = 8;
+			int charCount = strlen(format) + (2 * strlen(id)) + intlen(alignment) + strlen(image) + 1;
+			char* buffer = node->sClass & C_Static
+				? sngenf(charCount, format, alignment, id, image)
+				: sngenf(charCount, format, id, alignment, id, image);
+			strapp(section, buffer);
+			free(buffer);
+			free(image);
+			return calloc(1, sizeof(char));
+		}
+		char* directive = GenAlignDirective(alignment);
+		strapp(section, directive);
+		free(directive);
+		if(node->lhs->op == A_LitFloat){
+			const char* directive = FloatDirective(node->lhs->type);
+			const char* text = node->lhs->value.strVal;
+			const char* format = node->sClass & C_Static
+				? "%s:\n	.%s	%s\n"
+				: "	.globl %s\n%s:\n	.%s	%s\n";
+			int charCount = strlen(format) + (2 * strlen(id)) + strlen(directive) + strlen(text) + 1;
+			char* buffer = node->sClass & C_Static
+				? sngenf(charCount, format, id, directive, text)
+				: sngenf(charCount, format, id, id, directive, text);
+			strapp(section, buffer);
+			free(buffer);
+			return calloc(1, sizeof(char));
+		}
+		if(node->lhs->op != A_LitInt){
+			// Pointers may be initialized by an address constant
+			char* address = GenStaticAddress(node->lhs, 0);
+			if(address == NULL)
+				FatalM("Non-constant expression used in global variable declaration!", Line);
+			const char* format = node->sClass & C_Static
+				? "%s:\n	.quad	%s\n"
+				: "	.globl %s\n%s:\n	.quad	%s\n";
+			int charCount = strlen(format) + (2 * strlen(id)) + strlen(address) + 1;
+			char* buffer = node->sClass & C_Static
+				? sngenf(charCount, format, id, address)
+				: sngenf(charCount, format, id, id, address);
+			strapp(section, buffer);
+			free(buffer);
+			free(address);
+			return calloc(1, sizeof(char));
+		}
 		const char* format = NULL;
-		if(node->sClass == C_Static){
+		if(node->sClass & C_Static){
 			switch(GetTypeSize(node->type, node->cType)){
 				case 1:		format = "%s:\n	.byte	%lld\n"; break;
 				case 4:		format = "%s:\n	.long	%lld\n"; break;
@@ -965,7 +2212,7 @@ static char* GenDeclaration(ASTNode* node){
 			}
 			int charCount = strlen(format) + strlen(id) + intlen(node->lhs->value.intVal) + 1;
 			char* buffer = sngenf(charCount, format, id, node->lhs->value.intVal);
-			strapp(&data_section, buffer);
+			strapp(section, buffer);
 			free(buffer);
 			return calloc(1, sizeof(char));
 		}
@@ -977,20 +2224,71 @@ static char* GenDeclaration(ASTNode* node){
 		}
 		const int charCount = strlen(format) + (2 * strlen(id)) + intlen(node->lhs->value.intVal) + 1;
 		char* buffer = sngenf(charCount, format, id, id, node->lhs->value.intVal);
-		strapp(&data_section, buffer);
+		strapp(section, buffer);
 		free(buffer);
 		return calloc(1, sizeof(char));
 	}
 	{
-		int n = stackIndex[scope] -= GetTypeSize(node->type, node->cType);
-		free(varLoc);
-		varLoc = sngenf(7 + intlen(n), "%d(%%rbp)", n);
+		int size = GetTypeSize(node->type, node->cType);
+		int n = stackIndex[scope] -= length ? size * length : size;
+		// Offsets are relative to the frame pointer, which is only aligned to 16 bytes
+		int alignment = GetExplicitAlignment(node->type, node->cType, node->attributes);
+		if(alignment > 16)
+			alignment = 16;
+		if(alignment > 1 && n % alignment){
+			ReserveLocalStack(scope, alignment);
+			n = stackIndex[scope] = n & -alignment;
+		}
+		varLoc = GenOperand(InitLocation(&location, L_Frame, NULL, n), 0);
+		// The variable is in scope in its own initializer
+		PlaceVar(node->symbol, &location, scope);
 	}
-	if(node->lhs != NULL){
+	if(node->lhs != NULL && node->lhs->op == A_Initializer){
+		// Aggregates are copied from a read-only template, then any non-constant fields are stored individually
+		int n = stackIndex[scope];
+		char* stores = calloc(1, sizeof(char));
+		char* image = GenStaticImage(node->lhs, &stores, n);
+		const char* format =
+			"	.align	8\n"
+			"L%d:\n"
+			"%s"
+		;
+		char* buffer = sngenf(strlen(format) + intlen(lVar) + strlen(image) + 1, format, lVar, image);
+		strapp(&rodata_section, buffer);
+		free(buffer);
+		free(image);
+		long long size = node->lhs->value.intVal;
+		bool quadwords = size % 8 == 0;
+		format =
+			"	pushq	%%rsi\n"
+			"	pushq	%%rdi\n"
+			"	leaq	L%d(%%rip),	%%rsi\n"
+			"	leaq	%s,	%%rdi\n"
+			"	movq	$%lld,	%%rcx\n"
+			"	cld\n"
+			"	rep %s\n"
+			"	popq	%%rdi\n"
+			"	popq	%%rsi\n"
+			"%s"
+		;
+		free(expr);
+		expr = sngenf(strlen(format) + intlen(lVar) + strlen(varLoc) + intlen(size) + 6 + strlen(stores) + 1,
+			format, lVar, varLoc, quadwords ? size / 8 : size, quadwords ? "movsq" : "movsb", stores);
+		lVar++;
+		free(stores);
+	}
+	else if(node->lhs != NULL && IsMemoryComposite(node->type, node->cType)){
+		char* copy = GenCopyTo(varLoc, GetTypeSize(node->type, node->cType));
+		free(expr);
+		expr = strjoin(GenExpressionAsm(node->lhs), copy);
+		free(copy);
+	}
+	else if(node->lhs != NULL){
 		const char* rhs = GenExpressionAsm(node->lhs);
 		const char* format = "%s	movq	%%rax,	%s\n";
 		switch(GetTypeSize(node->type, node->cType)){
 			case 1:		format = "%s	movb	%%al,	%s\n";	break;
+			case 2:		format = "%s	movw	%%ax,	%s\n";	break;
 			case 4:		format = "%s	movl	%%eax,	%s\n";	break;
 			case 8:		break;
 			default:	break;
@@ -998,7 +2296,7 @@ static char* GenDeclaration(ASTNode* node){
 		free(expr);
 		expr = sngenf(strlen(format) + strlen(rhs) + strlen(varLoc) + 4, format, rhs, varLoc);
 	}
-	InsertVar(node->value.strVal, varLoc, node->type, node->cType, C_Default, scope);
+	free(varLoc);
 	return expr;
 }
 
@@ -1009,11 +2307,17 @@ static const char* GenWhileLoop(ASTNode* node){
 	int localLabelPref = labelPref++;
 	int lbreak =	labels.lbreak;
 	int lcontinue =	labels.lcontinue;
+	DbLnkList* breakSaves =		labels.breakSaves;
+	DbLnkList* continueSaves =	labels.continueSaves;
 	labels.lbreak		= (localLabelPref * 10) + 9;
 	labels.lcontinue	= (localLabelPref * 10) + 8;
+	labels.breakSaves		= stackSaves;
+	labels.continueSaves	= stackSaves;
 	const char* action		= GenStatementAsm(node->rhs);
 	labels.lbreak		= lbreak;
 	labels.lcontinue	= lcontinue;
+	labels.breakSaves		= breakSaves;
+	labels.continueSaves	= continueSaves;
 	char* buffer;
 	if(node->op == A_Do){
 		const char* format =
@@ -1050,6 +2354,8 @@ static const char* GenForLoop(ASTNode* node){
 	if(node == NULL)									FatalM("Expected an AST Node, got NULL instead", Line);
 	if(node->op != A_For)								FatalM("Expected for loop!", Line);
 	if(node->rhs == NULL)								FatalM("Expected a statement folowing for loop!", Line);
+	int outerStackSize = flatStackSize;
+	flatStackSize = 0;
 	EnterScope();
 	const char* initializer = NULL;
 	if(node->lhs->lhs == NULL)					initializer = "";
@@ -1059,12 +2365,18 @@ static const char* GenForLoop(ASTNode* node){
 	const char* modifier	= node->lhs->rhs == NULL ? "" : GenExpressionAsm(node->lhs->rhs);
 	int lbreak			= labels.lbreak;
 	int lcontinue		= labels.lcontinue;
+	DbLnkList* breakSaves		= labels.breakSaves;
+	DbLnkList* continueSaves	= labels.continueSaves;
 	int localLabelPref	= labelPref++;
 	labels.lbreak		= (localLabelPref * 10) + 9;
 	labels.lcontinue	= localLabelPref * 10 + 8;
+	labels.breakSaves		= stackSaves;
+	labels.continueSaves	= stackSaves;
 	const char* action	= GenStatementAsm(node->rhs);
 	labels.lbreak		= lbreak;
 	labels.lcontinue	= lcontinue;
+	labels.breakSaves		= breakSaves;
+	labels.continueSaves	= continueSaves;
 	const char* format =
 		"%s"				// Allocate Stack Space for vars
 		"%s"				// Initializer
@@ -1081,7 +2393,7 @@ static const char* GenForLoop(ASTNode* node){
 		"%s"				// Deallocate Stack Space for vars
 	;
 	// Beyond this point, don't generate any more ASM using other functions
-	int stackSize = align(GetLocalVarCount(scope) * 8, 16);
+	int stackSize = FlattenScopeStack(align(GetLocalVarCount(scope) * 8, 16), outerStackSize);
 	char* stackAlloc = malloc(1 * sizeof(char));
 	*stackAlloc = '\0';
 	char* stackDealloc = malloc(1 * sizeof(char));
@@ -1144,7 +2456,9 @@ static char* GenSwitch(ASTNode* node){
 
 	int localLabelPref = labelPref++;
 	int lbreak = labels.lbreak;
+	DbLnkList* breakSaves = labels.breakSaves;
 	labels.lbreak = (localLabelPref * 10) + 9;
+	labels.breakSaves = stackSaves;
 	const char* caseFrmt = "L%d:\n" "%s";
 	const char* jmpFrmt = "	.quad	%d,	L%d\n";
 	for(int i = 0; i < childCount; i++){
@@ -1166,6 +2480,7 @@ static char* GenSwitch(ASTNode* node){
 		free(jmpASM);
 	}
 	labels.lbreak = lbreak;
+	labels.breakSaves = breakSaves;
 	int tpCharCount = strlen(declLabelFormat) + intlen(lJmp) + intlen(caseCount) + 1;
 	char* tablePreASM = sngenf(tpCharCount, declLabelFormat, lJmp, caseCount);
 	strapp(&tablePreASM, tableASM);
@@ -1195,16 +2510,34 @@ static char* GenSwitch(ASTNode* node){
 	return ret;
 }
 
+/// @brief Generate the release of the variable-length arrays of the blocks entered since a point, when jumping out of them.
+/// @param outer The stack saves enclosing the target of the jump.
+static char* GenStackRestore(DbLnkList* outer){
+	if(stackSaves == outer)
+		return calloc(1, sizeof(char));
+	DbLnkList* save = stackSaves;
+	while(save->next != outer)
+		save = save->next;
+	const char* format = "	movq	%s,	%%rsp\n";
+	return sngenf(strlen(format) + strlen(save->val) + 1, format, save->val);
+}
+
 static const char* GenContinue(ASTNode* node){
 	if(labels.lcontinue == -1)	FatalM("A 'continue' statement may only be used inside of a loop!", Line);
-	const char* format = "	jmp		%df\n";
-	return sngenf(strlen(format) + intlen(labels.lcontinue) + 1, format, labels.lcontinue);
+	char* restore = GenStackRestore(labels.continueSaves);
+	const char* format = "%s	jmp		%df\n";
+	char* str = sngenf(strlen(format) + strlen(restore) + intlen(labels.lcontinue) + 1, format, restore, labels.lcontinue);
+	free(restore);
+	return str;
 }
 
 static char* GenBreak(ASTNode* node){
 	if(labels.lbreak == -1)		FatalM("A 'break' statement may only be used inside of a switch or loop!", Line);
-	const char* format = "	jmp		%df\n";
-	return sngenf(strlen(format) + intlen(labels.lbreak) + 1, format, labels.lbreak);
+	char* restore = GenStackRestore(labels.breakSaves);
+	const char* format = "%s	jmp		%df\n";
+	char* str = sngenf(strlen(format) + strlen(restore) + intlen(labels.lbreak) + 1, format, restore, labels.lbreak);
+	free(restore);
+	return str;
 }
 
 static const char* GenBlockAsm(ASTNode* node){
@@ -1212,9 +2545,40 @@ static const char* GenBlockAsm(ASTNode* node){
 	if(node->op != A_Block)			FatalM("Expected function at top level statement!", Line);
 	if(!node->list)					FatalM("Expected an ASTNodeList* member 'list'! (In gen.h)", __LINE__);
 	if(!node->list->count)			return "";
+	int outerStackSize = flatStackSize;
+	flatStackSize = 0;
 	EnterScope();
+	// Variable-length arrays declared by the block are released when it ends, unless alloca's allocations must outlive it
+	char* saveStack = NULL;
+	for(int i = 0; i < node->list->count && saveStack == NULL; i++)
+		if(IsVariableLengthArray(node->list->nodes[i]) && !ContainsDynamicAllocation(node, false)){
+			int n = stackIndex[scope] -= 8;
+			ReserveLocalStack(scope, 8);
+			saveStack = sngenf(7 + intlen(n), "%d(%%rbp)", n);
+		}
+	const char* outerMark = stackMark;
+	if(saveStack != NULL){
+		stackSaves = MakeDbLnkList(saveStack, NULL, stackSaves);
+		stackMark = saveStack;
+	}
+	// A block which can't release its arrays has no fixed stack pointer to return to
+	else if(ContainsDynamicAllocation(node, false))
+		stackMark = NULL;
 	const char* statementAsm = GenerateAsmFromList(node->list);
-	int stackSize = align(GetLocalStackSize(scope), 16);
+	stackMark = outerMark;
+	if(saveStack != NULL){
+		DbLnkList* save = stackSaves;
+		stackSaves = save->next;
+		free(save);
+		const char* format =
+			"	movq	%%rsp,	%s\n"
+			"%s"
+			"	movq	%s,	%%rsp\n"
+		;
+		statementAsm = sngenf(strlen(format) + (2 * strlen(saveStack)) + strlen(statementAsm) + 1, format, saveStack, statementAsm, saveStack);
+		free(saveStack);
+	}
+	int stackSize = FlattenScopeStack(align(GetLocalStackSize(scope), 16), outerStackSize);
 	char* stackAlloc = calloc(1, sizeof(char));
 	char* stackDealloc = calloc(1, sizeof(char));
 	if(stackSize){
@@ -1233,8 +2597,450 @@ static const char* GenBlockAsm(ASTNode* node){
 	return str;
 }
 
+#define ASM_REGISTERS	14	// %rax, %rbx, %rcx, %rdx, %rsi, %rdi, then %r8 through %r15
+
+enum eAsmOperandKind {
+	K_Register,
+	K_Memory,
+	K_Immediate,
+};
+
+/// @brief Get the name of a general purpose register, when accessed with a given size.
+static char* AsmRegisterName(int reg, int size){
+	if(reg >= 6){
+		const char* suffix = "";
+		switch(size){
+			case 1:		suffix = "b";	break;
+			case 2:		suffix = "w";	break;
+			case 4:		suffix = "d";	break;
+			default:	break;
+		}
+		return sngenf(6 + strlen(suffix), "%%r%d%s", reg + 2, suffix);
+	}
+	const char* base = NULL;
+	switch(reg){
+		case 0:		base = "a";		break;
+		case 1:		base = "b";		break;
+		case 2:		base = "c";		break;
+		case 3:		base = "d";		break;
+		case 4:		base = "si";	break;
+		default:	base = "di";	break;
+	}
+	const char* format = NULL;
+	switch(size){
+		case 1:		format = reg < 4 ? "%%%sl" : "%%%sl";	break;
+		case 2:		format = reg < 4 ? "%%%sx" : "%%%s";	break;
+		case 4:		format = reg < 4 ? "%%e%sx" : "%%e%s";	break;
+		default:	format = reg < 4 ? "%%r%sx" : "%%r%s";	break;
+	}
+	return sngenf(strlen(format) + strlen(base) + 1, format, base);
+}
+
+/// @brief Find the register named by a clobber, accepting any of its sizes.
+/// @return -1 if the clobber doesn't name a general purpose register.
+static int AsmRegisterOf(const char* name){
+	if(*name == '%')
+		name++;
+	for(int reg = 0; reg < ASM_REGISTERS; reg++)
+		for(int size = 1; size <= 8; size *= 2){
+			char* regName = AsmRegisterName(reg, size);
+			bool match = streq(regName + 1, name);
+			free(regName);
+			if(match)
+				return reg;
+		}
+	return -1;
+}
+
+/// @return The register a single-register constraint letter requires, or -1.
+static int AsmConstraintRegister(char letter){
+	switch(letter){
+		case 'a':	return 0;
+		case 'b':	return 1;
+		case 'c':	return 2;
+		case 'd':	return 3;
+		case 'S':	return 4;
+		case 'D':	return 5;
+		default:	return -1;
+	}
+}
+
+/// @brief Determine whether the caller of the function expects a register to be preserved.
+static bool IsCalleeSaved(int reg){
+	return reg == 1 || reg == 4 || reg == 5 || reg >= 10;
+}
+
+/// @brief Allocate a register for an asm operand, preferring those which needn't be preserved.
+static int AllocateAsmRegister(bool* used){
+	for(int pass = 0; pass < 2; pass++)
+		for(int reg = 0; reg < ASM_REGISTERS; reg++)
+			if(!used[reg] && IsCalleeSaved(reg) == pass){
+				used[reg] = true;
+				return reg;
+			}
+	FatalM("Not enough registers for the operands of asm statement!", Line);
+}
+
+static const char* MoveSuffix(int size){
+	switch(size){
+		case 1:		return "b";
+		case 2:		return "w";
+		case 4:		return "l";
+		default:	return "q";
+	}
+}
+
+/// @brief Replace the operand references and escape sequences of an asm template.
+/// Operands are referenced by '%N' or '%[name]', optionally preceded by a size modifier 'b', 'w', 'k' or 'q',
+/// or by 'c' to omit the '$' of an immediate. '%=' is replaced by a number unique to the asm statement.
+static char* SubstituteAsmTemplate(ASTNode* node, int* kinds, int* regs, char** locs, int unique){
+	ASTNodeList* operands = node->list;
+	const char* str = node->value.strVal;
+	char* buffer = _strdup("	");
+	char* chr = calloc(2, sizeof(char));
+	while(*str){
+		if(*str == '\\'){
+			str++;
+			switch(*str){
+				case 'n':	strapp(&buffer, "\n");	break;
+				case 't':	strapp(&buffer, "\t");	break;
+				case '\\':	strapp(&buffer, "\\");	break;
+				case '"':	strapp(&buffer, "\"");	break;
+				default:
+					strapp(&buffer, "\\");
+					chr[0] = *str;
+					strapp(&buffer, chr);
+					break;
+			}
+			str++;
+			continue;
+		}
+		if(*str != '%'){
+			chr[0] = *str++;
+			strapp(&buffer, chr);
+			continue;
+		}
+		str++;
+		if(*str == '%' || *str == '='){
+			char* text = *str == '%' ? _strdup("%") : sngenf(intlen(unique) + 1, "%d", unique);
+			strapp(&buffer, text);
+			free(text);
+			str++;
+			continue;
+		}
+		char modifier = 0;
+		if(*str == 'b' || *str == 'w' || *str == 'k' || *str == 'q' || *str == 'c')
+			modifier = *str++;
+		int index = -1;
+		if(*str == '['){
+			const char* end = strchr(str, ']');
+			if(end == NULL)		FatalM("Unterminated operand name in asm template!", Line);
+			for(int i = 0; i < operands->count; i++){
+				const char* name = operands->nodes[i]->secondaryValue.strVal;
+				if(name != NULL && strlen(name) == (size_t)(end - str - 1) && !strncmp(name, str + 1, end - str - 1))
+					index = i;
+			}
+			str = end + 1;
+		}
+		else if(isdigit(*str)){
+			index = 0;
+			while(isdigit(*str))
+				index = index * 10 + *str++ - '0';
+		}
+		if(index < 0 || index >= operands->count)	FatalM("Invalid operand reference in asm template!", Line);
+		char* text = NULL;
+		switch(kinds[index]){
+			case K_Register:{
+				int size = GetTypeSize(operands->nodes[index]->type, operands->nodes[index]->cType);
+				switch(modifier){
+					case 'b':	size = 1;	break;
+					case 'w':	size = 2;	break;
+					case 'k':	size = 4;	break;
+					case 'q':	size = 8;	break;
+					default:	break;
+				}
+				text = AsmRegisterName(regs[index], size);
+				break;
+			}
+			case K_Immediate:
+				text = _strdup(modifier == 'c' ? locs[index] + 1 : locs[index]);
+				break;
+			default:
+				text = _strdup(locs[index]);
+				break;
+		}
+		strapp(&buffer, text);
+		free(text);
+	}
+	free(chr);
+	strapp(&buffer, "\n");
+	return buffer;
+}
+
+/// @brief Generate a GNU-style asm statement.
+/// Operands are evaluated and pushed, then popped into the registers allocated for them, or addressed in place.
+/// Registers which the asm clobbers or is given, and which the caller expects to be preserved, are saved around it.
+static char* GenAsm(ASTNode* node){
+	ASTNodeList* operands = node->list;
+	ASTNodeList* clobbers = node->mid->list;
+	int outputs = node->secondaryValue.intVal;
+	int count = operands->count;
+	int* kinds = calloc(count + 1, sizeof(int));
+	int* regs = calloc(count + 1, sizeof(int));
+	int* slots = calloc(count + 1, sizeof(int));
+	char** locs = calloc(count + 1, sizeof(char*));
+	bool* used = calloc(ASM_REGISTERS, sizeof(bool));
+	for(int i = 0; i < clobbers->count; i++){
+		const char* clobber = clobbers->nodes[i]->value.strVal;
+		int reg = AsmRegisterOf(clobber);
+		if(reg >= 0)
+			used[reg] = true;
+		else if(!streq(clobber, "memory") && !streq(clobber, "cc"))
+			WarnM("Unknown asm clobber ignored!", Line);
+	}
+	// Operands fixed to a register are assigned first, so the others can avoid them
+	for(int i = 0; i < count; i++){
+		ASTNode* operand = operands->nodes[i];
+		const char* constraint = operand->value.strVal;
+		int fixed = -1;
+		bool reg = false;
+		bool mem = false;
+		bool imm = false;
+		int match = -1;
+		for(const char* c = constraint; *c; c++){
+			if(AsmConstraintRegister(*c) >= 0)
+				fixed = AsmConstraintRegister(*c);
+			else if(*c == 'r' || *c == 'q' || *c == 'g')
+				reg = true;
+			else if(*c == 'm' || *c == 'o')
+				mem = true;
+			else if(*c == 'i' || *c == 'n')
+				imm = true;
+			else if(isdigit(*c))
+				match = *c - '0';
+			else if(*c != '=' && *c != '+' && *c != '&' && *c != '%')
+				FatalM("Unsupported asm operand constraint!", Line);
+		}
+		regs[i] = -1;
+		if(match >= 0){
+			if(i < outputs || match >= outputs || kinds[match] != K_Register)	FatalM("Matching asm constraints must refer to a register output!", Line);
+			kinds[i] = K_Register;
+		}
+		else if(fixed >= 0){
+			if(used[fixed])		FatalM("Asm operand requires a register which is already in use!", Line);
+			used[fixed] = true;
+			kinds[i] = K_Register;
+			regs[i] = fixed;
+		}
+		else if(imm && operand->lhs->op == A_LitInt){
+			kinds[i] = K_Immediate;
+			locs[i] = sngenf(intlen(operand->lhs->value.intVal) + 2, "$%lld", operand->lhs->value.intVal);
+		}
+		else if(reg)
+			kinds[i] = K_Register;
+		else if(mem)
+			kinds[i] = K_Memory;
+		else
+			FatalM("Unsupported asm operand constraint!", Line);
+		if(kinds[i] == K_Register && ((operand->type & 0xF0) == P_Composite && !(operand->type & 0x0F)))
+			FatalM("Composite values can't be asm register operands!", Line);
+	}
+	for(int i = 0; i < count; i++){
+		ASTNode* operand = operands->nodes[i];
+		const char* constraint = operand->value.strVal;
+		if(kinds[i] == K_Register && regs[i] < 0){
+			int match = -1;
+			for(const char* c = constraint; *c; c++)
+				if(isdigit(*c))
+					match = *c - '0';
+			regs[i] = match >= 0 ? regs[match] : AllocateAsmRegister(used);
+		}
+		else if(kinds[i] == K_Memory){
+			if(operand->lhs->op == A_VarRef){
+				SymEntry* var = operand->lhs->symbol;
+				if(var == NULL)		FatalM("Variable not defined!", Line);
+				locs[i] = GenOperand(&var->location, 0);
+			}
+			else {
+				regs[i] = AllocateAsmRegister(used);
+				char* name = AsmRegisterName(regs[i], 8);
+				locs[i] = sngenf(strlen(name) + 3, "(%s)", name);
+				free(name);
+			}
+		}
+	}
+	char* buffer = calloc(1, sizeof(char));
+	char* restore = calloc(1, sizeof(char));
+	int saved = 0;
+	for(int reg = 0; reg < ASM_REGISTERS; reg++){
+		if(!used[reg] || !IsCalleeSaved(reg))
+			continue;
+		char* name = AsmRegisterName(reg, 8);
+		char* push = sngenf(strlen(name) + 9, "	pushq	%s\n", name);
+		char* pop = sngenf(strlen(name) + 8, "	popq	%s\n", name);
+		strapp(&buffer, push);
+		char* popped = strjoin(pop, restore);
+		free(restore);
+		restore = popped;
+		free(name);
+		free(push);
+		free(pop);
+		saved++;
+	}
+	unresolvedPushes += saved;
+	// The addresses of outputs which aren't variables are evaluated before anything is loaded into a register
+	for(int i = 0; i < outputs; i++){
+		ASTNode* lvalue = operands->nodes[i]->lhs;
+		if(kinds[i] == K_Immediate)			FatalM("Output operands of asm statements can't be immediates!", Line);
+		if(lvalue->op == A_VarRef)
+			continue;
+		if(lvalue->op != A_Dereference)		FatalM("Unsupported lvalue in asm output operand!", Line);
+		slots[i] = stackIndex[scope] -= 8;
+		ReserveLocalStack(scope, 8);
+		const char* address = GenExpressionAsm(lvalue->lhs);
+		const char* format = "%s	movq	%%rax,	%d(%%rbp)\n";
+		char* line = sngenf(strlen(format) + strlen(address) + intlen(slots[i]) + 1, format, address, slots[i]);
+		strapp(&buffer, line);
+		free(line);
+	}
+	// Inputs, and outputs which are also read, are pushed as they are evaluated, then popped into their registers
+	char* loads = calloc(1, sizeof(char));
+	int pushes = 0;
+	for(int i = 0; i < count; i++){
+		ASTNode* operand = operands->nodes[i];
+		const char* expr = NULL;
+		if(i >= outputs && kinds[i] == K_Register)
+			expr = GenExpressionAsm(operand->lhs);
+		else if(i >= outputs && kinds[i] == K_Memory && regs[i] >= 0){
+			if(operand->lhs->op != A_Dereference)	FatalM("Unsupported lvalue in asm memory operand!", Line);
+			expr = GenExpressionAsm(operand->lhs->lhs);
+		}
+		else if(i < outputs && kinds[i] == K_Register && operand->value.strVal[0] == '+' && !slots[i])
+			expr = GenExpressionAsm(operand->lhs);
+		char* name = regs[i] >= 0 ? AsmRegisterName(regs[i], 8) : NULL;
+		if(expr != NULL){
+			strapp(&buffer, expr);
+			strapp(&buffer, "	pushq	%rax\n");
+			unresolvedPushes++;
+			pushes++;
+			char* pop = sngenf(strlen(name) + 8, "	popq	%s\n", name);
+			char* popped = strjoin(pop, loads);
+			free(loads);
+			loads = popped;
+			free(pop);
+		}
+		else if(slots[i]){
+			// Outputs addressed through a pointer are loaded from the address evaluated earlier
+			const char* format = "	movq	%d(%%rbp),	%s\n";
+			char* line = sngenf(strlen(format) + intlen(slots[i]) + strlen(name) + 1, format, slots[i], name);
+			strapp(&loads, line);
+			free(line);
+			if(kinds[i] == K_Register && operand->value.strVal[0] == '+'){
+				int size = GetTypeSize(operand->type, operand->cType);
+				char* sized = AsmRegisterName(regs[i], size);
+				format = "	mov%s	(%s),	%s\n";
+				line = sngenf(strlen(format) + strlen(name) + strlen(sized) + 2, format, MoveSuffix(size), name, sized);
+				strapp(&loads, line);
+				free(line);
+				free(sized);
+			}
+		}
+		free(name);
+	}
+	unresolvedPushes -= pushes;
+	strapp(&buffer, loads);
+	free(loads);
+	char* text = SubstituteAsmTemplate(node, kinds, regs, locs, lVar++);
+	strapp(&buffer, text);
+	free(text);
+	// Register outputs are stored once the asm is done, using a register which no output occupies for their address
+	int scratch = -1;
+	for(int reg = 0; reg < ASM_REGISTERS && scratch < 0; reg++){
+		bool occupied = IsCalleeSaved(reg);
+		for(int i = 0; i < outputs; i++)
+			if(kinds[i] == K_Register && regs[i] == reg)
+				occupied = true;
+		if(!occupied)
+			scratch = reg;
+	}
+	for(int i = 0; i < outputs; i++){
+		if(kinds[i] != K_Register)
+			continue;
+		ASTNode* operand = operands->nodes[i];
+		int size = GetTypeSize(operand->type, operand->cType);
+		char* sized = AsmRegisterName(regs[i], size);
+		char* line = NULL;
+		if(!slots[i]){
+			SymEntry* var = operand->lhs->symbol;
+			if(var == NULL)		FatalM("Variable not defined!", Line);
+			if(var->length)		FatalM("Arrays can't be asm register operands!", Line);
+			const char* format = "	mov%s	%s,	%s\n";
+			char* operand = GenOperand(&var->location, 0);
+			line = sngenf(strlen(format) + strlen(sized) + strlen(operand) + 2, format, MoveSuffix(size), sized, operand);
+			free(operand);
+		}
+		else {
+			if(scratch < 0)		FatalM("No register is free to store the outputs of asm statement!", Line);
+			char* address = AsmRegisterName(scratch, 8);
+			const char* format =
+				"	movq	%d(%%rbp),	%s\n"
+				"	mov%s	%s,	(%s)\n"
+			;
+			line = sngenf(strlen(format) + intlen(slots[i]) + 2 * strlen(address) + strlen(sized) + 2, format, slots[i], address, MoveSuffix(size), sized, address);
+			free(address);
+		}
+		strapp(&buffer, line);
+		free(line);
+		free(sized);
+	}
+	strapp(&buffer, restore);
+	unresolvedPushes -= saved;
+	free(restore);
+	free(kinds);
+	free(regs);
+	free(slots);
+	free(used);
+	return buffer;
+}
+
+static char* GenLabel(ASTNode* node){
+	char* label = LabelSymbol(node->value.strVal);
+	// A jump from anywhere else in the function may arrive with arrays allocated that aren't in scope here
+	char* restore = calloc(1, sizeof(char));
+	if(stackMark != NULL){
+		free(restore);
+		const char* format = "	movq	%s,	%%rsp\n";
+		restore = sngenf(strlen(format) + strlen(stackMark) + 1, format, stackMark);
+	}
+	const char* stmt = node->lhs != NULL ? GenStatementAsm(node->lhs) : "";
+	const char* format = "%s:\n%s%s";
+	char* str = sngenf(strlen(format) + strlen(label) + strlen(restore) + strlen(stmt) + 1, format, label, restore, stmt);
+	free(label);
+	free(restore);
+	return str;
+}
+
+static char* GenGoto(ASTNode* node){
+	// The target may lie outside every block releasing arrays, which then release them as they're left
+	char* restore = GenStackRestore(NULL);
+	char* str = NULL;
+	if(node->lhs != NULL){
+		const char* target = GenExpressionAsm(node->lhs);
+		const char* format = "%s%s	jmp		*%%rax\n";
+		str = sngenf(strlen(format) + strlen(target) + strlen(restore) + 1, format, target, restore);
+	}
+	else {
+		char* label = LabelSymbol(node->value.strVal);
+		const char* format = "%s	jmp		%s\n";
+		str = sngenf(strlen(format) + strlen(restore) + strlen(label) + 1, format, restore, label);
+		free(label);
+	}
+	free(restore);
+	return str;
+}
+
 static char* GenStructDecl(ASTNode* node){
-	InsertStruct(node->value.strVal, MakeCompMembers(node->list));
+	InsertStruct(node->value.strVal, MakeCompMembers(node->list), node->attributes);
 	if(node->lhs == NULL)				return calloc(1, sizeof(char));
 	if(node->lhs->op != A_Declare)		FatalM("Expected child node of struct to be declaration! (In gen.h)", __LINE__);
 	return GenDeclaration(node->lhs);
@@ -1253,6 +3059,9 @@ static const char* GenStatementAsm(ASTNode* node){
 		case A_Continue:	return GenContinue(node);
 		case A_Break:		return GenBreak(node);
 		case A_StructDecl:	return GenStructDecl(node);
+		case A_Asm:			return GenAsm(node);
+		case A_Label:		return GenLabel(node);
+		case A_Goto:		return GenGoto(node);
 		case A_Switch:		return GenSwitch(node);
 		case A_EnumDecl:	return "";
 		default:			return GenExpressionAsm(node);
@@ -1267,6 +3076,11 @@ static const char* GenFunctionAsm(ASTNode* node){
 	Parameter* params = (Parameter*)node->secondaryValue.ptrVal;
 	Parameter* prevParams = curFuncParams;
 	curFuncParams = params;
+	curFuncName = node->value.strVal;
+	flatFrame = ContainsLabel(node->lhs) || ContainsDynamicAllocation(node->lhs, true);
+	flatStackSize = 0;
+	coldCode = calloc(1, sizeof(char));
+	labels.lreturn = -1;
 	int paramCount = 0;
 	if (params != NULL) {
 		paramCount++;
@@ -1275,7 +3089,9 @@ static const char* GenFunctionAsm(ASTNode* node){
 			params = params->next;
 		}
 	}
-	if(paramCount)
+	// Composites which don't fit in a register are returned through a pointer passed before the parameters
+	int hidden = IsMemoryComposite(node->type, node->cType) ? 1 : 0;
+	if(paramCount || hidden)
 		EnterScope();
 	char* globl = calloc(1, sizeof(char));
 	if(node->sClass != C_Static){
@@ -1284,8 +3100,30 @@ static const char* GenFunctionAsm(ASTNode* node){
 		int charCount = strlen(format) + strlen(node->value.strVal) + 1;
 		globl = sngenf(charCount, format, node->value.strVal);
 	}
+	// Hot and cold functions are grouped apart from the rest of the code, keeping the hot path dense in the cache
+	const char* section = "";
+	const char* sectionEnd = "";
+	int alignment = GetAttributeAlignment(node->attributes);
+	if(node->attributes & (AT_Hot | AT_Cold)){
+		section = node->attributes & AT_Hot ? "	.section .text.hot,\"x\"\n" : "	.section .text.unlikely,\"x\"\n";
+		sectionEnd = "	.text\n";
+		if((node->attributes & AT_Hot) && alignment < 16)
+			alignment = 16;
+	}
+	char* directive = GenAlignDirective(alignment);
+	strapp(&globl, directive);
+	free(directive);
+	const char* epilogue = node->attributes & AT_NoReturn
+		? "	ud2\n"
+		: "	movq	%rbp,	%rsp\n"
+		  "	pop		%rbp\n"
+		  "	ret\n";
+	// Floating results are returned in %xmm0
+	if(IsFloating(node->type) && !(node->attributes & AT_NoReturn))
+		epilogue = strjoin(node->type == P_Float ? "	movd	%eax,	%xmm0\n" : "	movq	%rax,	%xmm0\n", epilogue);
 	const char* format = 
-		"%s"						// Global Identifier (If applicable)
+		"%s"						// Section
+		"%s"						// Global Identifier (If applicable) and alignment
 		"%s:\n"						// Identifier
 		"	push	%%rbp\n"
 		"	movq	%%rsp,	%%rbp\n"
@@ -1294,40 +3132,80 @@ static const char* GenFunctionAsm(ASTNode* node){
 		"%s"						// Statement ASM
 		"%s"						// Stack Deallocation ASM
 		"7:\n"
-		"	movq	%%rbp,	%%rsp\n"
-		"	pop		%%rbp\n"
-		"	ret\n"
+		"%s"						// Epilogue
+		"%s"						// Unexpected Branches
+		"%s"						// Section end
 	;
 	char* paramPlacement = calloc(1, sizeof(char));
+	// Parameters passed by reference are copied once every register parameter has been stored, as copying uses %rcx and %rdx
+	char* paramCopies = calloc(1, sizeof(char));
+	int paramStackSize = (paramCount + hidden) * 8;
 	for(int i = paramCount - 1; i >= 0; i--){
-		char* paramPos = CalculateParamPosition(i, P_MODE_LOCAL);
-		char* varLoc = NULL;
-		if(i > 3)
-			varLoc = paramPos;
-		else {
-			int offset = stackIndex[scope] -= 8;
-			const char* const format = "%d(%%rbp)";
-			varLoc = sngenf(intlen(offset) + strlen(format) + 1, format, offset);
-		}
-		InsertVar(params->id, varLoc, params->type, params->cType, C_Default, scope);
+		int n = i + hidden;
+		char* paramPos = CalculateParamPosition(n, P_MODE_LOCAL);
+		// Parameters beyond the fourth are already on the stack, above the return address and shadow space
+		int offset = 48 + (8 * (n - 4));
+		if(n < 4)
+			offset = stackIndex[scope] -= 8;
+		Location location;
+		InitLocation(&location, L_Frame, NULL, offset);
+		char* varLoc = GenOperand(&location, 0);
 		const char* const format = "	movq	%s,	%s\n";
 		const int charCount = strlen(format) + strlen(varLoc) + strlen(paramPos) + 1;
 		char* buffer = sngenf(charCount, format, paramPos, varLoc);
-		if(i < 4)
+		if(IsFloating(params->type) && n < 4){
+			const char* const sseFormat = "	movs%c	%%xmm%d,	%s\n";
+			free(buffer);
+			buffer = sngenf(strlen(sseFormat) + strlen(varLoc) + 1, sseFormat, SSESuffix(params->type), n, varLoc);
+		}
+		if(n < 4)
 			strapp(&paramPlacement, buffer);
 		free(buffer);
+		if(IsMemoryComposite(params->type, params->cType)){
+			int size = GetTypeSize(params->type, params->cType);
+			paramStackSize += align(size, 8);
+			InitLocation(&location, L_Frame, NULL, stackIndex[scope] -= align(size, 8));
+			char* copyLoc = GenOperand(&location, 0);
+			char* copy = GenCopyTo(copyLoc, size);
+			const char* const copyFormat = "	movq	%s,	%%rax\n%s";
+			buffer = sngenf(strlen(copyFormat) + strlen(varLoc) + strlen(copy) + 1, copyFormat, varLoc, copy);
+			strapp(&paramCopies, buffer);
+			free(buffer);
+			free(copy);
+			free(copyLoc);
+		}
+		free(varLoc);
+		free(paramPos);
+		PlaceVar(params->symbol, &location, scope);
 		params = params->prev;
 	}
+	if(hidden){
+		int offset = stackIndex[scope] -= 8;
+		resultAddress = sngenf(intlen(offset) + 8, "%d(%%rbp)", offset);
+		const char* const format = "	movq	%%rcx,	%s\n";
+		char* buffer = sngenf(strlen(format) + strlen(resultAddress) + 1, format, resultAddress);
+		strapp(&paramPlacement, buffer);
+		free(buffer);
+	}
+	strapp(&paramPlacement, paramCopies);
+	free(paramCopies);
+	const char* statementAsm = GenBlockAsm(node->lhs);
+	// Returns from the branches placed after the epilogue jump to a copy of it following them
+	char* coldBranches = coldCode;
+	if(*coldCode){
+		coldBranches = sngenf(strlen(coldCode) + strlen(epilogue) + 4, "%s7:\n%s", coldCode, epilogue);
+		free(coldCode);
+	}
+	coldCode = NULL;
 	char* stackAlloc = calloc(1, sizeof(char));
 	char* stackDealloc = calloc(1, sizeof(char));
-	if(paramCount){
+	if(paramStackSize || flatStackSize){
 			const char* format = "	subq	$%d,	%%rsp\n";
-			const int allocSize = paramCount * 8;
+			const int allocSize = align(paramStackSize, 16) + flatStackSize;
 			stackAlloc = sngenf(strlen(format) + intlen(allocSize) + 1, format, allocSize);
 			format = "	addq	$%d,	%%rsp\n";
 			stackDealloc = sngenf(strlen(format) + intlen(allocSize) + 1, format, allocSize);
 	}
-	const char* statementAsm = GenBlockAsm(node->lhs);
 	int charCount =
 		strlen(globl)						// Global Identifier
 		+ strlen(node->value.strVal)		// Identifier
@@ -1336,13 +3214,16 @@ static const char* GenFunctionAsm(ASTNode* node){
 		+ strlen(statementAsm)				// Inner ASM
 		+ strlen(format)					// format
 		+ strlen(stackDealloc)				// Stack Deallocation ASM
+		+ strlen(section) + strlen(epilogue) + strlen(coldBranches) + strlen(sectionEnd)
 		+ 1									// \0
 	;
-	char* str = sngenf(charCount, format, globl, node->value.strVal, stackAlloc, paramPlacement, statementAsm, stackDealloc);
+	char* str = sngenf(charCount, format, section, globl, node->value.strVal, stackAlloc, paramPlacement, statementAsm, stackDealloc, epilogue, coldBranches, sectionEnd);
 	free(paramPlacement);
+	free(coldBranches);
 	free(stackAlloc);
-	if(node->sClass != C_Static)	free(globl);
-	if(paramCount)					ExitScope();
+	free(globl);
+	if(paramCount || hidden)		ExitScope();
+	resultAddress = NULL;
 	curFuncParams = prevParams;
 	return str;
 }
@@ -1367,8 +3248,15 @@ static const char* GenerateAsmFromList(ASTNodeList* list){
 char* GenerateAsm(ASTNodeList* node){
 	labels.lbreak = -1;
 	labels.lcontinue = -1;
+	labels.breakSaves = NULL;
+	labels.continueSaves = NULL;
 	data_section = calloc(1, sizeof(char));
-	bss_vars = MakeDbLnkList("", NULL, NULL);
+	rodata_section = calloc(1, sizeof(char));
+	tls_section = calloc(1, sizeof(char));
+	local_bss = calloc(1, sizeof(char));
+	staticLocals = 0;
+	string_pool = NULL;
+	bss_vars = MakeDbLnkList(NULL, NULL, NULL);
 	char* bss_section = calloc(1, sizeof(char));
 	char* Asm = _strdup(GenerateAsmFromList(node));
 	if(USE_SUB_SWITCH){
@@ -1412,26 +3300,53 @@ char* GenerateAsm(ASTNodeList* node){
 		free(data_section);
 		data_section = buffer;
 	}
-	if(bss_vars->next != NULL){
+	if(strlen(rodata_section)){
+		const char* format =
+			"	.section .rdata,\"dr\"\n"
+			"	.align 16\n"
+			"%s"
+		;
+		char* buffer = sngenf(strlen(format) + strlen(rodata_section) + 1, format, rodata_section);
+		strapp(&data_section, buffer);
+		free(buffer);
+	}
+	free(rodata_section);
+	if(strlen(tls_section)){
+		const char* format =
+			"	.section .tls$,\"dw\"\n"
+			"	.align 16\n"
+			"%s"
+		;
+		char* buffer = sngenf(strlen(format) + strlen(tls_section) + 1, format, tls_section);
+		strapp(&data_section, buffer);
+		free(buffer);
+	}
+	free(tls_section);
+	if(bss_vars->next != NULL || strlen(local_bss)){
 		bss_section = _strdup("	.bss\n	.align	16\n");
 		const char* const format =
 			"%s" // bss_section
 			"	.globl	%s\n" // id - Any bss variable is global by definition
+			"%s" // alignment
 			"%s:\n" // id
 			"	.zero	%d\n" // size
 		;
 		for(DbLnkList* bss = bss_vars; bss != NULL; bss = bss->next){
-			if(streq(bss->val, ""))	continue;
-			SymEntry* var = FindVar(bss->val, 0);
-			if(var == NULL)	FatalM("Failed to find global variable! (In gen.h)", __LINE__);
-			int charCount = strlen(bss_section) + 2*strlen(bss->val) + strlen(format) + 1;
-			char* buffer = sngenf(charCount, format, bss_section, bss->val, bss->val, GetTypeSize(var->type, var->cType));
+			SymEntry* var = bss->val;
+			if(var == NULL)	continue;
+			const char* id = var->location.name;
+			char* directive = GenAlignDirective(GetExplicitAlignment(var->type, var->cType, var->attributes));
+			int charCount = strlen(bss_section) + 2*strlen(id) + strlen(directive) + strlen(format) + intlen(GetSymbolSize(var)) + 1;
+			char* buffer = sngenf(charCount, format, bss_section, id, directive, id, GetSymbolSize(var));
+			free(directive);
 			free(bss_section);
 			bss_section = buffer;
 			if(bss->prev != NULL)
 				free(bss->prev);
 		}
+		strapp(&bss_section, local_bss);
 	}
+	free(local_bss);
 	char* buffer = _strdup(data_section);
 	strapp(&buffer, bss_section);
 	strapp(&buffer, "	.text\n");
@@ -18,6 +18,14 @@ extern_main int switchDepth init(0);
 extern_main int loopDepth init(0);
 extern_main bool USE_SUB_SWITCH init(false);
 extern_main bool FOLD_INLINE init(true);
+// Instructions outside the x86-64 baseline, which the target may be declared to have
+extern_main bool USE_POPCNT init(false);
+extern_main bool USE_LZCNT init(false);
+extern_main bool USE_BMI init(false);
+// Print the layout of each composite as it's defined
+extern_main bool DUMP_LAYOUT init(false);
+// Largest alignment of the members of composites, as set by '#pragma pack', or 0 for natural alignment
+extern_main int packAlignment init(0);
 
 extern_main void FatalM(const char* msg, int line);
 extern_main void WarnM(const char* msg, int line);
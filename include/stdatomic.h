@@ -0,0 +1,33 @@
+#ifndef _STDATOMIC_H_
+	#define _STDATOMIC_H_
+
+	// There are no _Atomic types; Any integer or pointer object of 1, 4 or 8 bytes may be operated on atomically
+	typedef int memory_order;
+	#define memory_order_relaxed	0
+	#define memory_order_consume	1
+	#define memory_order_acquire	2
+	#define memory_order_release	3
+	#define memory_order_acq_rel	4
+	#define memory_order_seq_cst	5
+
+	#define atomic_thread_fence(order) __SCC_BUILTIN__atomic_thread_fence(order)
+	#define atomic_signal_fence(order) __SCC_BUILTIN__atomic_signal_fence(order)
+
+	#define atomic_load_explicit(object, order) __SCC_BUILTIN__atomic_load(object, order)
+	#define atomic_store_explicit(object, desired, order) __SCC_BUILTIN__atomic_store(object, desired, order)
+	#define atomic_exchange_explicit(object, desired, order) __SCC_BUILTIN__atomic_exchange(object, desired, order)
+	#define atomic_compare_exchange_strong_explicit(object, expected, desired, success, failure) __SCC_BUILTIN__atomic_compare_exchange(object, expected, desired, success)
+	#define atomic_compare_exchange_weak_explicit(object, expected, desired, success, failure) __SCC_BUILTIN__atomic_compare_exchange(object, expected, desired, success)
+	#define atomic_fetch_add_explicit(object, operand, order) __SCC_BUILTIN__atomic_fetch_add(object, operand, order)
+	#define atomic_fetch_sub_explicit(object, operand, order) __SCC_BUILTIN__atomic_fetch_add(object, -(operand), order)
+	#define atomic_fetch_or_explicit(object, operand, order) __SCC_BUILTIN__atomic_fetch_or(object, operand, order)
+
+	#define atomic_load(object) atomic_load_explicit(object, memory_order_seq_cst)
+	#define atomic_store(object, desired) atomic_store_explicit(object, desired, memory_order_seq_cst)
+	#define atomic_exchange(object, desired) atomic_exchange_explicit(object, desired, memory_order_seq_cst)
+	#define atomic_compare_exchange_strong(object, expected, desired) atomic_compare_exchange_strong_explicit(object, expected, desired, memory_order_seq_cst, memory_order_seq_cst)
+	#define atomic_compare_exchange_weak(object, expected, desired) atomic_compare_exchange_weak_explicit(object, expected, desired, memory_order_seq_cst, memory_order_seq_cst)
+	#define atomic_fetch_add(object, operand) atomic_fetch_add_explicit(object, operand, memory_order_seq_cst)
+	#define atomic_fetch_sub(object, operand) atomic_fetch_sub_explicit(object, operand, memory_order_seq_cst)
+	#define atomic_fetch_or(object, operand) atomic_fetch_or_explicit(object, operand, memory_order_seq_cst)
+#endif
@@ -4,7 +4,9 @@
 #include <stddef.h>
 
 #define EOF (-1)
+#define SEEK_SET 0
 #define SEEK_CUR 1
+#define SEEK_END 2
 
 // This FILE definition will do for now
 typedef char * FILE;
@@ -15,6 +17,7 @@ size_t fread(void *ptr, size_t size, size_t nmemb, FILE *stream);
 size_t fwrite(void *ptr, size_t size, size_t nmemb, FILE *stream);
 int fgetc(FILE *_Stream);
 int fseek(FILE *_Stream, long _Offset, int _Origin);
+long ftell(FILE *_Stream);
 int fgetpos(FILE* _Stream, fpos_t* _Position);
 int fsetpos(FILE* _Stream, fpos_t* _Position);
 int fclose(FILE *stream);
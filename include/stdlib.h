@@ -23,14 +23,14 @@ void *calloc(size_t nitems, size_t size);
 void free(void *ptr);
 void* malloc(size_t size);
 void *realloc(void *ptr, size_t size);
-void abort();
-void exit(int status);
+void abort() __attribute__((noreturn));
+void exit(int status) __attribute__((noreturn));
 char *getenv(char *name);
 int system(char *string);
-int abs(int x);
+int abs(int x) __attribute__((const));
 div_t div(int numer, int denom);
-long labs(long x);
-long long llabs(long long x);
+long labs(long x) __attribute__((const));
+long long llabs(long long x) __attribute__((const));
 ldiv_t ldiv(long numer, long denom);
 int rand();
 void srand(int seed);
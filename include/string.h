@@ -11,14 +11,14 @@ void* memset(void *str, int c, size_t n);
 char* strcat(char *dest, char *src);
 char* strncat(char *dest, char *src, size_t n);
 char* strchr(char *str, int c);
-int strcmp(char *str1, char *str2);
+int strcmp(char *str1, char *str2) __attribute__((pure));
 int strncmp(char *str1, char *str2, size_t n);
 int strcoll(char *str1, char *str2);
 char* strcpy(char *dest, char *src);
 char* strncpy(char *dest, char *src, size_t n);
 size_t strcspn(char *str1, char *str2);
 char* strerror(int errnum);
-size_t strlen(char *str);
+size_t strlen(char *str) __attribute__((pure));
 char* strpbrk(char *str1, char *str2);
 char* strrchr(char *str, int c);
 size_t strspn(char *str1, char *str2);
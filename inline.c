@@ -0,0 +1,292 @@
+#include <string.h>
+
+#include "defs.h"
+#include "types.h"
+#include "inline.h"
+
+#define INLINE_MAX_SIZE		48	// Largest body, in nodes, inlined unless the function is always_inline
+#define INLINE_GROWTH		50	// Percentage by which inlining may grow the translation unit
+#define INLINE_MIN_GROWTH	256	// Nodes of growth permitted regardless of the size of the translation unit
+
+typedef struct rename Rename;
+
+/// A local of an inlined function, and the copy of it declared at the call site.
+struct rename {
+	SymEntry* from;
+	SymEntry* to;
+	Rename* next;
+};
+
+static ASTNodeList* inlineProgram = NULL;
+static int inlineBudget = 0;
+static int inlineSites = 0;
+
+static int CountNodes(ASTNode* node){
+	if(node == NULL)
+		return 0;
+	int count = 1 + CountNodes(node->lhs) + CountNodes(node->mid) + CountNodes(node->rhs);
+	ASTNodeList* list = node->list;
+	if(node->op == A_FunctionCall || node->op == A_BuiltinCall)
+		list = node->secondaryValue.ptrVal;
+	if(list != NULL)
+		for(int i = 0; i < list->count; i++)
+			count += CountNodes(list->nodes[i]);
+	return count;
+}
+
+static ASTNode* FindDefinition(const char* id){
+	for(int i = 0; i < inlineProgram->count; i++){
+		ASTNode* node = inlineProgram->nodes[i];
+		if(node->op == A_Function && node->lhs != NULL && streq(node->value.strVal, id))
+			return node;
+	}
+	return NULL;
+}
+
+/// @brief Combine the attributes and storage class given by every declaration of a function.
+static Attribute FunctionAttributes(const char* id, bool* isStatic){
+	Attribute attributes = AT_None;
+	*isStatic = false;
+	for(int i = 0; i < inlineProgram->count; i++){
+		ASTNode* node = inlineProgram->nodes[i];
+		if(node->op != A_Function || !streq(node->value.strVal, id))
+			continue;
+		attributes |= node->attributes;
+		if(node->sClass == C_Static)
+			*isStatic = true;
+	}
+	return attributes;
+}
+
+/// @brief Determine whether a body can be copied into another function.
+/// Anything that refers to the frame of the function, or is emitted once per declaration, prevents it.
+static bool IsInlinableBody(ASTNode* node){
+	if(node == NULL)
+		return true;
+	switch(node->op){
+		case A_RawASM:
+		case A_StructDecl:
+		case A_EnumDecl:
+		// Labels are symbols of the function they're defined in
+		case A_Label:
+		case A_LabelAddress:
+			return false;
+		case A_Declare:
+			if(node->sClass != C_Default || IsVariableLengthArray(node))
+				return false;
+			break;
+		// Stack allocated by the body would be released when the stack pointer is restored on leaving it
+		case A_BuiltinCall:
+			if(streq(node->value.strVal, "__SCC_BUILTIN__alloca"))
+				return false;
+			break;
+		default:
+			break;
+	}
+	if(!IsInlinableBody(node->lhs) || !IsInlinableBody(node->mid) || !IsInlinableBody(node->rhs))
+		return false;
+	ASTNodeList* list = node->list;
+	if(node->op == A_FunctionCall || node->op == A_BuiltinCall)
+		list = node->secondaryValue.ptrVal;
+	if(list != NULL)
+		for(int i = 0; i < list->count; i++)
+			if(!IsInlinableBody(list->nodes[i]))
+				return false;
+	return true;
+}
+
+static bool IsValueComposite(PrimordialType type){
+	return (type & 0xF0) == P_Composite && !(type & 0x0F);
+}
+
+/// @brief Determine whether a function can be inlined at all, regardless of its size.
+static bool IsInlinable(ASTNode* function){
+	if(IsValueComposite(function->type))
+		return false;
+	for(Parameter* param = function->secondaryValue.ptrVal; param != NULL; param = param->next)
+		if(streq(param->id, "...") || IsValueComposite(param->type))
+			return false;
+	return IsInlinableBody(function->lhs);
+}
+
+static const char* InlineName(const char* id, int site){
+	const char* format = "%s@%d";
+	return sngenf(strlen(format) + strlen(id) + intlen(site) + 1, format, id, site);
+}
+
+/// @brief Declare a copy of a local of an inlined function at a call site, which is given storage of its own.
+static Rename* RenameLocal(SymEntry* local, int site, Rename* next){
+	Rename* name = malloc(sizeof(Rename));
+	name->from = local;
+	name->to = malloc(sizeof(SymEntry));
+	memcpy(name->to, local, sizeof(SymEntry));
+	name->to->key = InlineName(local->key, site);
+	name->next = next;
+	return name;
+}
+
+static ASTNode* CloneRenamed(ASTNode* node, Rename** names, int site);
+
+static ASTNodeList* CloneRenamedList(ASTNodeList* list, Rename** names, int site){
+	ASTNodeList* copy = MakeASTNodeList();
+	for(int i = 0; i < list->count; i++)
+		AddNodeToASTList(copy, CloneRenamed(list->nodes[i], names, site));
+	return copy;
+}
+
+/// @brief Copy a statement or expression of an inlined body, binding its locals to their copies at the call site.
+/// References to anything else are bound to globals, which stay bound to them wherever the body is copied.
+static ASTNode* CloneRenamed(ASTNode* node, Rename** names, int site){
+	if(node == NULL)
+		return NULL;
+	ASTNode* copy = malloc(sizeof(ASTNode));
+	memcpy(copy, node, sizeof(ASTNode));
+	if(node->op == A_VarRef){
+		for(Rename* name = *names; name != NULL; name = name->next)
+			if(name->from == node->symbol){
+				copy->value.strVal = name->to->key;
+				copy->symbol = name->to;
+				return copy;
+			}
+		return copy;
+	}
+	Rename* saved = *names;
+	copy->lhs = CloneRenamed(node->lhs, names, site);
+	copy->mid = CloneRenamed(node->mid, names, site);
+	copy->rhs = CloneRenamed(node->rhs, names, site);
+	if(node->list != NULL)
+		copy->list = CloneRenamedList(node->list, names, site);
+	if(node->op == A_FunctionCall || node->op == A_BuiltinCall)
+		copy->secondaryValue.ptrVal = CloneRenamedList(node->secondaryValue.ptrVal, names, site);
+	switch(node->op){
+		case A_Declare:
+			// The initializer can't refer to the variable it initializes, so it's renamed afterwards
+			*names = RenameLocal(node->symbol, site, *names);
+			copy->value.strVal = (*names)->to->key;
+			copy->symbol = (*names)->to;
+			break;
+		case A_Block:
+		case A_For:
+		case A_Switch:
+			*names = saved;
+			break;
+		default:
+			break;
+	}
+	return copy;
+}
+
+/// @brief Build the inlined body of a call. The parameters are declared first, initialized by the arguments.
+/// @return NULL if the arguments don't match the parameters.
+static ASTNode* MakeInline(ASTNode* call, ASTNode* callee){
+	ASTNodeList* args = call->secondaryValue.ptrVal;
+	ASTNodeList* body = MakeASTNodeList();
+	Rename* names = NULL;
+	int site = inlineSites++;
+	int count = 0;
+	for(Parameter* param = callee->secondaryValue.ptrVal; param != NULL; param = param->next){
+		if(count >= args->count)
+			return NULL;
+		names = RenameLocal(param->symbol, site, names);
+		ASTNode* decl = MakeASTNode(A_Declare, param->type, args->nodes[count++], NULL, NULL, FlexStr(names->to->key), param->cType);
+		decl->qualifiers = param->qualifiers;
+		decl->symbol = names->to;
+		AddNodeToASTList(body, decl);
+	}
+	if(count != args->count)
+		return NULL;
+	ASTNodeList* statements = callee->lhs->list;
+	for(int i = 0; i < statements->count; i++)
+		AddNodeToASTList(body, CloneRenamed(statements->nodes[i], &names, site));
+	return MakeASTNodeEx(A_Inline, call->type, MakeASTList(A_Block, body, FlexNULL()), NULL, NULL, FlexStr(call->value.strVal), FlexInt(count), call->cType);
+}
+
+/// @brief Inline a call if its function is eligible, and small enough to fit in the growth budget.
+static ASTNode* InlineCall(ASTNode* call, ASTNode* caller){
+	const char* id = call->value.strVal;
+	bool isStatic = false;
+	Attribute attributes = FunctionAttributes(id, &isStatic);
+	ASTNode* callee = FindDefinition(id);
+	// Arguments are evaluated inside the inlined body, so they mustn't allocate stack either
+	if(callee == NULL || callee == caller || (attributes & AT_NoInline) || !IsInlinable(callee) || ContainsDynamicAllocation(call, false))
+		return call;
+	int size = CountNodes(callee->lhs);
+	bool forced = attributes & AT_AlwaysInline;
+	if(!forced && ((!isStatic && !(attributes & AT_Inline)) || size > INLINE_MAX_SIZE || size > inlineBudget))
+		return call;
+	ASTNode* inlined = MakeInline(call, callee);
+	if(inlined == NULL)
+		return call;
+	if(!forced)
+		inlineBudget -= size;
+	return inlined;
+}
+
+static void InlineStatement(ASTNode** slot, ASTNode* caller);
+
+static void InlineStatementList(ASTNodeList* list, ASTNode* caller){
+	for(int i = 0; i < list->count; i++)
+		InlineStatement(&list->nodes[i], caller);
+}
+
+/// @brief Inline the calls a statement evaluates as a whole: A discarded call, the initializer of a declaration,
+/// the value stored to a variable, or the returned value.
+static void InlineStatement(ASTNode** slot, ASTNode* caller){
+	ASTNode* stmt = *slot;
+	if(stmt == NULL)
+		return;
+	switch(stmt->op){
+		case A_Block:
+		case A_Case:
+		case A_Default:
+		case A_Switch:
+			if(stmt->list != NULL)
+				InlineStatementList(stmt->list, caller);
+			break;
+		case A_If:
+			InlineStatement(&stmt->rhs, caller);
+			InlineStatement(&stmt->mid, caller);
+			break;
+		case A_While:
+		case A_Do:
+		case A_For:
+			InlineStatement(&stmt->rhs, caller);
+			break;
+		case A_FunctionCall:
+			*slot = InlineCall(stmt, caller);
+			break;
+		case A_Declare:
+			if(stmt->sClass == C_Default && stmt->mid == NULL && stmt->lhs != NULL && stmt->lhs->op == A_FunctionCall)
+				stmt->lhs = InlineCall(stmt->lhs, caller);
+			break;
+		case A_Assign:
+			// Stores through a pointer keep the address on the stack while the value is evaluated
+			if(stmt->lhs->op == A_VarRef && stmt->rhs->op == A_FunctionCall)
+				stmt->rhs = InlineCall(stmt->rhs, caller);
+			break;
+		case A_Return:
+			if(stmt->lhs != NULL && stmt->lhs->op == A_FunctionCall)
+				stmt->lhs = InlineCall(stmt->lhs, caller);
+			break;
+		default:
+			break;
+	}
+}
+
+ASTNodeList* InlineProgram(ASTNodeList* program){
+	inlineProgram = program;
+	int size = 0;
+	for(int i = 0; i < program->count; i++)
+		if(program->nodes[i]->op == A_Function)
+			size += CountNodes(program->nodes[i]->lhs);
+	inlineBudget = size * INLINE_GROWTH / 100;
+	if(inlineBudget < INLINE_MIN_GROWTH)
+		inlineBudget = INLINE_MIN_GROWTH;
+	for(int i = 0; i < program->count; i++){
+		ASTNode* node = program->nodes[i];
+		if(node->op != A_Function || node->lhs == NULL)
+			continue;
+		InlineStatement(&node->lhs, node);
+	}
+	return program;
+}
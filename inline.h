@@ -0,0 +1,11 @@
+#ifndef INLINE_INCLUDED
+#define INLINE_INCLUDED
+
+#include "defs.h"
+#include "types.h"
+
+/// @brief Replace calls to small static and inline functions by copies of their bodies.
+/// Only calls whose result is discarded, stored to a variable, or returned are inlined, as their evaluation leaves nothing on the stack.
+ASTNodeList* InlineProgram(ASTNodeList* program);
+
+#endif
@@ -6,7 +6,52 @@
 #include "globals.h"
 #include "lex.h"
 
+#define PACK_DEPTH	16	// Deepest nesting of '#pragma pack(push)'
+
 Token* transientToken = NULL;
+static int packStack[PACK_DEPTH];
+static int packDepth = 0;
+static long pragmaPosition = -1;	// Position of the last pragma applied, as tokens are lexed again each time they're peeked
+
+/// @brief Tokenize a floating literal. Its value is kept as text, which is converted by the assembler when it is emitted.
+static void TokenizeFloatLiteral(Token* token, const char* str){
+	int length = strlen(str);
+	token->type = T_LitDouble;
+	if(str[length - 1] == 'f' || str[length - 1] == 'F'){
+		token->type = T_LitFloat;
+		length--;
+	}
+	else if(str[length - 1] == 'l' || str[length - 1] == 'L')
+		length--;	// long double is treated as double
+	// A bare decimal point is given digits on both sides, as the assembler may not accept it otherwise
+	char* value = calloc(length + 3, sizeof(char));
+	int n = 0;
+	bool point = false;
+	bool exponent = false;
+	if(str[0] == '.')
+		value[n++] = '0';
+	for(int i = 0; i < length; i++){
+		char c = str[i];
+		value[n++] = c;
+		if(isdigit(c))
+			continue;
+		if(c == '.' && !point && !exponent){
+			point = true;
+			if(!isdigit(str[i + 1]))
+				value[n++] = '0';
+			continue;
+		}
+		if((c == 'e' || c == 'E') && !exponent){
+			exponent = true;
+			if(str[i + 1] == '+' || str[i + 1] == '-')
+				value[n++] = str[++i];
+			if(i + 1 < length && isdigit(str[i + 1]))
+				continue;
+		}
+		FatalM("Invalid floating literal!", Line);
+	}
+	token->value.strVal = value;
+}
 
 static Token* Tokenize(const char* str){
 	Token* token = malloc(sizeof(Token));
@@ -48,6 +93,8 @@ static Token* Tokenize(const char* str){
 		else if(streq(str, "char"))		token->type = T_Char;
 		else if(streq(str, "void"))		token->type = T_Void;
 		else if(streq(str, "long"))		token->type = T_Long;
+		else if(streq(str, "float"))	token->type = T_Float;
+		else if(streq(str, "double"))	token->type = T_Double;
 		else if(streq(str, "<="))		token->type = T_LessEqual;
 		else if(streq(str, ">="))		token->type = T_GreaterEqual;
 		else if(streq(str, "=="))		token->type = T_DoubleEqual;
@@ -87,8 +134,24 @@ static Token* Tokenize(const char* str){
 		else if(streq(str, "default"))	token->type = T_Default;
 		else if(streq(str, "sizeof"))	token->type = T_Sizeof;
 		else if(streq(str, "static"))	token->type = T_Static;
+		else if(streq(str, "_Thread_local") || streq(str, "__thread"))
+			token->type = T_ThreadLocal;
 		else if(streq(str, "unsigned"))	token->type = T_Unsigned;
+		else if(streq(str, "const"))	token->type = T_Const;
+		else if(streq(str, "restrict") || streq(str, "__restrict") || streq(str, "__restrict__"))
+			token->type = T_Restrict;
+		else if(streq(str, "inline") || streq(str, "__inline") || streq(str, "__inline__"))
+			token->type = T_Inline;
+		else if(streq(str, "__attribute__") || streq(str, "__attribute"))
+			token->type = T_Attribute;
+		else if(streq(str, "goto"))		token->type = T_Goto;
+		else if(streq(str, "asm") || streq(str, "__asm") || streq(str, "__asm__"))
+			token->type = T_Asm;
+		else if(streq(str, "volatile") || streq(str, "__volatile") || streq(str, "__volatile__"))
+			token->type = T_Volatile;
 		else if(streq(str, "=||"))		token->type = T_EqualDoublePipe;
+		else if((isdigit(str[0]) || str[0] == '.') && !(str[0] == '0' && strchr("xbo", str[1]) != NULL) && strpbrk(str, ".eE") != NULL)
+			TokenizeFloatLiteral(token, str);
 		else if(isdigit(str[0])){
 			token->type = T_LitInt;
 			char* end;
@@ -150,6 +213,60 @@ static Token* Tokenize(const char* str){
 	return token;
 }
 
+/// @brief Read the rest of a pre-processor directive's line, including the newline.
+static char* ReadDirective(){
+	int length = 32;
+	int i = 0;
+	char* line = malloc(length * sizeof(char));
+	int c = fgetc(fptr);
+	while(c != '\n' && c != EOF){
+		if(i == length - 1)
+			line = realloc(line, length += 32);
+		line[i++] = c;
+		c = fgetc(fptr);
+	}
+	line[i] = '\0';
+	return line;
+}
+
+/// @brief Apply a '#pragma' directive, given the rest of its line. Pragmas other than 'pack' are ignored.
+/// 'pack' accepts no argument, an alignment, "push" optionally followed by an alignment, or "pop".
+static void ApplyPragma(char* directive){
+	const char* delimiters = " \t\r(),";
+	strtok(directive, delimiters);	// pragma
+	char* name = strtok(NULL, delimiters);
+	if(name == NULL || !streq(name, "pack"))
+		return;
+	char* arg = strtok(NULL, delimiters);
+	bool push = arg != NULL && streq(arg, "push");
+	if(push){
+		if(packDepth == PACK_DEPTH)	FatalM("'#pragma pack(push)' nested too deeply!", Line);
+		packStack[packDepth++] = packAlignment;
+		arg = strtok(NULL, delimiters);
+	}
+	else if(arg != NULL && streq(arg, "pop")){
+		if(!packDepth)				FatalM("'#pragma pack(pop)' without a matching push!", Line);
+		packAlignment = packStack[--packDepth];
+		return;
+	}
+	if(arg == NULL){
+		if(!push)
+			packAlignment = 0;
+		return;
+	}
+	int alignment = atoi(arg);
+	if(alignment <= 0 || alignment > 16 || (alignment & (alignment - 1)))
+		FatalM("Packing alignment must be 1, 2, 4, 8 or 16!", Line);
+	packAlignment = alignment;
+}
+
+/// @brief Clear the packing set by '#pragma pack', before lexing another file.
+void ResetPragmas(){
+	packAlignment = 0;
+	packDepth = 0;
+	pragmaPosition = -1;
+}
+
 char* ShiftToken(){
 	char* token = malloc(32 * sizeof(char));
 	int len = 32;
@@ -166,6 +283,19 @@ char* ShiftToken(){
 		if(c == EOF)
 			break;
 		if(!charLit && !strLit && c == '#'){
+			long position = ftell(fptr);
+			char* directive = ReadDirective();
+			if(strbeg(directive + strspn(directive, " \t"), "pragma")){
+				if(position > pragmaPosition){
+					pragmaPosition = position;
+					ApplyPragma(directive);
+				}
+				free(directive);
+				Line++;
+				continue;
+			}
+			free(directive);
+			fseek(fptr, position, SEEK_SET);
 			Token* tok = GetTransientToken();
 			if(tok->type != T_LitInt)	FatalM("Expected pre-processor line number!", Line);
 			int l = tok->value.intVal;
@@ -228,6 +358,19 @@ char* ShiftToken(){
 			fseek(fptr, -1, SEEK_CUR);
 			break;
 		}
+		// Numbers continue through a decimal point, and the sign of an exponent
+		if(i && isdigit(token[0]) && (c == '.' || ((c == '+' || c == '-') && (token[i - 1] == 'e' || token[i - 1] == 'E') && token[1] != 'x'))){
+			token[i++] = c;
+			continue;
+		}
+		if(!i && c == '.'){
+			char nextChar = fgetc(fptr);
+			fseek(fptr, -1, SEEK_CUR);
+			if(isdigit(nextChar)){
+				token[i++] = c;
+				continue;
+			}
+		}
 		if(strchr("(){};-~!+*/%%<>=&^|?:.,[]", c)){
 			if(i){
 				fseek(fptr, -1, SEEK_CUR);
@@ -307,8 +450,6 @@ char* ShiftToken(){
 	}
 	token = realloc(token, i + 1);
 	token[i] = '\0';
-	if(streq(token, "const"))
-		return ShiftToken();
 	return i ? token : NULL;
 }
 
@@ -18,6 +18,7 @@ Token* PeekTokenN(int n);
 Token* GetToken();
 Token* GetTransientToken();
 void SkipToken();
+void ResetPragmas();
 
 
 #endif
\ No newline at end of file
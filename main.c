@@ -17,6 +17,8 @@
 #include "symTable.h"
 #include "parse.h"
 #include "gen.h"
+#include "fold.h"
+#include "inline.h"
 
 #ifdef extern_main
 	#undef extern_main
@@ -26,8 +28,6 @@
 
 #include "globals.h"
 
-ASTNode* FoldASTNodes(ASTNode* tree);
-ASTNodeList* FoldASTNodeList(ASTNodeList* list);
 char* AlterFileExtension(const char* filename, const char* extension);
 char* DumpASTTree(ASTNode* tree, int depth);
 char* charStr(char c, int count);
@@ -38,7 +38,7 @@ char* target;
 
 void Usage(char* file){
 	const char* format =
-		"Usage: %s [-pqStc] [-nofold|-nofoldi|-nofolds] [-o outFile] [-isystem includes] file [file ...]\n"
+		"Usage: %s [-pqStc] [-nofold|-nofoldi|-nofolds] [-noinline] [-mpopcnt] [-mlzcnt] [-mbmi] [-fdump-layout] [-o outFile] [-isystem includes] file [file ...]\n"
 		"	-q Disable warnings\n"
 		"	-p Print the output to the console\n"
 		"	-S Generate assembly files, but don't assemble or link them\n"
@@ -47,6 +47,11 @@ void Usage(char* file){
 		"	-nofold Disable fold optimizations\n"
 		"	-nofoldi Disable inline folding optimization\n"
 		"	-nofolds Disable fold optimization stage\n"
+		"	-noinline Disable function inlining\n"
+		"	-mpopcnt Use popcnt to count set bits\n"
+		"	-mlzcnt Use lzcnt to count leading zeros\n"
+		"	-mbmi Use tzcnt to count trailing zeros\n"
+		"	-fdump-layout Print the layout of each struct and union: Member offsets, holes, and members crossing cache lines\n"
 		"	-o outfile, produce the outfile executable file\n"
 		"	-isystem includes, specify an alternate locaton for the standard headers\n"
 	;
@@ -67,6 +72,7 @@ int main(int argc, char** argv){
 	bool link		= true;
 	bool peephole	= true;
 	bool foldStage	= true;
+	bool inlineStage	= true;
 	const char* incDir = "./include";
 	for(int i = 1; i < argc; i++){
 		if(argv[i][0] == '-'){
@@ -95,6 +101,11 @@ int main(int argc, char** argv){
 			else if(streq(argv[i], "-nopeep"))	peephole	= false;
 			else if(streq(argv[i], "-nofoldi"))	FOLD_INLINE	= false;
 			else if(streq(argv[i], "-nofolds"))	foldStage	= false;
+			else if(streq(argv[i], "-noinline"))	inlineStage	= false;
+			else if(streq(argv[i], "-mpopcnt"))	USE_POPCNT	= true;
+			else if(streq(argv[i], "-mlzcnt"))	USE_LZCNT	= true;
+			else if(streq(argv[i], "-mbmi"))	USE_BMI		= true;
+			else if(streq(argv[i], "-fdump-layout"))	DUMP_LAYOUT	= true;
 			else if(streq(argv[i], "-nofold")){
 				FOLD_INLINE	= false;
 				foldStage = false;
@@ -123,6 +134,7 @@ int main(int argc, char** argv){
 			output = NULL;
 		fptr = fopen(target, "r");
 		Line = 1;
+		ResetPragmas();
 		ASTNodeList* ast = MakeASTNodeList();
 		while(PeekToken() != NULL)
 			AddNodeToASTList(ast, ParseNode());
@@ -130,10 +142,13 @@ int main(int argc, char** argv){
 		fclose(fptr);
 		unlink(target);
 		free(target);
+		fptr = NULL;
 		target = NULL;
 		Line = NOLINE;
+		if(inlineStage)
+			ast = InlineProgram(ast);
 		if(foldStage)
-			ast = FoldASTNodeList(ast);
+			ast = FoldProgram(ast);
 		if(dump){
 			if(output == NULL || print){
 				if(supIntl)
@@ -294,191 +309,6 @@ char* PeepOptimize(char* Asm){
 	return strrem(Asm, "	addq	$32,	%rsp\n	subq	$32,	%rsp\n");
 }
 
-ASTNodeList* FoldASTNodeList(ASTNodeList* list){
-	for(int i = 0; i < list->count; i++)
-		list->nodes[i] = FoldASTNodes(list->nodes[i]);
-	return list;
-}
-
-ASTNode* FoldASTNodes(ASTNode* tree){
-	if(tree->lhs != NULL)			tree->lhs = FoldASTNodes(tree->lhs);
-	if(tree->mid != NULL)			tree->mid = FoldASTNodes(tree->mid);
-	if(tree->rhs != NULL)			tree->rhs = FoldASTNodes(tree->rhs);
-	if(tree->list != NULL)			tree->list = FoldASTNodeList(tree->list);
-	if(tree->op == A_FunctionCall)	tree->secondaryValue.ptrVal = FoldASTNodeList(tree->secondaryValue.ptrVal);
-
-	NodeType lhsOp = tree->lhs == NULL ? A_Undefined : tree->lhs->op;
-	NodeType rhsOp = tree->rhs == NULL ? A_Undefined : tree->rhs->op;
-	bool lhsIsInt = tree->lhs != NULL && lhsOp == A_LitInt;
-	bool rhsIsInt = tree->rhs != NULL && rhsOp == A_LitInt;
-
-	switch(tree->op){
-		case A_LitInt:		return tree;
-		case A_Negate:
-			if(!lhsIsInt)
-				break;
-			tree->lhs->value.intVal = -tree->lhs->value.intVal;
-			return tree->lhs;
-		case A_LogicalNot:
-			if(!lhsIsInt)
-				break;
-			tree->lhs->value.intVal = !tree->lhs->value.intVal;
-			return tree->lhs;
-		case A_BitwiseComplement:
-			if(!lhsIsInt)
-				break;
-			tree->lhs->value.intVal = ~tree->lhs->value.intVal;
-			return tree->lhs;
-		case A_Multiply:
-			if(!lhsIsInt && !rhsIsInt)
-				break;
-			if(lhsIsInt){
-				int lhsVal = tree->lhs->value.intVal;
-				if(rhsIsInt){
-					tree->lhs->value.intVal *= tree->rhs->value.intVal;
-					return tree->lhs;
-				}
-				if(lhsVal == 0){
-					tree->lhs->value.intVal = 0;
-					return tree->lhs;
-				}
-				if(lhsVal == 1)
-					return tree->rhs;
-			}
-			if(rhsIsInt){
-				int rhsVal = tree->rhs->value.intVal;
-				if(rhsVal == 0){
-					tree->rhs->value.intVal = 0;
-					return tree->rhs;
-				}
-				if(rhsVal == 1)
-					return tree->lhs;
-			}
-			break;
-		case A_Divide:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal /= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_Modulo:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal %= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_Add:
-			if(!lhsIsInt && !rhsIsInt)
-				break;
-			if(lhsIsInt){
-				if(rhsIsInt){
-					tree->lhs->value.intVal += tree->rhs->value.intVal;
-					return tree->lhs;
-				}
-				if(tree->lhs->value.intVal == 0)
-					return tree->rhs;
-			}
-			if(rhsIsInt && tree->rhs->value.intVal == 0)
-				return tree->lhs;
-			break;
-		case A_Subtract:
-			if(!lhsIsInt && !rhsIsInt)
-				break;
-			if(rhsIsInt){
-				if(lhsIsInt){
-					tree->lhs->value.intVal -= tree->rhs->value.intVal;
-					return tree->lhs;
-				}
-				if(tree->rhs->value.intVal == 0)
-					return tree->lhs;
-			}
-			// // TODO: This is useful, but I'm working on folding, not strength, so I'll come back and include it later
-			// if(lhsIsInt && tree->lhs->value.intVal == 0)
-			// 	return MakeASTLeaf(A_Negate, tree->rhs);
-			break;
-		case A_LeftShift:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal <<= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		// case A_RightShift:
-		// 	if(lhsIsInt && rhsIsInt){
-		// 		tree->lhs->value.intVal >>= tree->rhs->value.intVal;
-		// 		return tree->lhs;
-		// 	}
-		// 	break;
-		case A_LessThan:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal < tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_GreaterThan:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal > tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_LessOrEqual:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal <= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_GreaterOrEqual:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal >= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_EqualTo:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal == tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_NotEqualTo:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal != tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_BitwiseAnd:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal &= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_BitwiseXor:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal ^= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_BitwiseOr:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal |= tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_LogicalAnd:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal && tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		case A_LogicalOr:
-			if(lhsIsInt && rhsIsInt){
-				tree->lhs->value.intVal = tree->lhs->value.intVal || tree->rhs->value.intVal;
-				return tree->lhs;
-			}
-			break;
-		default:	break;
-	}
-	return tree;
-}
-
 char* DumpASTTree(ASTNode* tree, int depth){
 	char* lhs = tree->lhs == NULL ? calloc(1, sizeof(char)) : DumpASTTree(tree->lhs, depth + 1);
 	char* mid = tree->mid == NULL ? calloc(1, sizeof(char)) : DumpASTTree(tree->mid, depth + 1);
@@ -511,6 +341,13 @@ char* DumpASTTree(ASTNode* tree, int depth){
 		case A_VarRef:				val = tree->value.strVal;	break;
 		case A_Assign:				val = tree->value.strVal == NULL ? "expr" : tree->value.strVal;	break;
 		case A_BuiltinCall:
+		case A_Inline:
+		case A_Asm:
+		case A_AsmOperand:
+		case A_Label:
+		case A_Goto:
+		case A_LabelAddress:
+		case A_LitFloat:
 		case A_FunctionCall:		val = tree->value.strVal;	break;
 		case A_LitStr:
 			val = tree->value.strVal;
@@ -530,6 +367,8 @@ char* DumpASTTree(ASTNode* tree, int depth){
 			break;
 		}
 		case A_Case:
+		case A_InitField:
+		case A_Initializer:
 		case A_LitInt:{
 			const int charCount = intlen(tree->value.intVal) + (tree->value.intVal < 0) + 1;
 			char* buffer = malloc(charCount * sizeof(char));
@@ -604,6 +443,15 @@ char* DumpASTTree(ASTNode* tree, int depth){
 		case A_ExpressionList:		name = "ExpressionList";		break;
 		case A_RepeatLogicalOr:		name = "RepeatingLogicalOR";	break;
 		case A_Logicize:			name = "Logicize";				break;
+		case A_Initializer:			name = "Initializer";			break;
+		case A_InitField:			name = "InitField";				break;
+		case A_Inline:				name = "Inline";				break;
+		case A_Asm:					name = "Asm";					break;
+		case A_AsmOperand:			name = "AsmOperand";			break;
+		case A_Label:				name = "Label";					break;
+		case A_Goto:				name = "Goto";					break;
+		case A_LabelAddress:		name = "LabelAddress";			break;
+		case A_LitFloat:			name = "LitFloat";				break;
 	}
 	const char* type = calloc(1, sizeof(char));
 	switch(tree->type & 0xF0){
@@ -617,6 +465,8 @@ char* DumpASTTree(ASTNode* tree, int depth){
 		case P_UInt:		type = "unsigned int";			break;
 		case P_ULong:		type = "unsigned long";			break;
 		case P_ULongLong:	type = "unsigned long long";	break;
+		case P_Float:		type = "float";					break;
+		case P_Double:		type = "double";				break;
 		case P_Composite:	type = "struct";				break;
 	}
 	if(tree->type & 0x0F){
@@ -5,37 +5,249 @@
 #include "defs.h"
 #include "symTable.h"
 #include "lex.h"
+#include "fold.h"
 
 static ASTNode* ParseExpression();
 static ASTNode* ParseStatement();
 static ASTNode* ParseBlock();
 
 
+static DbLnkList* labelsDefined = NULL;	// Labels of the function being parsed
+static DbLnkList* labelsUsed = NULL;	// Labels referenced by the function being parsed
+static PrimordialType returnType = P_Undefined;	// Return type of the function being parsed
+static bool parsingMembers = false;	// Declarations being parsed are members of a composite
+
+static bool LabelListContains(DbLnkList* list, const char* label){
+	for(; list != NULL; list = list->next)
+		if(streq(list->val, label))
+			return true;
+	return false;
+}
+
+static ASTNode* MakeFoldableBinary(NodeType op, PrimordialType type, ASTNode* lhs, ASTNode* rhs){
+	ASTNode* node = MakeASTBinary(op, type, lhs, rhs, FlexNULL());
+	return FOLD_INLINE ? FoldNode(node) : node;
+}
+
+static ASTNode* MakeFoldableUnary(NodeType op, ASTNode* lhs){
+	ASTNode* node = MakeASTUnary(op, lhs, FlexNULL(), NULL);
+	return FOLD_INLINE ? FoldNode(node) : node;
+}
+
+/// @brief Convert an expression to another arithmetic type, where either type is floating.
+/// Conversions between integer types are left implicit.
+static ASTNode* ConvertFloating(ASTNode* node, PrimordialType type){
+	if(node->type == type || (!IsFloating(node->type) && !IsFloating(type)))
+		return node;
+	if(!IsArithmetic(node->type) || !IsArithmetic(type))
+		FatalM("Floating types may only be converted to and from arithmetic types!", Line);
+	ASTNode* cast = MakeASTNode(A_Cast, type, node, NULL, NULL, FlexNULL(), NULL);
+	return node->op == A_LitInt || node->op == A_LitFloat ? FoldNode(cast) : cast;
+}
+
+/// @brief Fold the sign into a negated literal, so initializers see a constant even when folding is disabled.
+static ASTNode* FoldLiteralSign(ASTNode* node){
+	if(node->op != A_Negate || node->lhs == NULL)
+		return node;
+	node->lhs = FoldLiteralSign(node->lhs);
+	return node->lhs->op == A_LitInt || node->lhs->op == A_LitFloat ? FoldNode(node) : node;
+}
+
+/// @brief Apply the usual arithmetic conversions to the operands of a binary operator, if either is floating.
+/// @return The type the operation is carried out in.
+static PrimordialType ConvertFloatingOperands(ASTNode** lhs, ASTNode** rhs){
+	if(!IsFloating((*lhs)->type) && !IsFloating((*rhs)->type))
+		return NodeWidestType((*lhs), (*rhs));
+	PrimordialType type = (*lhs)->type == P_Double || (*rhs)->type == P_Double ? P_Double : P_Float;
+	*lhs = ConvertFloating(*lhs, type);
+	*rhs = ConvertFloating(*rhs, type);
+	return type;
+}
+
+/// @brief Ensure a composite value is only converted to the same composite type.
+static void CheckCompositeConversion(PrimordialType type, SymEntry* cType, ASTNode* node){
+	if((type == P_Composite || node->type == P_Composite) && (type != node->type || (cType != NULL && node->cType != NULL && cType != node->cType)))
+		FatalM("Composite values can only be converted to the same composite type!", Line);
+}
+
+static ASTNode* RejectFloating(ASTNode* node){
+	if(IsFloating(node->type))		FatalM("Floating operands are not valid for this operator!", Line);
+	return node;
+}
+
+/// @brief Compare a floating expression used as a condition with zero, as negative zero has a bit set.
+static ASTNode* MakeCondition(ASTNode* node){
+	if(node == NULL || !IsFloating(node->type))
+		return node;
+	return MakeASTBinary(A_NotEqualTo, P_Int, node, MakeASTLeaf(A_LitFloat, node->type, FlexStr("0")), FlexNULL());
+}
+
 static PrimordialType GetType(Token* t){
 	switch(t->type){
 		case T_Int:		return P_Int;
 		case T_Char:	return P_Char;
 		case T_Long:	return P_Long;
+		case T_Float:	return P_Float;
+		case T_Double:	return P_Double;
 		case T_Void:	return P_Void;
 		default:		return P_Undefined;
 	}
 }
 
-static PrimordialType ParseType(StorageClass* sc){
+/// @brief Parse any type qualifiers at the current position.
+/// @return The combined qualifier flags.
+static TypeQualifier ParseQualifiers(){
+	TypeQualifier qualifiers = Q_None;
+	while(true){
+		switch(PeekToken()->type){
+			case T_Const:		qualifiers |= Q_Const;		break;
+			case T_Restrict:	qualifiers |= Q_Restrict;	break;
+			default:			return qualifiers;
+		}
+		SkipToken();
+	}
+}
+
+/// @brief Determine whether an attribute name is either 'name' or '__name__'.
+static bool IsAttributeName(const char* str, const char* name){
+	if(streq(str, name))
+		return true;
+	int length = strlen(name);
+	return strbeg(str, "__") && strlen(str) == (size_t)(length + 4) && !strncmp(str + 2, name, length) && streq(str + 2 + length, "__");
+}
+
+/// @brief Parse the argument of 'aligned', the attribute name having been consumed.
+static Attribute ParseAlignedAttribute(){
+	// Without an argument, the largest alignment of any scalar is used
+	if(PeekToken()->type != T_OpenParen)
+		return MakeAlignedAttribute(16);
+	SkipToken();
+	long long alignment = 0;
+	if(!EvaluateConstant(ParseExpression(), &alignment))	FatalM("Alignment must be an integer constant expression!", Line);
+	if(alignment <= 0 || (alignment & (alignment - 1)))		FatalM("Alignment must be a positive power of two!", Line);
+	if(alignment > 4096)									FatalM("Alignment may not exceed 4096 bytes!", Line);
+	if(GetTransientToken()->type != T_CloseParen)			FatalM("Expected close parenthesis ')' after alignment!", Line);
+	return MakeAlignedAttribute(alignment);
+}
+
+/// @brief Parse the argument list of an attribute specifier, '__attribute__((' having been consumed.
+static Attribute ParseAttributeList(){
+	Attribute attributes = AT_None;
+	while(PeekToken()->type != T_CloseParen){
+		Token* tok = GetTransientToken();
+		const char* name = tok->type == T_Identifier ? tok->value.strVal : NULL;
+		if(tok->type == T_Inline)
+			attributes |= AT_Inline;
+		else if(tok->type == T_Const)
+			attributes |= AT_Const;
+		else if(name == NULL)
+			FatalM("Expected attribute name!", Line);
+		else if(IsAttributeName(name, "always_inline"))
+			attributes |= AT_AlwaysInline;
+		else if(IsAttributeName(name, "noinline"))
+			attributes |= AT_NoInline;
+		else if(IsAttributeName(name, "hot"))
+			attributes |= AT_Hot;
+		else if(IsAttributeName(name, "cold"))
+			attributes |= AT_Cold;
+		else if(IsAttributeName(name, "pure"))
+			attributes |= AT_Pure;
+		else if(IsAttributeName(name, "const"))
+			attributes |= AT_Const;
+		else if(IsAttributeName(name, "noreturn"))
+			attributes |= AT_NoReturn;
+		else if(IsAttributeName(name, "aligned"))
+			attributes = MergeAttributes(attributes, ParseAlignedAttribute());
+		else if(IsAttributeName(name, "packed"))
+			attributes = MergeAttributes(attributes, MakePackedAttribute(1));
+		else if(IsAttributeName(name, "reorder_fields"))
+			attributes |= AT_ReorderFields;
+		else
+			WarnM("Unknown attribute ignored!", Line);
+		// Skip the arguments of ignored attributes
+		if(PeekToken()->type == T_OpenParen){
+			int depth = 0;
+			do {
+				tok = GetTransientToken();
+				if(tok == NULL)							FatalM("Unexpected EOF in attribute!", Line);
+				if(tok->type == T_OpenParen)			depth++;
+				else if(tok->type == T_CloseParen)		depth--;
+			} while(depth);
+		}
+		if(PeekToken()->type == T_Comma)
+			SkipToken();
+		else if(PeekToken()->type != T_CloseParen)
+			FatalM("Expected comma ',' or close parenthesis ')' in attribute list!", Line);
+	}
+	SkipToken();
+	if(GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis ')' after attribute list!", Line);
+	return attributes;
+}
+
+/// @brief Parse any function specifiers and attribute specifiers.
+static Attribute ParseAttributes(){
+	Attribute attributes = AT_None;
+	while(true){
+		switch(PeekToken()->type){
+			case T_Inline:
+				SkipToken();
+				attributes |= AT_Inline;
+				break;
+			case T_Attribute:
+				SkipToken();
+				if(GetTransientToken()->type != T_OpenParen || GetTransientToken()->type != T_OpenParen)
+					FatalM("Expected double open parenthesis '((' after __attribute__!", Line);
+				attributes = MergeAttributes(attributes, ParseAttributeList());
+				break;
+			default:
+				if((attributes & AT_AlwaysInline) && (attributes & AT_NoInline))
+					FatalM("A function can't be both always_inline and noinline!", Line);
+				if((attributes & AT_Hot) && (attributes & AT_Cold))
+					FatalM("A function can't be both hot and cold!", Line);
+				return attributes;
+		}
+	}
+}
+
+/// @brief Parse a type specifier.
+/// @param sc [OUT] Storage class, or NULL if storage classes are not permitted.
+/// @param qualifiers [OUT] Qualifiers of the declared object itself, or NULL to discard them.
+/// @param attributes [OUT] Function specifiers and attributes, or NULL if they are not permitted.
+static PrimordialType ParseType(StorageClass* sc, TypeQualifier* qualifiers, Attribute* attributes){
 	PrimordialType type;
+	TypeQualifier quals = ParseQualifiers();
+	Attribute attrs = ParseAttributes();
+	quals |= ParseQualifiers();
 	Token* tok = PeekToken();
 	bool isUnsigned = false;
 	// If SC is NULL, then storage classes are not supported; Parsing should be skipped in order to force a fail later on.
 	if(sc != NULL){
+		// Thread-local may come before or after static or extern
+		bool threadLocal = tok->type == T_ThreadLocal;
+		if(threadLocal){
+			SkipToken();
+			tok = PeekToken();
+		}
 		switch(tok->type){
 			case T_Static:	SkipToken(); *sc = C_Static;	break;
 			case T_Extern:	SkipToken();	*sc = C_Extern;	break;
 			default:		break;
 		}
+		if(PeekToken()->type == T_ThreadLocal){
+			if(threadLocal)		FatalM("Duplicate thread-local storage class!", Line);
+			SkipToken();
+			threadLocal = true;
+		}
+		if(threadLocal)
+			*sc |= C_ThreadLocal;
+		quals |= ParseQualifiers();
+		attrs = MergeAttributes(attrs, ParseAttributes());
+		quals |= ParseQualifiers();
 		tok = PeekToken();
 		switch(tok->type){
 			case T_Static:
-			case T_Extern:	FatalM("Cannot use more than one storage class!", Line);
+			case T_Extern:
+			case T_ThreadLocal:	FatalM("Cannot use more than one storage class!", Line);
 			default:		break;
 		}
 	}
@@ -44,6 +256,12 @@ static PrimordialType ParseType(StorageClass* sc){
 		tok = PeekToken();
 		isUnsigned = true;
 	}
+	if(qualifiers != NULL)
+		*qualifiers = quals;
+	if(attributes != NULL)
+		*attributes = attrs;
+	else if(attrs != AT_None)
+		FatalM("Function specifiers and attributes may only be used on functions!", Line);
 	switch(tok->type){
 		case T_Identifier:{
 			SymEntry* tdef = FindGlobal(tok->value.strVal, S_Typedef);
@@ -62,9 +280,16 @@ static PrimordialType ParseType(StorageClass* sc){
 				SkipToken();
 				type = P_LongLong;
 			}
+			// long double is treated as double
+			else if(PeekTokenN(1)->type == T_Double){
+				SkipToken();
+				type = P_Double;
+			}
 			else
 				type = P_Long;
 			break;
+		case T_Float:		type = P_Float;		break;
+		case T_Double:		type = P_Double;	break;
 		case T_Enum:
 		case T_Union:
 		case T_Struct:
@@ -72,14 +297,20 @@ static PrimordialType ParseType(StorageClass* sc){
 			return P_Composite;	// Structs must be parsed with ParseCompRef()
 		default:			return P_Undefined;
 	}
-	if(isUnsigned)
+	if(isUnsigned){
+		if(IsFloating(type))		FatalM("Unsigned is not valid for floating types!", Line);
 		type += P_UNSIGNED_DIFF;
+	}
 	SkipToken();
+	quals |= ParseQualifiers();
 	while(PeekToken()->type == T_Asterisk){
 		SkipToken();
 		if((type & 0xF) == 0xF)	FatalM("Indirection limit exceeded!", Line);
 		type++;
+		quals = ParseQualifiers();
 	}
+	if(qualifiers != NULL)
+		*qualifiers = quals;
 	return type;
 }
 
@@ -90,7 +321,7 @@ static PrimordialType PeekTypeN(int n){
 	for(int i = 0; i < n; i++)
 		if(ShiftToken() == NULL)
 			break;
-	PrimordialType t = ParseType(NULL);
+	PrimordialType t = ParseType(NULL, NULL, NULL);
 	fsetpos(fptr, fpos);
 	free(fpos);
 	Line = ln;
@@ -103,8 +334,9 @@ static PrimordialType PeekType(){
 
 /// @brief Parse a composite reference.
 /// @param type [OUT] Address of type; will be modified to account for pointers.
+/// @param qualifiers [IN/OUT] Qualifiers of the declared object, or NULL to discard them.
 /// @return A pointer to the struct definition.
-static SymEntry* ParseCompRef(PrimordialType* type){
+static SymEntry* ParseCompRef(PrimordialType* type, TypeQualifier* qualifiers){
 	Token* cTok = GetToken();
 	const char* id = "";
 	SymEntry* tdef = NULL;
@@ -130,16 +362,147 @@ static SymEntry* ParseCompRef(PrimordialType* type){
 			// Should never be able to hit this
 			FatalM("Expected typename!", Line);
 	}
+	TypeQualifier quals = ParseQualifiers();
+	if(qualifiers != NULL)
+		quals |= *qualifiers;
 	while(PeekToken()->type == T_Asterisk) {
 		SkipToken();
 		(*type)++;
+		quals = ParseQualifiers();
 	}
+	if(qualifiers != NULL)
+		*qualifiers = quals;
 	if(cTok->type == T_Enum)
 		return NULL;
 	SymEntry* cType = cTok->type == T_Identifier ? tdef->cType : FindStruct(id);
 	return cType;
 }
 
+/// @brief Resolve the file of an embed builtin, relative to the current source file if possible.
+/// @param size [OUT] The size of the file in bytes.
+static const char* ResolveEmbedPath(const char* path, long long* size){
+	const char* resolved = path;
+	int dirLength = strlen(curFile);
+	while(dirLength > 0 && curFile[dirLength - 1] != '/' && curFile[dirLength - 1] != '\\')
+		dirLength--;
+	FILE* file = NULL;
+	if(dirLength && path[0] != '/' && path[0] != '\\' && strchr(path, ':') == NULL){
+		resolved = sngenf(dirLength + strlen(path) + 1, "%.*s%s", dirLength, curFile, path);
+		file = fopen(resolved, "rb");
+	}
+	if(file == NULL){
+		resolved = path;
+		file = fopen(resolved, "rb");
+	}
+	if(file == NULL)								FatalM("Failed to open embedded file!", Line);
+	fseek(file, 0, SEEK_END);
+	*size = ftell(file);
+	fclose(file);
+	if(*size < 0)									FatalM("Failed to determine size of embedded file!", Line);
+	return resolved;
+}
+
+/// @brief Check the arguments of an atomic built-in function, and reduce its memory order to a literal.
+/// The object operated on is addressed by the first argument, and may be an integer or pointer of 1, 4 or 8 bytes.
+/// @return The type of the value of the call.
+static PrimordialType CheckAtomicBuiltin(const char* id, ASTNodeList* params){
+	int count = 0;
+	if(streq(id, "thread_fence") || streq(id, "signal_fence"))
+		count = 1;
+	else if(streq(id, "load"))
+		count = 2;
+	else if(streq(id, "store") || streq(id, "exchange") || streq(id, "fetch_add") || streq(id, "fetch_or"))
+		count = 3;
+	else if(streq(id, "compare_exchange"))
+		count = 4;
+	else
+		FatalM("Unknown atomic built-in function!", Line);
+	if(params->count != count)							FatalM("Wrong number of arguments to atomic built-in function!", Line);
+	long long order = 0;
+	if(!EvaluateConstant(params->nodes[count - 1], &order) || order < MO_Relaxed || order > MO_SeqCst)
+		FatalM("Expected a memory order constant in atomic built-in function!", Line);
+	params->nodes[count - 1] = MakeASTLeaf(A_LitInt, P_Int, FlexInt(order));
+	if(count == 1)
+		return P_Void;
+	PrimordialType pointer = params->nodes[0]->type;
+	if(!IsPointer(pointer))								FatalM("Expected a pointer to the object of atomic built-in function!", Line);
+	PrimordialType type = pointer - 1;
+	bool arithmetic = streq(id, "fetch_add") || streq(id, "fetch_or");
+	if(IsPointer(type) ? arithmetic : !IsArithmetic(type) || IsFloating(type) || GetPrimSize(type) == 2)
+		FatalM("Unsupported object type in atomic built-in function!", Line);
+	if(count == 2)
+		return type;
+	if(count == 4 && params->nodes[1]->type != pointer)	FatalM("Expected value of atomic compare exchange must point to the object's type!", Line);
+	ASTNode** operand = &params->nodes[count - 2];
+	if(CheckTypeCompatibility(type, (*operand)->type) == TYPES_INCOMPATIBLE)
+		FatalM("Incompatible operand in atomic built-in function!", Line);
+	*operand = ConvertFloating(*operand, type);
+	if(count == 4)
+		return P_Int;
+	return streq(id, "store") ? P_Void : type;
+}
+
+/// @brief Check the arguments of a bit manipulation or hint built-in function.
+/// Bits are counted in the width of the operand, which is 32 bits unless it is 64 bits wide; It's rotated in its own width.
+/// The optional access and locality of prefetch are reduced to literals.
+/// @param cType [OUT] The composite type of the value of the call.
+/// @return The type of the value of the call.
+static PrimordialType CheckIntrinsicBuiltin(const char* id, ASTNodeList* params, SymEntry** cType){
+	int count = 1;
+	if(streq(id, "unreachable"))
+		count = 0;
+	else if(streq(id, "expect") || streq(id, "assume_aligned") || streq(id, "rotl") || streq(id, "rotr"))
+		count = 2;
+	else if(streq(id, "prefetch")){
+		if(params->count < 1 || params->count > 3)	FatalM("Wrong number of arguments to built-in function!", Line);
+		if(!IsPointer(params->nodes[0]->type))		FatalM("Expected an address to prefetch!", Line);
+		// Omitted, the access is a read of data with high temporal locality
+		for(int i = 1; i < 3; i++){
+			long long value = i == 1 ? 0 : 3;
+			if(i < params->count && (!EvaluateConstant(params->nodes[i], &value) || value < 0 || value > (i == 1 ? 1 : 3)))
+				FatalM("Expected a constant access and locality in prefetch!", Line);
+			ASTNode* literal = MakeASTLeaf(A_LitInt, P_Int, FlexInt(value));
+			if(i < params->count)
+				params->nodes[i] = literal;
+			else
+				AddNodeToASTList(params, literal);
+		}
+		return P_Void;
+	}
+	else if(streq(id, "alloca") && !scope)
+		FatalM("Stack can only be allocated inside of a function!", Line);
+	else if(!streq(id, "alloca") && !streq(id, "popcount") && !streq(id, "clz") && !streq(id, "ctz") && !streq(id, "bswap16") && !streq(id, "bswap32") && !streq(id, "bswap64"))
+		FatalM("Unknown built-in function!", Line);
+	if(params->count != count)						FatalM("Wrong number of arguments to built-in function!", Line);
+	if(count == 0)
+		return P_Void;
+	ASTNode* operand = params->nodes[0];
+	if(streq(id, "expect")){
+		*cType = operand->cType;
+		return operand->type;
+	}
+	if(streq(id, "assume_aligned")){
+		long long alignment = 0;
+		if(!IsPointer(operand->type))				FatalM("Expected a pointer in assume_aligned!", Line);
+		if(!EvaluateConstant(params->nodes[1], &alignment) || alignment <= 0 || (alignment & (alignment - 1)))
+			FatalM("Expected a constant power of two alignment in assume_aligned!", Line);
+		*cType = operand->cType;
+		return operand->type;
+	}
+	for(int i = 0; i < count; i++)
+		if(!IsArithmetic(params->nodes[i]->type) || IsFloating(params->nodes[i]->type))
+			FatalM("Expected an integer operand in built-in function!", Line);
+	if(streq(id, "rotl") || streq(id, "rotr"))
+		return operand->type;
+	if(streq(id, "alloca"))
+		return P_Void + 1;
+	if(streq(id, "bswap32"))
+		return P_UInt;
+	if(streq(id, "bswap64"))
+		return P_ULongLong;
+	return P_Int;
+}
+
 static ASTNode* ParseFunctionCall(Token* tok){
 	SkipToken();
 	bool builtin = strbeg(tok->value.strVal, "__SCC_BUILTIN__");
@@ -168,7 +531,12 @@ static ASTNode* ParseFunctionCall(Token* tok){
 				int typeCheck = CheckTypeCompatibility(paramPrototype->type, expr->type);
 				if(typeCheck == TYPES_INCOMPATIBLE)		FatalM("Incompatible type in function call!", Line);
 				else if(typeCheck == TYPES_WIDEN_LHS)	WarnM("Truncating parameter in function call!", Line);
+				CheckCompositeConversion(paramPrototype->type, paramPrototype->cType, expr);
+				expr = ConvertFloating(expr, paramPrototype->type);
 			}
+			// Variadic float arguments are promoted to double
+			else if(expr->type == P_Float)
+				expr = ConvertFloating(expr, P_Double);
 			if(paramPrototype != NULL)
 				paramPrototype = paramPrototype->next;
 		}
@@ -187,8 +555,24 @@ static ASTNode* ParseFunctionCall(Token* tok){
 		type = func->type;
 		cType = func->cType;
 	}
+	ASTNode* size = NULL;
+	// The contents of the file are left to the assembler, only its size is needed here
+	if(builtin && streq(tok->value.strVal, "__SCC_BUILTIN__embed")){
+		if(params->count != 1 || params->nodes[0]->op != A_LitStr)	FatalM("Expected a file name string in embed!", Line);
+		long long length = 0;
+		params->nodes[0]->value.strVal = ResolveEmbedPath(params->nodes[0]->value.strVal, &length);
+		size = MakeASTLeaf(A_LitInt, P_Long, FlexInt(length));
+		type = P_Char + 1;
+	}
+	if(builtin && strbeg(tok->value.strVal, "__SCC_BUILTIN__atomic_"))
+		type = CheckAtomicBuiltin(tok->value.strVal + 22, params);
+	else if(builtin && !streq(tok->value.strVal, "__SCC_BUILTIN__embed") && !streq(tok->value.strVal, "__SCC_BUILTIN__va_start"))
+		type = CheckIntrinsicBuiltin(tok->value.strVal + 15, params, &cType);
 	NodeType op = builtin ? A_BuiltinCall : A_FunctionCall;
-	return MakeASTNodeEx(op, type, NULL, NULL, NULL, FlexStr(tok->value.strVal), FlexPtr(params), cType);
+	ASTNode* call = MakeASTNodeEx(op, type, NULL, size, NULL, FlexStr(tok->value.strVal), FlexPtr(params), cType);
+	if(func != NULL)
+		call->attributes = func->attributes;
+	return call;
 }
 
 static ASTNode* ParseVariableReference(Token* outerTok){
@@ -196,6 +580,25 @@ static ASTNode* ParseVariableReference(Token* outerTok){
 	if (varInfo == NULL)				return NULL;
 	PrimordialType type = varInfo == NULL ? P_Undefined : varInfo->type;
 	ASTNode* ref = MakeASTNode(A_VarRef, type, NULL, NULL, NULL, FlexStr(outerTok->value.strVal), varInfo->cType);
+	ref->symbol = varInfo;
+	ref->qualifiers = varInfo->qualifiers;
+	// Loads of const variables with a constant initializer are replaced by its value in the fold stage
+	if(varInfo->qualifiers & Q_Const)
+		ref->secondaryValue = FlexPtr(varInfo->init);
+	if(varInfo->length){
+		// Arrays decay to a pointer to their first element, which can't be assigned to
+		if((type & 0xF) == 0xF)		FatalM("Indirection limit exceeded!", Line);
+		ref->type = type + 1;
+		ref->lvalue = false;
+	}
+	// Thread-local variables have no fixed address, so they're accessed through the address computed for the current thread
+	else if(varInfo->sValue.intVal & C_ThreadLocal){
+		if((type & 0xF) == 0xF)		FatalM("Indirection limit exceeded!", Line);
+		ASTNode* address = MakeASTNode(A_AddressOf, type + 1, ref, NULL, NULL, FlexNULL(), varInfo->cType);
+		ASTNode* deref = MakeASTNode(A_Dereference, type, address, NULL, NULL, FlexNULL(), varInfo->cType);
+		deref->qualifiers = varInfo->qualifiers;
+		return deref;
+	}
 	return ref;
 }
 
@@ -244,6 +647,8 @@ static ASTNode* ParseBase(){
 			return MakeASTLeaf(A_LitInt, type, FlexInt(tok->value.intVal));
 		}
 		case T_LitStr:		return MakeASTLeaf(A_LitStr, P_Char + 1, tok->value);
+		case T_LitFloat:	return MakeASTLeaf(A_LitFloat, P_Float, tok->value);
+		case T_LitDouble:	return MakeASTLeaf(A_LitFloat, P_Double, tok->value);
 		default:	FatalM("Invalid Expression!", Line);
 	}
 }
@@ -252,12 +657,24 @@ static ASTNode* ParseArraySubscript(ASTNode* node){
 	SkipToken();
 	ASTNode* expr = ParseExpression();
 	if(GetTransientToken()->type != T_CloseBracket)	FatalM("Expected close bracket in array access!", Line);
-	ASTNode* scale = MakeASTBinary(A_Multiply, expr->type, expr, MakeASTLeaf(A_LitInt, P_Int, FlexInt(GetPrimSize(node->type - 1))), FlexNULL());
+	ASTNode* scale = MakeASTBinary(A_Multiply, expr->type, expr, MakeASTLeaf(A_LitInt, P_Int, FlexInt(GetTypeSize(node->type - 1, node->cType))), FlexNULL());
 	ASTNode* add = MakeASTBinary(A_Add, node->type - 1, node, scale, FlexNULL());
 	ASTNode* deref = MakeASTUnary(A_Dereference, add, FlexNULL(), node->cType);
+	// Elements of a const array are const; A const pointer may still point to modifiable objects
+	if(!node->lvalue)
+		deref->qualifiers = node->qualifiers;
 	return deref;
 }
 
+/// @brief Array members are not loaded; The address of the member is used as a pointer to its first element.
+static ASTNode* DecayArrayMember(ASTNode* address, SymEntry* member, TypeQualifier qualifiers){
+	if((member->type & 0xF) == 0xF)	FatalM("Indirection limit exceeded!", Line);
+	address->type = member->type + 1;
+	address->cType = member->cType;
+	address->qualifiers = qualifiers;
+	return address;
+}
+
 static ASTNode* ParseValueAccessor(ASTNode* node){
 	SkipToken();
 	Token* idTok = GetTransientToken();
@@ -266,7 +683,14 @@ static ASTNode* ParseValueAccessor(ASTNode* node){
 	ASTNode* offset = MakeASTLeaf(A_LitInt, P_Int, FlexInt(member->value.intVal));
 	ASTNode* address = MakeASTUnary(A_AddressOf, node, FlexNULL(), NULL);
 	ASTNode* add = MakeASTBinary(A_Add, member->type, address, offset, FlexNULL());
-	return MakeASTUnary(A_Dereference, add, FlexNULL(), member->cType);
+	// Members of a const composite are const
+	if(member->length)
+		return DecayArrayMember(add, member, node->qualifiers);
+	ASTNode* deref = MakeASTUnary(A_Dereference, add, FlexNULL(), member->cType);
+	deref->qualifiers = node->qualifiers;
+	// Members of a composite returned or assigned by value aren't objects which can be assigned to
+	deref->lvalue = node->lvalue;
+	return deref;
 }
 
 static ASTNode* ParsePointerAccessor(ASTNode* node){
@@ -276,6 +700,8 @@ static ASTNode* ParsePointerAccessor(ASTNode* node){
 	SymEntry* member = GetMember(node->cType, idTok->value.strVal);
 	ASTNode* offset = MakeASTLeaf(A_LitInt, P_Int, FlexInt(member->value.intVal));
 	ASTNode* add = MakeASTBinary(A_Add, member->type, node, offset, FlexNULL());
+	if(member->length)
+		return DecayArrayMember(add, member, Q_None);
 	return MakeASTUnary(A_Dereference, add, FlexNULL(), member->cType);
 }
 
@@ -284,6 +710,7 @@ static ASTNode* ParsePost(ASTNode* node){
 	switch(tok->type){
 		case T_PlusPlus:{
 			if(!node->lvalue)				FatalM("The increment postfix operator may only be preceded by an lvalue!", Line);
+			if(node->qualifiers & Q_Const)	FatalM("The increment postfix operator may not be used on a const-qualified object!", Line);
 			if(node->type == P_Composite)	FatalM("The increment postfix operator may not be used on composite types!", Line);
 			SkipToken();
 			int size = 0;
@@ -292,10 +719,16 @@ static ASTNode* ParsePost(ASTNode* node){
 				size = GetTypeSize(node->type - 1, node->cType);
 				rhs = MakeASTBinary(A_AssignSum, node->type, node, MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(size)), FlexNULL());
 			}
+			// Floating objects are stepped by a compound assignment of one
+			else if(IsFloating(node->type)){
+				size = 1;
+				rhs = MakeASTBinary(A_AssignSum, node->type, node, MakeASTLeaf(A_LitFloat, node->type, FlexStr("1")), FlexNULL());
+			}
 			return MakeASTNodeEx(A_Increment, node->type, node, NULL, rhs, FlexNULL(), FlexInt(size), NULL);
 		}
 		case T_MinusMinus:{
 			if(!node->lvalue)				FatalM("The decrement postfix operator may only be preceded by an lvalue!", Line);
+			if(node->qualifiers & Q_Const)	FatalM("The decrement postfix operator may not be used on a const-qualified object!", Line);
 			if(node->type == P_Composite)	FatalM("The decrement postfix operator may not be used on composite types!", Line);
 			SkipToken();
 			int size = 0;
@@ -304,21 +737,24 @@ static ASTNode* ParsePost(ASTNode* node){
 				size = GetTypeSize(node->type - 1, node->cType);
 				rhs = MakeASTBinary(A_AssignDifference, node->type, node, MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(size)), FlexNULL());
 			}
+			// Floating objects are stepped by a compound assignment of one
+			else if(IsFloating(node->type)){
+				size = 1;
+				rhs = MakeASTBinary(A_AssignDifference, node->type, node, MakeASTLeaf(A_LitFloat, node->type, FlexStr("1")), FlexNULL());
+			}
 			return MakeASTNodeEx(A_Decrement, node->type, node, NULL, rhs, FlexNULL(), FlexInt(size), NULL);
 		}
 		case T_OpenParen:
 			return NULL; // Function calls are currently only handled alongside identifiers. Function pointers are not yet supported.
 		case T_OpenBracket:
-			if(!node->lvalue)				FatalM("The array accessor operator may only be preceded by an lvalue!", Line);
+			if(!IsPointer(node->type))		FatalM("The array accessor operator may only be used on pointers and arrays!", Line);
 			return ParseArraySubscript(node);
 		case T_Period:
-			if(!node->lvalue)				FatalM("The member accessor may only be preceded by an lvalue!", Line);
 			if(node->type != P_Composite)	FatalM("The member accessor may only be used on a composite!", Line);
 			if(node->type & 0x0F)			FatalM("The member accessor may not be used on a pointer!", Line);
 			if(node->cType == NULL)			FatalM("Can only access members of a composite!", Line);
 			return ParseValueAccessor(node);
 		case T_Arrow:
-			if(!node->lvalue)						FatalM("The dereferencing member accessor may only be preceded by an lvalue!", Line);
 			if(!(node->type & 0x0F))				FatalM("The dereferencing member accessor may only be used on a pointer!", Line);
 			if((node->type & 0xF0) != P_Composite)	FatalM("The dereferencing member accessor may only be used on a composite pointer!", Line);
 			if(node->cType == NULL)					FatalM("Can only access members of a composite!", Line);
@@ -341,37 +777,15 @@ static ASTNode* ParsePrimary(){
 static ASTNode* ParseFactor(){
 	Token* tok = PeekToken();
 	switch(tok->type){
-		case T_Minus:{
-			SkipToken();
-			ASTNode* Factor = ParseFactor();
-			if(FOLD_INLINE && Factor->op == A_LitInt){
-				int val = -Factor->value.intVal;
-				free(Factor);
-				return MakeASTLeaf(A_LitInt, P_Int, FlexInt(val));
-			}
-			return MakeASTUnary(A_Negate, Factor,	FlexNULL(), NULL);
-		}
-		case T_Bang:{
-			SkipToken();
-			ASTNode* factor = ParseFactor();
-			if(FOLD_INLINE){
-				switch(factor->op){
-					case A_LitInt:
-						factor->value.intVal = !factor->value.intVal;
-						return factor;
-					case A_LogicalNot:	return MakeASTUnary(A_Logicize, factor->lhs, FlexNULL(), NULL);
-					case A_Logicize:	return MakeASTUnary(A_LogicalNot, factor->lhs, FlexNULL(), NULL);
-					default:			break;
-				}
-			}
-			return MakeASTUnary(A_LogicalNot, factor, FlexNULL(), NULL);
-		}
-		case T_Tilde:		SkipToken(); return MakeASTUnary(A_BitwiseComplement,	ParseFactor(),	FlexNULL(), NULL);
+		case T_Minus:		SkipToken(); return MakeFoldableUnary(A_Negate,				ParseFactor());
+		case T_Bang:		SkipToken(); return MakeFoldableUnary(A_LogicalNot,			MakeCondition(ParseFactor()));
+		case T_Tilde:		SkipToken(); return MakeFoldableUnary(A_BitwiseComplement,	RejectFloating(ParseFactor()));
 		case T_Semicolon:	return MakeASTLeaf(A_Undefined, P_Undefined, FlexNULL());
 		case T_PlusPlus:{
 			SkipToken();
 			ASTNode* node = ParseFactor();
 			if(!node->lvalue)				FatalM("The increment prefix operator '++' may only be used before an lvalue!", Line);
+			if(node->qualifiers & Q_Const)	FatalM("The increment prefix operator '++' may not be used on a const-qualified object!", Line);
 			if(node->type == P_Composite)	FatalM("Composite increments not supported!", Line);
 			int size = 0;
 			ASTNode* rhs = NULL;
@@ -379,12 +793,18 @@ static ASTNode* ParseFactor(){
 				size = GetTypeSize(node->type - 1, node->cType);
 				rhs = MakeASTBinary(A_AssignSum, node->type, node, MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(size)), FlexNULL());
 			}
+			// Floating objects are stepped by a compound assignment of one
+			else if(IsFloating(node->type)){
+				size = 1;
+				rhs = MakeASTBinary(A_AssignSum, node->type, node, MakeASTLeaf(A_LitFloat, node->type, FlexStr("1")), FlexNULL());
+			}
 			return MakeASTNodeEx(A_Increment, node->type, node, NULL, rhs, FlexInt(1), FlexInt(size), NULL);
 		}
 		case T_MinusMinus:{
 			SkipToken();
 			ASTNode* node = ParseFactor();
 			if(!node->lvalue)				FatalM("The decrement prefix operator '--' may only be used before an lvalue!", Line);
+			if(node->qualifiers & Q_Const)	FatalM("The decrement prefix operator '--' may not be used on a const-qualified object!", Line);
 			if(node->type == P_Composite)	FatalM("Composite decrements not supported!", Line);
 			int size = 0;
 			ASTNode* rhs = NULL;
@@ -392,6 +812,11 @@ static ASTNode* ParseFactor(){
 				size = GetTypeSize(node->type - 1, node->cType);
 				rhs = MakeASTBinary(A_AssignDifference, node->type, node, MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(size)), FlexNULL());
 			}
+			// Floating objects are stepped by a compound assignment of one
+			else if(IsFloating(node->type)){
+				size = 1;
+				rhs = MakeASTBinary(A_AssignDifference, node->type, node, MakeASTLeaf(A_LitFloat, node->type, FlexStr("1")), FlexNULL());
+			}
 			return MakeASTNodeEx(A_Decrement, node->type, node, NULL, rhs, FlexInt(1), FlexInt(size), NULL);
 		}
 		case T_Ampersand:{
@@ -403,6 +828,14 @@ static ASTNode* ParseFactor(){
 			if((t & 0xF) == 0xF)	FatalM("Indirection limit exceeded!", Line);
 			return MakeASTNode(A_AddressOf,		fctr->type + 1,	fctr,	NULL,	NULL,	FlexNULL(), fctr->cType);
 		}
+		case T_DoubleAmpersand:{
+			// The address of a label, as a GNU extension
+			SkipToken();
+			Token* label = GetTransientToken();
+			if(label->type != T_Identifier)	FatalM("Expected label after label address operator '&&'!", Line);
+			labelsUsed = MakeDbLnkList((void*)label->value.strVal, NULL, labelsUsed);
+			return MakeASTLeaf(A_LabelAddress, P_Void + 1, FlexStr(label->value.strVal));
+		}
 		case T_Asterisk:{
 			SkipToken();
 			ASTNode* fctr = ParseFactor();
@@ -424,13 +857,24 @@ static ASTNode* ParseFactor(){
 			if(type == P_Undefined){
 				ASTNode* expr = ParseExpression();
 				if(withParen && GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis after 'sizeof'!", Line);
-				return MakeASTLeaf(A_LitInt, P_Char, FlexInt(GetTypeSize(expr->type, expr->cType)));
+				int size = GetTypeSize(expr->type, expr->cType);
+				// Arrays have decayed to pointers by now, so their size must come from their declaration
+				if(expr->op == A_VarRef && expr->symbol->length < 0){
+					SymEntry* sizeVar = expr->symbol->value.ptrVal;
+					ASTNode* ref = MakeASTLeaf(A_VarRef, P_LongLong, FlexStr(sizeVar->key));
+					ref->symbol = sizeVar;
+					return ref;
+				}
+				if(expr->op == A_VarRef && expr->symbol->length)
+					size = GetSymbolSize(expr->symbol);
+				return MakeASTLeaf(A_LitInt, size <= 255 ? P_Char : P_Int, FlexInt(size));
 			}
-			type = ParseType(NULL);
+			type = ParseType(NULL, NULL, NULL);
 			if(type == P_Undefined)					FatalM("Expected typename!", Line);
-			SymEntry* cType = (type == P_Composite) ? ParseCompRef(&type) : NULL;
+			SymEntry* cType = (type == P_Composite) ? ParseCompRef(&type, NULL) : NULL;
 			if(withParen && GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis after 'sizeof'!", Line);
-			return MakeASTLeaf(A_LitInt, P_Char, FlexInt(GetTypeSize(type, cType)));
+			int size = GetTypeSize(type, cType);
+			return MakeASTLeaf(A_LitInt, size <= 255 ? P_Char : P_Int, FlexInt(size));
 		}
 		case T_OpenParen:{
 			fpos_t* fpos = malloc(sizeof(fpos_t));
@@ -438,10 +882,10 @@ static ASTNode* ParseFactor(){
 			int ln = Line;
 			const char* file = curFile;
 			SkipToken();
-			PrimordialType type = ParseType(NULL);
+			PrimordialType type = ParseType(NULL, NULL, NULL);
 			bool failed = type == P_Undefined;
 			while(!failed){
-				SymEntry* cType = (type == P_Composite) ? ParseCompRef(&type) : NULL;
+				SymEntry* cType = (type == P_Composite) ? ParseCompRef(&type, NULL) : NULL;
 				if(GetTransientToken()->type != T_CloseParen) {	failed = true;	break; }
 				ASTNode* expr = ParseFactor();
 				if(expr == NULL)		FatalM("Got NULL instead of expression! (Internal @ parse.h)", __LINE__);
@@ -451,15 +895,12 @@ static ASTNode* ParseFactor(){
 					expr->cType = cType;
 					return expr;
 				}
-				if(expr->op == A_LitInt){
-					size_t maxValue = (~(size_t)0) >> 8 * (sizeof(size_t) - GetTypeSize(type, cType));
-					if((size_t)expr->value.intVal > maxValue)
-						expr->value.intVal &= maxValue;
-					expr->type = type;
-					expr->cType = cType;
-					return expr;
-				}
-				return MakeASTNode(A_Cast, type, expr, NULL, NULL, FlexNULL(), cType);
+				if(type != expr->type && (IsFloating(type) || IsFloating(expr->type)))
+					return ConvertFloating(expr, type);
+				ASTNode* cast = MakeASTNode(A_Cast, type, expr, NULL, NULL, FlexNULL(), cType);
+				if(expr->op == A_LitInt)
+					return FoldNode(cast);
+				return cast;
 			}
 			if(failed){
 				curFile = file;
@@ -479,65 +920,13 @@ static ASTNode* ParseTerm(){
 	while(tok->type == T_Asterisk || tok->type == T_Divide || tok->type == T_Percent){
 		SkipToken();
 		ASTNode* rhs = ParseFactor();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		PrimordialType type = ConvertFloatingOperands(&lhs, &rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
 		switch (tok->type){
-			case T_Asterisk:
-				if(FOLD_INLINE){
-					if(lhs->op == A_LitInt && lhs->value.intVal == 0){
-						lhs = MakeASTLeaf(A_LitInt, P_Char, FlexInt(0));
-						break;
-					}
-					if(rhs->op == A_LitInt && rhs->value.intVal == 0){
-						lhs = MakeASTLeaf(A_LitInt, P_Char, FlexInt(0));
-						break;
-					}
-					if(lhs->op == A_LitInt && lhs->value.intVal == 1){
-						lhs = rhs;
-						break;
-					}
-					if(rhs->op == A_LitInt && rhs->value.intVal == 1)
-						break;
-					if(lhs->op == A_LitInt && rhs->op == A_LitInt){
-						lhs->value.intVal *= rhs->value.intVal;
-						break;
-					}
-				}
-				lhs = MakeASTBinary(A_Multiply,	type, lhs, rhs, FlexNULL());
-				break;
-			case T_Divide:
-				if(FOLD_INLINE){
-					if(lhs->op == A_LitInt && lhs->value.intVal == 0){
-						lhs = MakeASTLeaf(A_LitInt, P_Char, FlexInt(0));
-						break;
-					}
-					if(rhs->op == A_LitInt && rhs->value.intVal == 1)
-						break;
-					if(lhs->op == A_LitInt && rhs->op == A_LitInt){
-						lhs->value.intVal /= rhs->value.intVal;
-						break;
-					}
-				}
-				lhs = MakeASTBinary(A_Divide,	type, lhs, rhs, FlexNULL());
-				break;
-			case T_Percent:
-				if(FOLD_INLINE){
-					if(lhs->op == A_LitInt && lhs->value.intVal == 0){
-						lhs = MakeASTLeaf(A_LitInt, P_Char, FlexInt(0));
-						break;
-					}
-					if(rhs->op == A_LitInt && rhs->value.intVal == 1){
-						lhs = MakeASTLeaf(A_LitInt, P_Char, FlexInt(0));
-						break;
-					}
-					if(lhs->op == A_LitInt && rhs->op == A_LitInt){
-						lhs->value.intVal %= rhs->value.intVal;
-						break;
-					}
-				}
-				lhs = MakeASTBinary(A_Modulo,	type, lhs, rhs, FlexNULL());
-				break;
+			case T_Asterisk:	lhs = MakeFoldableBinary(A_Multiply,	type, lhs, rhs);	break;
+			case T_Divide:		lhs = MakeFoldableBinary(A_Divide,		type, lhs, rhs);	break;
+			case T_Percent:		lhs = MakeFoldableBinary(A_Modulo,		type, RejectFloating(lhs), rhs);	break;
 		}
 		tok = PeekToken();
 	}
@@ -550,50 +939,31 @@ static ASTNode* ParseAdditiveExpression(){
 	while(tok->type == T_Plus || tok->type == T_Minus){
 		SkipToken();
 		ASTNode* rhs = ParseTerm();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		PrimordialType type = ConvertFloatingOperands(&lhs, &rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
 		bool lhsIsPtr = IsPointer(lhs->type);
 		bool rhsIsPtr = IsPointer(rhs->type);
+		SymEntry* cType = lhs->cType;
 		if(lhsIsPtr && !rhsIsPtr)
-			rhs = ScaleNode(rhs, lhs->type);
-		else if(rhsIsPtr && !lhsIsPtr)
-			lhs = ScaleNode(lhs, rhs->type);
+			rhs = ScaleNode(rhs, lhs->type, lhs->cType);
+		else if(rhsIsPtr && !lhsIsPtr){
+			cType = rhs->cType;
+			lhs = ScaleNode(lhs, rhs->type, rhs->cType);
+		}
 		switch (tok->type){
 			case T_Plus:
-				if(FOLD_INLINE){
-					if(lhs->op == A_LitInt && lhs->value.intVal == 0){
-						lhs = rhs;
-						break;
-					}
-					if(rhs->op == A_LitInt && rhs->value.intVal == 0)
-						break;
-					if(lhs->op == A_LitInt && rhs->op == A_LitInt){
-						lhs->value.intVal += rhs->value.intVal;
-						break;
-					}
-				}
-				lhs = MakeASTBinary(A_Add,		type, lhs, rhs, FlexNULL());
+				lhs = MakeFoldableBinary(A_Add,		type, lhs, rhs);
 				break;
 			case T_Minus:
-				if(FOLD_INLINE){
-					if(rhs->op == A_LitInt && rhs->value.intVal == 0){
-						if(lhsIsPtr && rhsIsPtr)
-							lhs = MakeASTBinary(A_Divide,	P_ULongLong, lhs,	MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(GetTypeSize(lhs->type - 1, lhs->cType))), FlexNULL());
-						break;
-					}
-					if(lhs->op == A_LitInt && rhs->op == A_LitInt){
-						lhs->value.intVal -= rhs->value.intVal;
-						if(lhsIsPtr && rhsIsPtr)
-							lhs = MakeASTBinary(A_Divide,	P_ULongLong, lhs,	MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(GetTypeSize(lhs->type - 1, lhs->cType))), FlexNULL());
-						break;
-					}
-				}
-				lhs = MakeASTBinary(A_Subtract,	type, lhs, rhs, FlexNULL());
+				lhs = MakeFoldableBinary(A_Subtract,	type, lhs, rhs);
 				if(lhsIsPtr && rhsIsPtr)
-					lhs = MakeASTBinary(A_Divide,			P_ULongLong, lhs,	MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(GetTypeSize(lhs->type - 1, lhs->cType))), FlexNULL());
+					lhs = MakeFoldableBinary(A_Divide,	P_ULongLong, lhs,	MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(GetTypeSize(type - 1, cType))));
 				break;
 		}
+		// Pointer arithmetic keeps the composite type of the pointer
+		if(IsPointer(lhs->type) && lhs->cType == NULL)
+			lhs->cType = cType;
 		tok = PeekToken();
 	}
 	return lhs;
@@ -604,13 +974,13 @@ static ASTNode* ParseBitShiftExpression(){
 	Token* tok = PeekToken();
 	while(tok->type == T_DoubleLess || tok->type == T_DoubleGreater){
 		SkipToken();
-		ASTNode* rhs = ParseAdditiveExpression();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		ASTNode* rhs = RejectFloating(ParseAdditiveExpression());
+		PrimordialType type = NodeWidestType(RejectFloating(lhs), rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
 		switch(tok->type){
-			case T_DoubleLess:		lhs = MakeASTBinary(A_LeftShift,	type, lhs, rhs, FlexNULL());	break;
-			case T_DoubleGreater:	lhs = MakeASTBinary(A_RightShift,	type, lhs, rhs, FlexNULL());	break;
+			case T_DoubleLess:		lhs = MakeFoldableBinary(A_LeftShift,	type, lhs, rhs);	break;
+			case T_DoubleGreater:	lhs = MakeFoldableBinary(A_RightShift,	type, lhs, rhs);	break;
 		}
 		tok = PeekToken();
 	}
@@ -623,14 +993,17 @@ static ASTNode* ParseRelationalExpression(){
 	while(tok->type == T_Less || tok->type == T_Greater || tok->type == T_LessEqual || tok->type == T_GreaterEqual){
 		SkipToken();
 		ASTNode* rhs = ParseBitShiftExpression();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		PrimordialType type = ConvertFloatingOperands(&lhs, &rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
+		// Comparisons of floating operands produce an int
+		if(IsFloating(type))
+			type = P_Int;
 		switch(tok->type){
-			case T_Less:			lhs = MakeASTBinary(A_LessThan,			type, lhs, rhs, FlexNULL());	break;
-			case T_Greater:			lhs = MakeASTBinary(A_GreaterThan,		type, lhs, rhs, FlexNULL());	break;
-			case T_LessEqual:		lhs = MakeASTBinary(A_LessOrEqual,		type, lhs, rhs, FlexNULL());	break;
-			case T_GreaterEqual:	lhs = MakeASTBinary(A_GreaterOrEqual,	type, lhs, rhs, FlexNULL());	break;
+			case T_Less:			lhs = MakeFoldableBinary(A_LessThan,			type, lhs, rhs);	break;
+			case T_Greater:			lhs = MakeFoldableBinary(A_GreaterThan,		type, lhs, rhs);	break;
+			case T_LessEqual:		lhs = MakeFoldableBinary(A_LessOrEqual,		type, lhs, rhs);	break;
+			case T_GreaterEqual:	lhs = MakeFoldableBinary(A_GreaterOrEqual,	type, lhs, rhs);	break;
 		}
 		tok = PeekToken();
 	}
@@ -643,12 +1016,14 @@ static ASTNode* ParseEqualityExpression(){
 	while(tok->type == T_DoubleEqual || tok->type == T_BangEqual){
 		SkipToken();
 		ASTNode* rhs = ParseRelationalExpression();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		PrimordialType type = ConvertFloatingOperands(&lhs, &rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
+		if(IsFloating(type))
+			type = P_Int;
 		switch(tok->type){
-			case T_DoubleEqual:		lhs = MakeASTBinary(A_EqualTo,		type, lhs, rhs, FlexNULL());	break;
-			case T_BangEqual:		lhs = MakeASTBinary(A_NotEqualTo,	type, lhs, rhs, FlexNULL());	break;
+			case T_DoubleEqual:		lhs = MakeFoldableBinary(A_EqualTo,		type, lhs, rhs);	break;
+			case T_BangEqual:		lhs = MakeFoldableBinary(A_NotEqualTo,	type, lhs, rhs);	break;
 		}
 		tok = PeekToken();
 	}
@@ -659,13 +1034,14 @@ static ASTNode* ParseRepeatingEqualityExpression(){
 	ASTNode* lhs = ParseEqualityExpression();
 	while(PeekToken()->type == T_EqualDoublePipe){
 		SkipToken();
-		ASTNode* rhs = ParseEqualityExpression();
+		ASTNode* rhs = RejectFloating(ParseEqualityExpression());
+		RejectFloating(lhs);
 		if(rhs->op != A_ExpressionList)
 			FatalM("The Repeating Short-Circuiting Logical OR Operator currently only supports an expression list as a right hand operand.", Line);
 		PrimordialType type = NodeWidestType(lhs, rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
-		lhs = MakeASTBinary(A_RepeatLogicalOr, type, lhs, rhs, FlexNULL());
+		lhs = MakeFoldableBinary(A_RepeatLogicalOr, type, lhs, rhs);
 	}
 	return lhs;
 }
@@ -675,11 +1051,11 @@ static ASTNode* ParseBitwiseAndExpression(){
 	Token* tok = PeekToken();
 	while(tok->type == T_Ampersand){
 		SkipToken();
-		ASTNode* rhs = ParseRepeatingEqualityExpression();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		ASTNode* rhs = RejectFloating(ParseRepeatingEqualityExpression());
+		PrimordialType type = NodeWidestType(RejectFloating(lhs), rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
-		lhs = MakeASTBinary(A_BitwiseAnd,	type, lhs, rhs, FlexNULL());
+		lhs = MakeFoldableBinary(A_BitwiseAnd,	type, lhs, rhs);
 		tok = PeekToken();
 	}
 	return lhs;
@@ -690,11 +1066,11 @@ static ASTNode* ParseBitwiseXorExpression(){
 	Token* tok = PeekToken();
 	while(tok->type == T_Caret){
 		SkipToken();
-		ASTNode* rhs = ParseBitwiseAndExpression();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		ASTNode* rhs = RejectFloating(ParseBitwiseAndExpression());
+		PrimordialType type = NodeWidestType(RejectFloating(lhs), rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
-		lhs = MakeASTBinary(A_BitwiseXor,	type, lhs, rhs, FlexNULL());
+		lhs = MakeFoldableBinary(A_BitwiseXor,	type, lhs, rhs);
 		tok = PeekToken();
 	}
 	return lhs;
@@ -705,11 +1081,11 @@ static ASTNode* ParseBitwiseOrExpression(){
 	Token* tok = PeekToken();
 	while(tok->type == T_Pipe){
 		SkipToken();
-		ASTNode* rhs = ParseBitwiseXorExpression();
-		PrimordialType type = NodeWidestType(lhs, rhs);
+		ASTNode* rhs = RejectFloating(ParseBitwiseXorExpression());
+		PrimordialType type = NodeWidestType(RejectFloating(lhs), rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
-		lhs = MakeASTBinary(A_BitwiseOr,	type, lhs, rhs, FlexNULL());
+		lhs = MakeFoldableBinary(A_BitwiseOr,	type, lhs, rhs);
 		tok = PeekToken();
 	}
 	return lhs;
@@ -720,11 +1096,12 @@ static ASTNode* ParseLogicalAndExpression(){
 	Token* tok = PeekToken();
 	while(tok->type == T_DoubleAmpersand){
 		SkipToken();
-		ASTNode* rhs = ParseBitwiseOrExpression();
+		ASTNode* rhs = MakeCondition(ParseBitwiseOrExpression());
+		lhs = MakeCondition(lhs);
 		PrimordialType type = NodeWidestType(lhs, rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
-		lhs = MakeASTBinary(A_LogicalAnd,	type, lhs, rhs, FlexNULL());
+		lhs = MakeFoldableBinary(A_LogicalAnd,	type, lhs, rhs);
 		tok = PeekToken();
 	}
 	return lhs;
@@ -735,11 +1112,12 @@ static ASTNode* ParseLogicalOrExpression(){
 	Token* tok = PeekToken();
 	while(tok->type == T_DoublePipe){
 		SkipToken();
-		ASTNode* rhs = ParseLogicalAndExpression();
+		ASTNode* rhs = MakeCondition(ParseLogicalAndExpression());
+		lhs = MakeCondition(lhs);
 		PrimordialType type = NodeWidestType(lhs, rhs);
 		if(type == P_Undefined)
 			FatalM("Types of expression members are incompatible!", Line);
-		lhs = MakeASTBinary(A_LogicalOr,	type, lhs, rhs, FlexNULL());
+		lhs = MakeFoldableBinary(A_LogicalOr,	type, lhs, rhs);
 		tok = PeekToken();
 	}
 	return lhs;
@@ -752,9 +1130,17 @@ static ASTNode* ParseConditionalExpression(){
 	ASTNode* then = PeekToken()->type == T_Colon ? NULL : ParseExpression();
 	if(GetTransientToken()->type != T_Colon)			FatalM("Expected colon ':' in conditional expression!", Line);
 	ASTNode* otherwise = ParseConditionalExpression();
-	PrimordialType type = GetWidestType((then != NULL ? then->type : condition->type), otherwise->type);
+	PrimordialType type = P_Undefined;
+	if(then != NULL){
+		condition = MakeCondition(condition);
+		type = ConvertFloatingOperands(&then, &otherwise);
+	}
+	else
+		type = GetWidestType(condition->type, otherwise->type);
 	if(type == P_Undefined)					FatalM("Types of expression members are incompatible!", Line);
-	return MakeASTNode(A_Ternary, type, condition, then, otherwise, FlexNULL(), NULL);
+	SymEntry* cType = then != NULL && then->cType != NULL ? then->cType : otherwise->cType;
+	ASTNode* ternary = MakeASTNode(A_Ternary, type, condition, then, otherwise, FlexNULL(), cType);
+	return FOLD_INLINE ? FoldNode(ternary) : ternary;
 }
 
 static ASTNode* ParseAssignmentExpression(){
@@ -776,6 +1162,7 @@ static ASTNode* ParseAssignmentExpression(){
 		case T_PipeEqual:			nt = A_AssignBitwiseOr;		break;
 		default:					return lhs;
 	}
+	if(lhs->qualifiers & Q_Const)			FatalM("Cannot assign to a const-qualified object!", Line);
 	SkipToken();
 	ASTNode* rhs = ParseExpression();
 	if(lhs == NULL)							FatalM("Expected expression!", Line);
@@ -785,12 +1172,34 @@ static ASTNode* ParseAssignmentExpression(){
 		case TYPES_WIDEN_LHS:		WarnM("Truncating right hand side of expression!", Line);
 		default:					type = lhs->type;
 	}
+	if(nt == A_Assign)
+		CheckCompositeConversion(lhs->type, lhs->cType, rhs);
 	if(IsPointer(lhs->type))
-		if(nt == A_AssignSum || nt == A_AssignDifference)	rhs = ScaleNode(rhs, lhs->type);
+		if(nt == A_AssignSum || nt == A_AssignDifference)	rhs = ScaleNode(rhs, lhs->type, lhs->cType);
 		else if(nt != A_Assign)								FatalM("Invalid operands to compound assignment!", Line);
+	if(nt != A_Assign && (IsFloating(lhs->type) || IsFloating(rhs->type))){
+		NodeType op = A_Undefined;
+		switch(nt){
+			case A_AssignSum:			op = A_Add;			break;
+			case A_AssignDifference:	op = A_Subtract;	break;
+			case A_AssignProduct:		op = A_Multiply;	break;
+			case A_AssignQuotient:		op = A_Divide;		break;
+			default:					FatalM("Floating operands are not valid for this operator!", Line);
+		}
+		// An integer variable is converted for the operation, and the result converted back
+		if(!IsFloating(lhs->type)){
+			if(lhs->op != A_VarRef)		FatalM("Compound assignment of a floating value to an integer is only supported on variables!", Line);
+			ASTNode* value = malloc(sizeof(ASTNode));
+			memcpy(value, lhs, sizeof(ASTNode));
+			ASTNode* result = MakeASTBinary(op, rhs->type, ConvertFloating(value, rhs->type), rhs, FlexNULL());
+			return MakeASTBinary(A_Assign, type, lhs, ConvertFloating(result, type), FlexNULL());
+		}
+	}
+	rhs = ConvertFloating(rhs, type);
 	// PrimordialType type = NodeWidestType(lhs, rhs);
 	// if(type == P_Undefined)					FatalM("Types of expression members are incompatible!", Line);
-	return MakeASTBinary(nt, type, lhs, rhs, FlexNULL());
+	// Assignments of composites evaluate to the assigned composite
+	return MakeASTNode(nt, type, lhs, NULL, rhs, FlexNULL(), type == P_Composite ? lhs->cType : NULL);
 }
 
 static ASTNode* ParseExpression(){
@@ -801,56 +1210,306 @@ static ASTNode* ParseReturnStatement(){
 	if(GetTransientToken()->type != T_Return)		FatalM("Invalid statement; Expected return.", Line);
 	ASTNode* expr = ParseExpression();
 	if(GetTransientToken()->type != T_Semicolon)		FatalM("Invalid statement; Expected semicolon.", Line);
+	if(expr->op != A_Undefined && returnType != P_Void)
+		expr = ConvertFloating(expr, returnType);
 	return MakeASTUnary(A_Return, expr, FlexNULL(), expr->cType);
 }
 
+/// @brief Parse the dimension of an array declarator, if present.
+/// @return A literal holding the element count, the expression computing it if it isn't constant, or NULL if the declarator is not an array.
+static ASTNode* ParseArrayDimension(){
+	if(PeekToken()->type != T_OpenBracket)				return NULL;
+	SkipToken();
+	// The size of an unsized array is taken from its initializer
+	if(PeekToken()->type == T_CloseBracket){
+		SkipToken();
+		return MakeASTLeaf(A_LitInt, P_Int, FlexInt(0));
+	}
+	long long length = 0;
+	ASTNode* expr = ParseExpression();
+	bool isConstant = EvaluateConstant(expr, &length);
+	// Locals may be variable-length arrays
+	if(!isConstant && !scope)							FatalM("Array size must be an integer constant expression!", Line);
+	if(!isConstant && (!IsArithmetic(expr->type) || IsFloating(expr->type)))
+		FatalM("Array size must have an integer type!", Line);
+	if(isConstant && length <= 0)						FatalM("Array size must be greater than zero!", Line);
+	if(GetTransientToken()->type != T_CloseBracket)		FatalM("Expected close bracket ']' in array declaration!", Line);
+	if(PeekToken()->type == T_OpenBracket)				FatalM("Multidimensional arrays not yet supported!", Line);
+	return isConstant ? MakeASTLeaf(A_LitInt, P_Int, FlexInt(length)) : expr;
+}
+
+/// @brief Add a field to an initializer, keeping fields ordered by offset.
+/// Any fields overlapping the new one were initialized earlier, and are overridden.
+static void AddInitField(ASTNodeList* fields, ASTNode* field){
+	long long start = field->value.intVal;
+	long long end = start + field->secondaryValue.intVal;
+	int count = 0;
+	for(int i = 0; i < fields->count; i++){
+		ASTNode* other = fields->nodes[i];
+		if(other->value.intVal < end && start < other->value.intVal + other->secondaryValue.intVal)
+			continue;
+		fields->nodes[count++] = other;
+	}
+	fields->count = count;
+	AddNodeToASTList(fields, field);
+	int i = fields->count - 1;
+	while(i > 0 && fields->nodes[i - 1]->value.intVal > start){
+		fields->nodes[i] = fields->nodes[i - 1];
+		i--;
+	}
+	fields->nodes[i] = field;
+}
+
+static void ExpectInitializerSeparator(){
+	if(PeekToken()->type == T_Comma)
+		SkipToken();
+	else if(PeekToken()->type != T_CloseBrace)
+		FatalM("Expected comma or close brace '}' in initializer!", Line);
+}
+
+/// @brief Parse the initializer of an object, flattening it into fields.
+/// @param length Element count if the object is an array, -1 if it is an unsized array, otherwise 0.
+/// @param offset Offset of the object from the start of the initialized variable.
+/// @return The number of elements initialized if the object is an array.
+static int ParseInitializerFields(ASTNodeList* fields, PrimordialType type, SymEntry* cType, int length, int offset){
+	int size = GetTypeSize(type, cType);
+	if(length){
+		// Character arrays may be initialized by the contents of a file, without tokenizing it
+		if((type == P_Char || type == P_UChar) && PeekToken()->type == T_Identifier && streq(PeekToken()->value.strVal, "__SCC_BUILTIN__embed")){
+			ASTNode* blob = ParseExpression();
+			if(blob->op != A_BuiltinCall)					FatalM("Expected embed as array initializer!", Line);
+			int blobLength = blob->mid->value.intVal;
+			if(length < 0)
+				length = blobLength;
+			if(blobLength > length)							FatalM("Embedded file is too large for array!", Line);
+			AddInitField(fields, MakeASTNodeEx(A_InitField, type, blob, NULL, NULL, FlexInt(offset), FlexInt(length), NULL));
+			return length;
+		}
+		// Character arrays may be initialized by a string literal
+		if((type == P_Char || type == P_UChar) && PeekToken()->type == T_LitStr){
+			ASTNode* str = MakeASTLeaf(A_LitStr, P_Char + 1, GetTransientToken()->value);
+			int strLength = GetStringLength(str->value.strVal);
+			if(length < 0)
+				length = strLength + 1;
+			if(strLength > length)							FatalM("Initializer string is too long for array!", Line);
+			AddInitField(fields, MakeASTNodeEx(A_InitField, type, str, NULL, NULL, FlexInt(offset), FlexInt(length), NULL));
+			return length;
+		}
+		if(GetTransientToken()->type != T_OpenBrace)		FatalM("Expected open brace '{' in array initializer!", Line);
+		int index = 0;
+		int count = 0;
+		while(PeekToken()->type != T_CloseBrace){
+			if(PeekToken()->type == T_OpenBracket){
+				SkipToken();
+				long long designator = 0;
+				if(!EvaluateConstant(ParseExpression(), &designator))	FatalM("Array designator must be an integer constant expression!", Line);
+				if(designator < 0)										FatalM("Array designator must not be negative!", Line);
+				if(GetTransientToken()->type != T_CloseBracket)			FatalM("Expected close bracket ']' in array designator!", Line);
+				if(GetTransientToken()->type != T_Equal)				FatalM("Expected equals '=' after array designator!", Line);
+				index = designator;
+			}
+			if(length > 0 && index >= length)				FatalM("Excess elements in array initializer!", Line);
+			ParseInitializerFields(fields, type, cType, 0, offset + index * size);
+			index++;
+			if(index > count)
+				count = index;
+			ExpectInitializerSeparator();
+		}
+		SkipToken();
+		return count;
+	}
+	if(type == P_Composite){
+		if(GetTransientToken()->type != T_OpenBrace)		FatalM("Expected open brace '{' in composite initializer!", Line);
+		SymEntry* member = cType->value.ptrVal;
+		bool isUnion = cType->isUnion;
+		while(PeekToken()->type != T_CloseBrace){
+			if(PeekToken()->type == T_Period){
+				SkipToken();
+				Token* tok = GetTransientToken();
+				if(tok->type != T_Identifier)				FatalM("Expected member name in designator!", Line);
+				member = GetMember(cType, tok->value.strVal);
+				if(GetTransientToken()->type != T_Equal)	FatalM("Expected equals '=' after member designator!", Line);
+			}
+			if(member == NULL)								FatalM("Excess elements in composite initializer!", Line);
+			ParseInitializerFields(fields, member->type, member->cType, member->length, offset + member->value.intVal);
+			member = isUnion ? NULL : member->sValue.ptrVal;
+			ExpectInitializerSeparator();
+		}
+		SkipToken();
+		return 0;
+	}
+	// Scalars may optionally be enclosed in braces
+	bool braced = PeekToken()->type == T_OpenBrace;
+	if(braced)
+		SkipToken();
+	ASTNode* expr = ParseExpression();
+	switch(CheckTypeCompatibility(type, expr->type)){
+		case TYPES_INCOMPATIBLE:	FatalM("Types incompatible in initializer!", Line);
+		case TYPES_WIDEN_LHS:		WarnM("Truncating initializer!", Line); break;
+		default:					break;
+	}
+	expr = ConvertFloating(FoldLiteralSign(expr), type);
+	long long value = 0;
+	if(EvaluateConstant(expr, &value))
+		expr = MakeASTLeaf(A_LitInt, type, FlexInt(NormalizeInt(value, size, IsUnsigned(type))));
+	if(braced){
+		if(PeekToken()->type == T_Comma)
+			SkipToken();
+		if(GetTransientToken()->type != T_CloseBrace)		FatalM("Expected close brace '}' after scalar initializer!", Line);
+	}
+	AddInitField(fields, MakeASTNodeEx(A_InitField, type, expr, NULL, NULL, FlexInt(offset), FlexInt(size), cType));
+	return 0;
+}
+
+/// @brief Parse a brace initializer, or a string literal initializing a character array.
+/// @param dimension [IN/OUT] Dimension of the array being initialized, if any. Set for unsized arrays.
+static ASTNode* ParseInitializer(PrimordialType type, SymEntry* cType, ASTNode* dimension){
+	ASTNodeList* fields = MakeASTNodeList();
+	int length = dimension == NULL ? 0 : dimension->value.intVal;
+	int count = ParseInitializerFields(fields, type, cType, length ? length : (dimension != NULL ? -1 : 0), 0);
+	if(dimension != NULL && !length)
+		dimension->value.intVal = length = count;
+	if(dimension != NULL && !length)						FatalM("Arrays must have at least one element!", Line);
+	int size = GetTypeSize(type, cType);
+	ASTNode* init = MakeASTList(A_Initializer, fields, FlexInt(length ? size * length : size));
+	init->type = type;
+	init->cType = cType;
+	return init;
+}
+
+/// @brief Declare a variable in the current scope, which may only be declared again if the earlier declaration is external.
+static SymEntry* DeclareVar(const char* id, PrimordialType type, SymEntry* cType, StorageClass sc, int length){
+	SymEntry* existing = FindLocalVar(id, scope);
+	if(existing != NULL && existing->sValue.intVal != C_Extern)	FatalM("Local variable redeclaration!", Line);
+	SymList* var = InsertVar(id, NULL, type, cType, sc, length, scope);
+	if(var == NULL)		FatalM("Failed to declare variable! (Internal @ parse.h)", __LINE__);
+	return var->item;
+}
+
 static ASTNode* ParseDeclaration(){
 	StorageClass sc = C_Default;
-	PrimordialType type = ParseType(&sc);
-	if(sc && scope)					FatalM("External locals not yet supported!", Line);
+	TypeQualifier quals = Q_None;
+	Attribute attrs = AT_None;
+	PrimordialType type = ParseType(&sc, &quals, &attrs);
+	if((sc & C_Extern) && scope)	FatalM("External locals not yet supported!", Line);
+	if(sc && scope && !(sc & C_Static))	FatalM("Thread-local locals must be static!", Line);
 	if(type == P_Undefined)			FatalM("Expected typename!", Line);
 	SymEntry* cType = NULL;
 	if((type & 0xF0) == P_Composite){
-		cType = ParseCompRef(&type);
+		cType = ParseCompRef(&type, &quals);
 		if(cType == NULL && (type & 0xF0) == P_Composite)
 			FatalM("Undefined composite!", Line);
 	}
 	Token* tok = GetTransientToken();
 	if(tok->type != T_Identifier)	FatalM("Expected identifier!", Line);
 	const char* id = tok->value.strVal;
-	InsertVar(id, NULL, type, cType, sc, scope);
+	ASTNode* dimension = ParseArrayDimension();
+	attrs = MergeAttributes(attrs, ParseAttributes());
+	if(attrs & ~AT_Aligned){
+		WarnM("Function attributes are ignored on variables!", Line);
+		attrs &= AT_Aligned;
+	}
+	// The frame pointer is only guaranteed to be aligned to 16 bytes
+	if(scope && !parsingMembers && GetExplicitAlignment(type, cType, attrs) > 16)
+		WarnM("Local variables can't be aligned beyond 16 bytes!", Line);
+	if(dimension != NULL && dimension->op != A_LitInt){
+		// The size of a variable-length array is computed in bytes as it's declared, and kept in a hidden variable for sizeof
+		if(sc != C_Default)								FatalM("Variable-length arrays can't be static or external!", Line);
+		if(PeekToken()->type == T_Equal)				FatalM("Variable-length arrays can't be initialized!", Line);
+		SymEntry* var = DeclareVar(id, type, cType, sc, -1);
+		var->qualifiers = quals;
+		var->attributes = attrs;
+		// The array's entry keeps the entry of the hidden variable, which sizeof refers to
+		var->value.ptrVal = InsertVar(VariableLengthSizeName(id), NULL, P_LongLong, NULL, C_Default, 0, scope)->item;
+		ASTNode* elementSize = MakeASTLeaf(A_LitInt, P_LongLong, FlexInt(GetTypeSize(type, cType)));
+		ASTNode* size = MakeASTBinary(A_Multiply, P_LongLong, dimension, elementSize, FlexNULL());
+		ASTNode* n = MakeASTNodeEx(A_Declare, type, NULL, size, NULL, FlexStr(id), FlexInt(sc), cType);
+		n->sClass = sc;
+		n->qualifiers = quals;
+		n->attributes = attrs;
+		n->symbol = var;
+		return n;
+	}
+	SymEntry* var = DeclareVar(id, type, cType, sc, dimension != NULL ? dimension->value.intVal : 0);
+	var->qualifiers = quals;
+	var->attributes = attrs;
 	if (PeekToken()->type != T_Equal){
-		ASTNode* n = MakeASTNodeEx(A_Declare, type, NULL, NULL, NULL, FlexStr(id), FlexInt(sc), cType);
+		if(dimension != NULL && !dimension->value.intVal)	FatalM("Unsized arrays must be initialized!", Line);
+		ASTNode* n = MakeASTNodeEx(A_Declare, type, NULL, dimension, NULL, FlexStr(id), FlexInt(sc), cType);
 		n->sClass = sc;
+		n->qualifiers = quals;
+		n->attributes = attrs;
+		n->symbol = var;
 		return n;
 	}
 	SkipToken();
-	ASTNode* expr = ParseExpression();
+	ASTNode* expr = NULL;
+	if(dimension != NULL || PeekToken()->type == T_OpenBrace){
+		ASTNode* init = ParseInitializer(type, cType, dimension);
+		if(dimension != NULL || type == P_Composite){
+			if(dimension != NULL)
+				var->length = dimension->value.intVal;
+			ASTNode* n = MakeASTNodeEx(A_Declare, type, init, dimension, NULL, FlexStr(id), FlexInt(sc), cType);
+			n->sClass = sc;
+			n->qualifiers = quals;
+			n->attributes = attrs;
+			n->symbol = var;
+			return n;
+		}
+		// A braced scalar initializer is just its expression
+		expr = init->list->nodes[0]->lhs;
+	}
+	else
+		expr = ParseExpression();
 	int typeCompat = CheckTypeCompatibility(type, expr->type);
 	switch(typeCompat){
 		case TYPES_INCOMPATIBLE:	FatalM("Types incompatible!", Line);
 		case TYPES_WIDEN_LHS:		WarnM("Truncating right hand side of declaration!", Line); break;
 		default:					break;
 	}
-	if(!scope){
-		if(expr->op != A_LitInt)	FatalM("Non-constant expression in global varibale declaration!", Line);
+	CheckCompositeConversion(type, cType, expr);
+	expr = ConvertFloating(FoldLiteralSign(expr), type);
+	long long value = 0;
+	bool isConstant = EvaluateConstant(expr, &value);
+	if(isConstant && (quals & Q_Const))
+		var->init = MakeASTLeaf(A_LitInt, expr->type, FlexInt(value));
+	// Static locals are initialized once, like globals
+	if(!scope || (sc & C_Static)){
+		// Pointers may also be initialized by address constants, which are resolved during generation
+		// Floating constants are converted by the assembler
+		if((!isConstant && IsPointer(type)) || expr->op == A_LitFloat){
+			ASTNode* n = MakeASTNodeEx(A_Declare, type, expr, NULL, NULL, FlexStr(id), FlexInt(sc), cType);
+			n->sClass = sc;
+			n->qualifiers = quals;
+			n->attributes = attrs;
+			n->symbol = var;
+			return n;
+		}
+		if(!isConstant)				FatalM("Non-constant expression in global varibale declaration!", Line);
+		expr = MakeASTLeaf(A_LitInt, expr->type, FlexInt(value));
 		int typeSize = GetTypeSize(type, cType);
 		if(typeSize < 8) // If expression result is too large to fit in variable, truncate it
 			if(expr->value.intVal >= ((long long)1 << (8 * typeSize)))
 				expr->value.intVal &= ((long long)1 << (8 * typeSize)) - 1;
 		ASTNode* n = MakeASTNodeEx(A_Declare, type, expr, NULL, NULL, FlexStr(id), FlexInt(sc), cType);
 		n->sClass = sc;
+		n->qualifiers = quals;
+		n->attributes = attrs;
+		n->symbol = var;
 		return n;
 	}
 	ASTNode* n = MakeASTNodeEx(A_Declare, type, expr, NULL, NULL, FlexStr(id), FlexInt(sc), cType);
 	n->sClass = sc;
+	n->qualifiers = quals;
+	n->attributes = attrs;
+	n->symbol = var;
 	return n;
 }
 
 static ASTNode* ParseIfStatement(){
 	if(GetTransientToken()->type != T_If)			FatalM("Expected 'if' to begin if statement!", Line);
 	if(GetTransientToken()->type != T_OpenParen)		FatalM("Expected open parenthesis '(' in if statement!", Line);
-	ASTNode* condition = ParseExpression();
+	ASTNode* condition = MakeCondition(ParseExpression());
 	if(GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis ')' in if statement!", Line);
 	ASTNode* then = ParseStatement();
 	if(PeekToken()->type != T_Else)
@@ -863,7 +1522,7 @@ static ASTNode* ParseIfStatement(){
 static ASTNode* ParseWhileLoop(){
 	if(GetTransientToken()->type != T_While)			FatalM("Expected 'while' to begin while loop!", Line);
 	if(GetTransientToken()->type != T_OpenParen)		FatalM("Expected open parenthesis '(' in while loop!", Line);
-	ASTNode* condition = ParseExpression();
+	ASTNode* condition = MakeCondition(ParseExpression());
 	if(GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis ')' in while loop!", Line);
 	loopDepth++;
 	ASTNode* stmt = ParseStatement();
@@ -878,7 +1537,7 @@ static ASTNode* ParseDoLoop(){
 	loopDepth--;
 	if(GetTransientToken()->type != T_While)			FatalM("Expected 'while' clause in do-while loop!", Line);
 	if(GetTransientToken()->type != T_OpenParen)		FatalM("Expected open parenthesis '(' in do-while loop!", Line);
-	ASTNode* condition = ParseExpression();
+	ASTNode* condition = MakeCondition(ParseExpression());
 	if(GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis ')' in do-while loop!", Line);
 	return MakeASTBinary(A_Do, P_Undefined, condition, stmt, FlexNULL());
 }
@@ -895,7 +1554,7 @@ static ASTNode* ParseForLoop(){
 		default:			initializer = ParseExpression();	break;
 	}
 	if(GetTransientToken()->type != T_Semicolon)	FatalM("Expected semicolon in for loop!", Line);
-	ASTNode* condition	= PeekToken()->type == T_Semicolon ? NULL : ParseExpression();
+	ASTNode* condition	= PeekToken()->type == T_Semicolon ? NULL : MakeCondition(ParseExpression());
 	if(GetTransientToken()->type != T_Semicolon)	FatalM("Expected semicolon in for loop!", Line);
 	ASTNode* modifier	= PeekToken()->type == T_CloseParen ? NULL : ParseExpression();
 	if(GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis ')' in for loop!", Line);
@@ -912,7 +1571,7 @@ static ASTNode* ParseSwitch(){
 	if(GetTransientToken()->type != T_OpenParen)		FatalM("Expected open parenthesis '(' in switch statement!", Line);
 	ASTNode* expr = ParseExpression();
 	int typeCompat = CheckTypeCompatibility(expr->type, P_Int);
-	if(typeCompat == TYPES_INCOMPATIBLE || typeCompat == TYPES_WIDEN_RHS)
+	if(typeCompat == TYPES_INCOMPATIBLE || typeCompat == TYPES_WIDEN_RHS || IsFloating(expr->type))
 		FatalM("Incompatible expression type in switch statement! Expression must be of integral type!", Line);
 	if(expr == NULL)						FatalM("Expected expression in switch statement!", Line);
 	if(GetTransientToken()->type != T_CloseParen)	FatalM("Expected close parenthesis ')' in switch statement!", Line);
@@ -926,9 +1585,10 @@ static ASTNode* ParseSwitch(){
 		switch(GetTransientToken()->type){
 			case T_Case:{
 				ASTNode* caseValExpr = ParseExpression();
-				if(caseValExpr->op != A_LitInt)				FatalM("Case condition must be a literal integer!", Line);
+				long long value = 0;
+				if(!EvaluateConstant(caseValExpr, &value))	FatalM("Case condition must be an integer constant expression!", Line);
 				caseValue = malloc(sizeof(int));
-				*caseValue = caseValExpr->value.intVal;
+				*caseValue = value;
 				op = A_Case;
 				for(int i = 0; i < cases->count; i++){
 					ASTNode* node = cases->nodes[i];
@@ -969,8 +1629,124 @@ static ASTNode* ParseSwitch(){
 	return switchNode;
 }
 
+/// @brief Parse adjacent string literals, which are concatenated.
+static char* ParseStringLiterals(const char* context){
+	if(PeekToken()->type != T_LitStr)
+		FatalM(context, Line);
+	char* str = calloc(1, sizeof(char));
+	while(PeekToken()->type == T_LitStr)
+		strapp(&str, GetTransientToken()->value.strVal);
+	return str;
+}
+
+/// @brief Parse the operands of one section of an asm statement, up to the next colon or close parenthesis.
+static void ParseAsmOperands(ASTNodeList* operands, bool outputs){
+	while(PeekToken()->type != T_Colon && PeekToken()->type != T_CloseParen){
+		const char* name = NULL;
+		if(PeekToken()->type == T_OpenBracket){
+			SkipToken();
+			Token* tok = GetTransientToken();
+			if(tok->type != T_Identifier)					FatalM("Expected operand name in asm operand!", Line);
+			name = tok->value.strVal;
+			if(GetTransientToken()->type != T_CloseBracket)	FatalM("Expected close bracket ']' after asm operand name!", Line);
+		}
+		const char* constraint = ParseStringLiterals("Expected constraint string in asm operand!");
+		if(GetTransientToken()->type != T_OpenParen)		FatalM("Expected open parenthesis '(' before asm operand!", Line);
+		ASTNode* expr = ParseExpression();
+		if(expr == NULL)									FatalM("Expected expression in asm operand!", Line);
+		if(GetTransientToken()->type != T_CloseParen)		FatalM("Expected close parenthesis ')' after asm operand!", Line);
+		bool writes = constraint[0] == '=' || constraint[0] == '+';
+		if(writes != outputs)
+			FatalM(outputs ? "Output operand constraints must begin with '=' or '+'!" : "Input operand constraints may not begin with '=' or '+'!", Line);
+		if((outputs || strchr(constraint, 'm') != NULL) && !expr->lvalue)
+			FatalM("Output and memory operands of asm statements must be lvalues!", Line);
+		long long value = 0;
+		if(strpbrk(constraint, "in") != NULL){
+			if(!EvaluateConstant(expr, &value))				FatalM("Immediate asm operands must be integer constant expressions!", Line);
+			expr = MakeASTLeaf(A_LitInt, expr->type, FlexInt(value));
+		}
+		ASTNode* operand = MakeASTNodeEx(A_AsmOperand, expr->type, expr, NULL, NULL, FlexStr(constraint), FlexStr(name), expr->cType);
+		AddNodeToASTList(operands, operand);
+		if(PeekToken()->type == T_Comma)
+			SkipToken();
+		else if(PeekToken()->type != T_Colon && PeekToken()->type != T_CloseParen)
+			FatalM("Expected comma ',' between asm operands!", Line);
+	}
+}
+
+/// @brief Parse a GNU-style asm statement: 'asm [volatile] ("template" [: outputs [: inputs [: clobbers]]]);'
+/// Every asm statement is treated as volatile, and is never removed or moved.
+static ASTNode* ParseAsmStatement(){
+	if(GetTransientToken()->type != T_Asm)				FatalM("Expected 'asm' keyword!", Line);
+	if(PeekToken()->type == T_Volatile)
+		SkipToken();
+	if(GetTransientToken()->type != T_OpenParen)		FatalM("Expected open parenthesis '(' after 'asm'!", Line);
+	const char* template = ParseStringLiterals("Expected template string in asm statement!");
+	ASTNodeList* operands = MakeASTNodeList();
+	ASTNodeList* clobbers = MakeASTNodeList();
+	int outputs = 0;
+	if(PeekToken()->type == T_Colon){
+		SkipToken();
+		ParseAsmOperands(operands, true);
+		outputs = operands->count;
+	}
+	if(PeekToken()->type == T_Colon){
+		SkipToken();
+		ParseAsmOperands(operands, false);
+	}
+	if(PeekToken()->type == T_Colon){
+		SkipToken();
+		while(PeekToken()->type == T_LitStr){
+			AddNodeToASTList(clobbers, MakeASTLeaf(A_LitStr, P_Char + 1, FlexStr(ParseStringLiterals("Expected clobber string!"))));
+			if(PeekToken()->type == T_Comma)
+				SkipToken();
+		}
+	}
+	if(GetTransientToken()->type != T_CloseParen)		FatalM("Expected close parenthesis ')' after asm statement!", Line);
+	if(GetTransientToken()->type != T_Semicolon)		FatalM("Expected semicolon after asm statement!", Line);
+	ASTNode* node = MakeASTList(A_Asm, operands, FlexStr(template));
+	node->secondaryValue = FlexInt(outputs);
+	node->mid = MakeASTList(A_Glue, clobbers, FlexNULL());
+	return node;
+}
+
+/// @brief Parse a goto statement, either to a label or, as a GNU extension, to the address a pointer holds.
+static ASTNode* ParseGotoStatement(){
+	if(GetTransientToken()->type != T_Goto)			FatalM("Expected 'goto' keyword!", Line);
+	ASTNode* node = NULL;
+	if(PeekToken()->type == T_Asterisk){
+		SkipToken();
+		ASTNode* target = ParseExpression();
+		if(target == NULL || !IsPointer(target->type))	FatalM("Computed goto requires a pointer!", Line);
+		node = MakeASTUnary(A_Goto, target, FlexNULL(), NULL);
+		node->type = P_Undefined;
+	}
+	else {
+		Token* label = GetTransientToken();
+		if(label->type != T_Identifier)					FatalM("Expected label after 'goto'!", Line);
+		labelsUsed = MakeDbLnkList((void*)label->value.strVal, NULL, labelsUsed);
+		node = MakeASTLeaf(A_Goto, P_Undefined, FlexStr(label->value.strVal));
+	}
+	if(GetTransientToken()->type != T_Semicolon)		FatalM("Expected semicolon after goto statement!", Line);
+	return node;
+}
+
+/// @brief Parse a label, and the statement it labels, if the label doesn't end its block.
+static ASTNode* ParseLabel(){
+	Token* tok = GetTransientToken();
+	if(tok->type != T_Identifier)						FatalM("Expected label!", Line);
+	const char* label = tok->value.strVal;
+	if(LabelListContains(labelsDefined, label))			FatalM("Label redefinition!", Line);
+	labelsDefined = MakeDbLnkList((void*)label, NULL, labelsDefined);
+	if(GetTransientToken()->type != T_Colon)			FatalM("Expected colon ':' after label!", Line);
+	ASTNode* stmt = PeekToken()->type == T_CloseBrace ? NULL : ParseStatement();
+	return MakeASTNode(A_Label, P_Undefined, stmt, NULL, NULL, FlexStr(label), NULL);
+}
+
 static ASTNode* ParseStatement(){
 	Token* tok = PeekToken();
+	if(tok->type == T_Identifier && PeekTokenN(1)->type == T_Colon)
+		return ParseLabel();
 	switch(tok->type){
 		case T_Return:		return ParseReturnStatement();
 		case T_OpenBrace:	return ParseBlock();
@@ -987,9 +1763,12 @@ static ASTNode* ParseStatement(){
 			SkipToken();
 			return MakeASTLeaf(A_Break, P_Undefined, FlexNULL());
 		case T_Switch:		return ParseSwitch();
+		case T_Asm:			return ParseAsmStatement();
+		case T_Goto:		return ParseGotoStatement();
 		default:			break;
 	}
-	ASTNode* expr = (PeekType() == P_Undefined) ? ParseExpression() : ParseDeclaration();
+	bool storageClass = tok->type == T_Static || tok->type == T_Extern || tok->type == T_ThreadLocal;
+	ASTNode* expr = (!storageClass && PeekType() == P_Undefined) ? ParseExpression() : ParseDeclaration();
 	if(GetTransientToken()->type != T_Semicolon)		FatalM("Expected semicolon!", Line);
 	return expr;
 }
@@ -1007,11 +1786,13 @@ static ASTNode* ParseBlock(){
 
 static ASTNode* ParseFunction(){
 	StorageClass sc = C_Default;
-	PrimordialType type = ParseType(&sc);
+	Attribute attributes = AT_None;
+	PrimordialType type = ParseType(&sc, NULL, &attributes);
 	if(type == P_Undefined)					FatalM("Invalid function declaration; Expected typename.", Line);
+	if(sc & C_ThreadLocal)					FatalM("Functions can't be thread-local!", Line);
 	SymEntry* cType = NULL;
 	if((type & 0xF0) == P_Composite){
-		cType = ParseCompRef(&type);
+		cType = ParseCompRef(&type, NULL);
 		if(cType == NULL && (type & 0xF0) == P_Composite)
 			FatalM("Undefined composite!", Line);
 	}
@@ -1030,11 +1811,12 @@ static ASTNode* ParseFunction(){
 			params = MakeParam("...", P_Void, NULL, params);
 			break;
 		}
-		PrimordialType paramType = ParseType(NULL);
+		TypeQualifier paramQuals = Q_None;
+		PrimordialType paramType = ParseType(NULL, &paramQuals, NULL);
 		if(paramType == P_Undefined)		FatalM("Invalid type in parameter list!", Line);
 		SymEntry* cType = NULL;
 		if(paramType == P_Composite){
-			cType = ParseCompRef(&paramType);
+			cType = ParseCompRef(&paramType, &paramQuals);
 			if(paramType == P_Composite){
 				int size = GetTypeSize(paramType, cType);
 				if(size > 8){
@@ -1044,36 +1826,62 @@ static ASTNode* ParseFunction(){
 		}
 		Token* t = GetToken();
 		if(t->type != T_Identifier)			FatalM("Expected identifier in parameter list!", Line);
+		// Array parameters are pointers; The dimension is ignored
+		if(PeekToken()->type == T_OpenBracket){
+			SkipToken();
+			if(PeekToken()->type != T_CloseBracket)
+				ParseExpression();
+			if(GetTransientToken()->type != T_CloseBracket)	FatalM("Expected close bracket ']' in parameter list!", Line);
+			if((paramType & 0xF) == 0xF)	FatalM("Indirection limit exceeded!", Line);
+			paramType++;
+		}
 		int charCount = strlen(t->value.strVal) + 1;
 		char* paramName = malloc(charCount * sizeof(char));
 		paramName = strncpy(paramName, t->value.strVal, charCount);
 		free(t);
 		params = MakeParam(paramName, paramType, cType, params);
+		params->qualifiers = paramQuals;
 	}
 	if(params != NULL)
 		while (params->prev != NULL)
 			params = params->prev;
 	if(GetTransientToken()->type != T_CloseParen)	FatalM("Invalid function declaration; Expected close parenthesis ')'.", Line);
-	InsertFunc(idStr, FlexPtr(params), type, cType);
+	attributes = MergeAttributes(attributes, ParseAttributes());
+	// Attributes given by earlier declarations apply to later ones
+	SymList* func = InsertFunc(idStr, FlexPtr(params), type, cType);
+	if(func != NULL)
+		attributes = func->item->attributes = MergeAttributes(func->item->attributes, attributes);
 	if(PeekToken()->type == T_Semicolon){
 		SkipToken();
 		ASTNode* n = MakeASTNodeEx(A_Function, type, NULL, NULL, NULL, FlexStr(idStr), FlexPtr(params), cType);
 		n->sClass = sc;
+		n->attributes = attributes;
 		return n;
 	}
 	EnterScope();
 	if(params != NULL){
 		Parameter* p = params;
 		do {
-			InsertVar(p->id, NULL, p->type, p->cType, sc, scope);
+			SymList* param = InsertVar(p->id, NULL, p->type, p->cType, C_Default, 0, scope);
+			if(param != NULL){
+				param->item->qualifiers = p->qualifiers;
+				p->symbol = param->item;
+			}
 			p = p->next;
 		} while( p != NULL);
 	}
 	if(PeekToken()->type != T_OpenBrace)	FatalM("Invalid function declaration; Expected open brace '{'.", Line);
+	labelsDefined = NULL;
+	labelsUsed = NULL;
+	returnType = type;
 	ASTNode* block = ParseBlock();
+	for(DbLnkList* label = labelsUsed; label != NULL; label = label->next)
+		if(!LabelListContains(labelsDefined, label->val))
+			FatalM("Use of undefined label!", Line);
 	ExitScope();
 	ASTNode* n = MakeASTNodeEx(A_Function, type, block, NULL, NULL, FlexStr(idStr), FlexPtr(params), cType);
 	n->sClass = sc;
+	n->attributes = attributes;
 	return n;
 }
 
@@ -1097,9 +1905,9 @@ static ASTNode* ParseEnumDeclaration(){
 		if(PeekToken()->type == T_Equal){
 			SkipToken();
 			ASTNode* expr = ParseExpression();
-			// TODO: Fold constant expressions
-			if(expr->op != A_LitInt)	FatalM("Only integer and character literals are supported at this time! (Internal @ parse.h)", __LINE__);
-			value = expr->value.intVal;
+			long long exprValue = 0;
+			if(!EvaluateConstant(expr, &exprValue))	FatalM("Enum value must be an integer constant expression!", Line);
+			value = exprValue;
 		}
 		if(NULL == InsertEnumValue(id, value))
 			FatalM("Failed to create enum value!", Line);
@@ -1135,6 +1943,7 @@ static ASTNode* ParseCompositeDeclaration(){
 	if(cTokType == T_Enum)	return ParseEnumDeclaration();
 	if(cTokType != T_Struct && cTokType != T_Union)
 		FatalM("Expected composite type!", Line);
+	Attribute attrs = ParseAttributes();
 	Token* tok = PeekToken();
 	// if(tok->type != T_Identifier)			FatalM("Anonymous composites not yet implemented!", Line);
 	const char* identifier = NULL;
@@ -1143,29 +1952,48 @@ static ASTNode* ParseCompositeDeclaration(){
 		SkipToken();
 	}
 	SymList* incomplete = cTokType == T_Struct
-		? InsertStruct(identifier,	NULL)
-		: InsertUnion(identifier,	NULL);
+		? InsertStruct(identifier,	NULL,	AT_None)
+		: InsertUnion(identifier,	NULL,	AT_None);
 	if(PeekToken()->type == T_Semicolon){
 		// incomplete type -- Never hit due to lookahead behaviour in ParseNode()
 		FatalM("Incomplete composite declarations not yet supported!", Line);
 	}
 	if(GetTransientToken()->type != T_OpenBrace)		FatalM("Expected open brace '{' in composite declaration!", Line);
 	ASTNodeList* memberNodes = MakeASTNodeList();
+	// Members are declared in a scope of their own, so they can't clash with variables or the members of other composites
+	bool outerMembers = parsingMembers;
+	parsingMembers = true;
+	EnterScope();
 	while(PeekToken()->type != T_CloseBrace){
 		ASTNode* decl = ParseDeclaration();
 		if(decl->lhs != NULL)				FatalM("Composite member initializers not yet supported!", Line);
+		if(IsVariableLengthArray(decl))		FatalM("Composite members can't be variable-length arrays!", Line);
 		AddNodeToASTList(memberNodes, decl);
 		if(GetTransientToken()->type != T_Semicolon)	FatalM("Expected semicolon following composite member declaration!", Line);
 	}
+	ExitScope();
+	parsingMembers = outerMembers;
 	if(GetTransientToken()->type != T_CloseBrace)		FatalM("Expected close brace '}' in composite declaration!", Line);
+	attrs = MergeAttributes(attrs, ParseAttributes());
+	if(attrs & ~(AT_Aligned | AT_Packed | AT_ReorderFields))
+		WarnM("Function attributes are ignored on composite types!", Line);
+	if((attrs & AT_ReorderFields) && cTokType == T_Union)
+		WarnM("The members of a union can't be reordered!", Line);
+	// Packing set by '#pragma pack' applies to the composites defined while it's in effect
+	if(packAlignment)
+		attrs = MergeAttributes(attrs, MakePackedAttribute(packAlignment));
 	SymList* list = cTokType == T_Struct
-		? UpdateStruct(incomplete,	identifier,	MakeCompMembers(memberNodes))
-		: UpdateUnion(incomplete,	identifier,	MakeCompMembers(memberNodes));
+		? UpdateStruct(incomplete,	identifier,	MakeCompMembers(memberNodes),	attrs)
+		: UpdateUnion(incomplete,	identifier,	MakeCompMembers(memberNodes),	attrs);
 	if(list == NULL)						FatalM("Failed to create composite definition! (In parse.h)", __LINE__);
+	if(DUMP_LAYOUT)
+		DumpCompositeLayout(list->item, cTokType == T_Union);
 	if(PeekToken()->type != T_Identifier){
 		if(sc != C_Default)								FatalM("External or static composite declarations must declare an instance!", Line);
 		if(GetTransientToken()->type != T_Semicolon)	FatalM("Expected semicolon after composite declaration!", Line);
-		return MakeASTList(A_StructDecl, memberNodes, FlexStr(identifier));
+		ASTNode* ret = MakeASTList(A_StructDecl, memberNodes, FlexStr(identifier));
+		ret->attributes = attrs;
+		return ret;
 	}
 	if(identifier != NULL){
 		while(!streq(list->item->key, identifier) && list->next != NULL)
@@ -1177,9 +2005,10 @@ static ASTNode* ParseCompositeDeclaration(){
 	ASTNode* varDecl = MakeASTLeaf(A_Declare, P_Composite, declName);
 	varDecl->cType = entry;
 	varDecl->sClass = sc;
-	InsertVar(declName.strVal, NULL, P_Composite, entry, C_Default, scope);
+	varDecl->symbol = DeclareVar(declName.strVal, P_Composite, entry, C_Default, 0);
 	if(GetTransientToken()->type != T_Semicolon)		FatalM("Expected semicolon after struct declaratioin!", Line);
 	ASTNode* ret = MakeASTList(A_StructDecl, memberNodes, FlexStr(identifier));
+	ret->attributes = attrs;
 	ret->lhs = varDecl;
 	return ret;
 }
@@ -1188,18 +2017,18 @@ static ASTNode* ParseTypedef(){
 	if(GetTransientToken()->type != T_Typedef)	FatalM("Expected 'typedef' keyword to begin typedef!", Line);
 	Token* advCTok = PeekToken();
 	Token* advITok = PeekTokenN(1);
-	PrimordialType type = ParseType(NULL);
+	PrimordialType type = ParseType(NULL, NULL, NULL);
 	SymEntry* cType = NULL;
 	bool advDecl = false;
 	if(type == P_Composite){
-		cType = ParseCompRef(&type);
+		cType = ParseCompRef(&type, NULL);
 		if(cType == NULL && advCTok->type != T_Enum){
 			if(advITok->type != T_Identifier)	FatalM("Expected identifier in advance declaration typedef!", Line);
 			advDecl = true;
 			SymList* list = NULL;
 			switch(advCTok->type){
-				case T_Union:	list = InsertUnion(advITok->value.strVal,	NULL);	break;
-				case T_Struct:	list = InsertStruct(advITok->value.strVal,	NULL);	break;
+				case T_Union:	list = InsertUnion(advITok->value.strVal,	NULL,	AT_None);	break;
+				case T_Struct:	list = InsertStruct(advITok->value.strVal,	NULL,	AT_None);	break;
 				default:		FatalM("Unexpected composite type! (Internal @ parse.h)", __LINE__);
 			}
 			if(list == NULL || list->item == NULL)
@@ -1227,8 +2056,18 @@ ASTNode* ParseNode(){
 	Token* tok = PeekTokenN(i);
 	if(tok->type == T_Typedef)
 		return ParseTypedef();
-	while(tok->type != T_OpenParen && tok->type != T_Equal && tok->type != T_Semicolon && tok->type != T_OpenBrace)
+	while(tok->type != T_OpenParen && tok->type != T_Equal && tok->type != T_Semicolon && tok->type != T_OpenBrace){
+		// The parentheses of an attribute specifier don't begin a parameter list
+		if(tok->type == T_Attribute){
+			int depth = 0;
+			do {
+				tok = PeekTokenN(++i);
+				if(tok->type == T_OpenParen)		depth++;
+				else if(tok->type == T_CloseParen)	depth--;
+			} while(depth);
+		}
 		tok = PeekTokenN(++i);
+	}
 	switch(tok->type){
 		case T_Equal:
 		case T_Semicolon:{
@@ -5,7 +5,10 @@
 #include "types.h"
 #include "symTable.h"
 
-#define CAPACITY 1000
+#define GLOBAL_CAPACITY 256	// Initial slots of each global namespace; Must be a power of two
+#define MEMBER_CAPACITY 8	// Initial slots of the member index of a composite; Must be a power of two
+#define LOCAL_CAPACITY 1024	// Buckets of the table of locals; Must be a power of two
+#define CACHE_LINE 64		// Bytes in a cache line, for reporting members which straddle two
 
 static SymList* MakeSymList(SymEntry* entry, SymList* next){
 	SymList* ret = malloc(sizeof(SymList));
@@ -19,6 +22,7 @@ static SymEntry* MakeSymEntry(const char* key, FlexibleValue value, StructuralTy
 	ret->key = key;
 	ret->value = value;
 	ret->sType = sType;
+	ret->attributes = AT_None;
 	return ret;
 }
 
@@ -28,17 +32,35 @@ static SymEntry* MakeTypedSymEntry(const char* key, PrimordialType type, SymEntr
 	ret->cType = cType;
 	ret->type = type;
 	ret->sType = sType;
+	ret->attributes = AT_None;
 	return ret;
 }
 
-static SymEntry* MakeVarEntry(const char* key, const char* val, PrimordialType type, SymEntry* cType, StorageClass sc){
+/// @brief Set where a variable is stored, or clear it if the location is NULL.
+static void SetLocation(SymEntry* entry, const Location* location){
+	if(location == NULL){
+		entry->location.kind = L_None;
+		entry->location.name = NULL;
+		entry->location.offset = 0;
+	}
+	else
+		memcpy(&entry->location, location, sizeof(Location));
+}
+
+static SymEntry* MakeVarEntry(const char* key, const Location* location, PrimordialType type, SymEntry* cType, StorageClass sc){
 	SymEntry* ret = malloc(sizeof(SymEntry));
 	ret->key = key;
-	ret->value.strVal = val;
+	ret->value.strVal = NULL;
+	SetLocation(ret, location);
 	ret->sValue.intVal = sc;
 	ret->type = type;
 	ret->sType = S_Variable;
 	ret->cType = cType;
+	ret->qualifiers = Q_None;
+	ret->init = NULL;
+	ret->length = 0;
+	ret->attributes = AT_None;
+	ret->scope = 0;
 	return ret;
 }
 
@@ -49,30 +71,129 @@ static SymEntry* MakeFuncEntry(const char* key, FlexibleValue val, PrimordialTyp
 	ret->type = type;
 	ret->sType = S_Function;
 	ret->cType = cType;
+	ret->attributes = AT_None;
 	return ret;
 }
 
-static SymEntry* MakeStructEntry(const char* name, SymEntry* members){
+static unsigned int hash_oaat(const char* key, int length);
+
+static SymbolTable* MakeSymbolTable(int capacity){
+	SymbolTable* table = malloc(sizeof(SymbolTable));
+	table->slots = calloc(capacity, sizeof(SymList*));
+	table->capacity = capacity;
+	table->count = 0;
+	return table;
+}
+
+/// @brief Find the slot holding a symbol, or the empty slot it would be added to.
+static SymList** FindSlot(SymbolTable* table, const char* key, StructuralType sType){
+	unsigned int mask = table->capacity - 1;
+	unsigned int i = hash_oaat(key, strlen(key)) & mask;
+	while(table->slots[i] != NULL){
+		SymEntry* entry = table->slots[i]->item;
+		if(entry->sType == sType && streq(entry->key, key))
+			break;
+		i = (i + 1) & mask;
+	}
+	return &table->slots[i];
+}
+
+static void GrowSymbolTable(SymbolTable* table){
+	SymList** slots = table->slots;
+	int capacity = table->capacity;
+	table->capacity *= 2;
+	table->slots = calloc(table->capacity, sizeof(SymList*));
+	for(int i = 0; i < capacity; i++){
+		if(slots[i] == NULL)
+			continue;
+		SymList** slot = FindSlot(table, slots[i]->item->key, slots[i]->item->sType);
+		*slot = slots[i];
+	}
+	free(slots);
+}
+
+/// @brief Add a symbol to the empty slot found for it, growing the table once it's more than three quarters full.
+static SymList* AddSymbol(SymbolTable* table, SymList** slot, SymEntry* entry){
+	SymList* list = MakeSymList(entry, NULL);
+	*slot = list;
+	table->count++;
+	if(table->count * 4 > table->capacity * 3)
+		GrowSymbolTable(table);
+	return list;
+}
+
+static void DestroySymbolTable(SymbolTable* table){
+	for(int i = 0; i < table->capacity; i++)
+		free(table->slots[i]);
+	free(table->slots);
+	free(table);
+}
+
+SymEntry* FindSymbol(SymbolTable* table, const char* key, StructuralType sType){
+	if(table == NULL)
+		return NULL;
+	SymList* list = *FindSlot(table, key, sType);
+	return list == NULL ? NULL : list->item;
+}
+
+/// @brief Index the members of a composite by name.
+static SymbolTable* IndexMembers(SymEntry* members){
+	if(members == NULL)
+		return NULL;
+	SymbolTable* index = MakeSymbolTable(MEMBER_CAPACITY);
+	for(SymEntry* pos = members; pos != NULL; pos = pos->sValue.ptrVal){
+		SymList** slot = FindSlot(index, pos->key, S_Member);
+		if(*slot != NULL)	FatalM("Duplicate composite member!", Line);
+		AddSymbol(index, slot, pos);
+	}
+	return index;
+}
+
+/// @brief Get the alignment of a member, which packing may lower unless the member requests it explicitly.
+/// @param packing Largest alignment permitted by the composite, or 0 if its members are naturally aligned.
+static int GetMemberAlignment(SymEntry* member, int packing){
+	int alignment = GetTypeAlignment(member->type, member->cType, AT_None);
+	int memberPacking = GetPackedAlignment(member->attributes);
+	if(memberPacking && (!packing || memberPacking < packing))
+		packing = memberPacking;
+	if(packing && alignment > packing)
+		alignment = packing;
+	int requested = GetAttributeAlignment(member->attributes);
+	return requested > alignment ? requested : alignment;
+}
+
+/// @brief Lay out the members of a struct at their alignment, padding its size to a multiple of the most strictly aligned.
+static SymEntry* MakeStructEntry(const char* name, SymEntry* members, Attribute attributes){
 	SymEntry* ret = malloc(1 * sizeof(SymEntry));
 	ret->key = name;
 	ret->value.ptrVal = members;
-	SymEntry* pos = members;
 	ret->sValue.intVal = 0;
-	while(pos != NULL){
-		pos->value.intVal = ret->sValue.intVal;
-		ret->sValue.intVal += GetTypeSize(pos->type, pos->cType);
-		pos = pos->sValue.ptrVal;
+	ret->attributes = attributes & (AT_Packed | AT_ReorderFields);
+	int packing = GetPackedAlignment(attributes);
+	int largest = 1;
+	for(SymEntry* pos = members; pos != NULL; pos = pos->sValue.ptrVal){
+		int alignment = GetMemberAlignment(pos, packing);
+		if(alignment > largest)
+			largest = alignment;
 	}
-	// int totalSize = 0;
-	// while(pos != NULL){
-	// 	int size = GetTypeSize(pos->type, pos->cType);
-	// 	if(totalSize % size)
-	// 		totalSize = align(totalSize, size);
-	// 	pos->value.intVal = totalSize;
-	// 	totalSize += size;
-	// 	pos = pos->sValue.ptrVal;
-	// }
-	// ret->sValue.intVal = totalSize;
+	// Reordered members are placed from the most to the least strictly aligned, which leaves no holes between them
+	int placing = attributes & AT_ReorderFields ? largest : 0;
+	do {
+		for(SymEntry* pos = members; pos != NULL; pos = pos->sValue.ptrVal){
+			int alignment = GetMemberAlignment(pos, packing);
+			if(placing && alignment != placing)
+				continue;
+			ret->sValue.intVal = align(ret->sValue.intVal, alignment);
+			pos->value.intVal = ret->sValue.intVal;
+			ret->sValue.intVal += GetSymbolSize(pos);
+		}
+		placing >>= 1;
+	} while(placing);
+	if(members != NULL)
+		ret->attributes = MergeAttributes(ret->attributes, MakeAlignedAttribute(largest));
+	AlignComposite(ret, attributes & AT_Aligned);
+	ret->members = IndexMembers(members);
+	ret->isUnion = false;
 	ret->type = P_Composite;
 	ret->sType = S_Composite;
 	ret->cType = NULL;
@@ -81,19 +202,30 @@ static SymEntry* MakeStructEntry(const char* name, SymEntry* members){
 	return ret;
 }
 
-static SymEntry* MakeUnionEntry(const char* name, SymEntry* members){
+static SymEntry* MakeUnionEntry(const char* name, SymEntry* members, Attribute attributes){
 	SymEntry* ret = malloc(1 * sizeof(SymEntry));
 	ret->key = name;
 	ret->value.ptrVal = members;
 	SymEntry* pos = members;
 	ret->sValue.intVal = 0;
+	ret->attributes = attributes & AT_Packed;
+	int packing = GetPackedAlignment(attributes);
+	int largest = 1;
 	while(pos != NULL){
 		pos->value.intVal = 0;
-		int size = GetTypeSize(pos->type, pos->cType);
+		int size = GetSymbolSize(pos);
 		if(ret->sValue.intVal < size)
 			ret->sValue.intVal = size;
+		int alignment = GetMemberAlignment(pos, packing);
+		if(alignment > largest)
+			largest = alignment;
 		pos = pos->sValue.ptrVal;
 	}
+	if(members != NULL)
+		ret->attributes = MergeAttributes(ret->attributes, MakeAlignedAttribute(largest));
+	AlignComposite(ret, attributes & AT_Aligned);
+	ret->members = IndexMembers(members);
+	ret->isUnion = true;
 	ret->type = P_Composite;
 	ret->sType = S_Composite;
 	ret->cType = NULL;
@@ -102,81 +234,156 @@ static SymEntry* MakeUnionEntry(const char* name, SymEntry* members){
 	return ret;
 }
 
-SymEntry* MakeCompMember(const char* name, SymEntry* next, PrimordialType type, SymEntry* cType){
+SymEntry* MakeCompMember(const char* name, SymEntry* next, PrimordialType type, SymEntry* cType, int length){
 	SymEntry* ret = malloc(sizeof(SymEntry));
 	ret->key = name;
 	ret->sValue.ptrVal = (void*)next;
 	ret->type = type;
 	ret->sType = S_Member;
 	ret->cType = cType;
+	ret->length = length;
+	ret->attributes = AT_None;
 	return ret;
 }
 
+/// @brief Apply attributes to a composite, rounding its size up to a multiple of its alignment.
+void AlignComposite(SymEntry* composite, Attribute attributes){
+	composite->attributes = MergeAttributes(composite->attributes, attributes);
+	int alignment = GetAttributeAlignment(composite->attributes);
+	if(alignment && composite->sValue.intVal > 0)
+		composite->sValue.intVal = align(composite->sValue.intVal, alignment);
+}
+
+/// @brief Print the offset and size of each member of a composite, the holes between them,
+/// and the members which straddle the boundary between two cache lines.
+void DumpCompositeLayout(SymEntry* composite, bool isUnion){
+	int size = composite->sValue.intVal;
+	const char* name = composite->key == NULL ? "<anonymous>" : composite->key;
+	printf("%s %s: %d bytes, aligned to %d, %d cache line(s)\n", isUnion ? "union" : "struct", name, size, GetAttributeAlignment(composite->attributes), (size + CACHE_LINE - 1) / CACHE_LINE);
+	printf("	offset	size	member\n");
+	int count = 0;
+	for(SymEntry* pos = composite->value.ptrVal; pos != NULL; pos = pos->sValue.ptrVal)
+		count++;
+	int position = 0;
+	int padding = 0;
+	int lastOffset = -1;
+	int lastIndex = -1;
+	// Members are listed by offset, as they may have been reordered
+	for(int i = 0; i < count; i++){
+		SymEntry* member = NULL;
+		int memberIndex = 0;
+		int index = 0;
+		for(SymEntry* pos = composite->value.ptrVal; pos != NULL; pos = pos->sValue.ptrVal){
+			int offset = pos->value.intVal;
+			bool after = offset > lastOffset || (offset == lastOffset && index > lastIndex);
+			if(after && (member == NULL || offset < member->value.intVal)){
+				member = pos;
+				memberIndex = index;
+			}
+			index++;
+		}
+		int offset = member->value.intVal;
+		int memberSize = GetSymbolSize(member);
+		if(offset > position){
+			printf("	%d	%d	(hole)\n", position, offset - position);
+			padding += offset - position;
+		}
+		bool crosses = memberSize <= CACHE_LINE && memberSize && offset / CACHE_LINE != (offset + memberSize - 1) / CACHE_LINE;
+		printf("	%d	%d	%s%s\n", offset, memberSize, member->key, crosses ? "	(crosses a cache line)" : "");
+		if(offset + memberSize > position)
+			position = offset + memberSize;
+		lastOffset = offset;
+		lastIndex = memberIndex;
+	}
+	if(size > position){
+		printf("	%d	%d	(tail padding)\n", position, size - position);
+		padding += size - position;
+	}
+	printf("	%d bytes of padding\n", padding);
+}
+
 SymEntry* MakeCompMembers(ASTNodeList* list){
 	SymEntry* members = NULL;
 	for(int i = list->count - 1; i >= 0; i--){
 		ASTNode* node = list->nodes[i];
-		members = MakeCompMember(node->value.strVal, members, node->type, node->cType);
+		int length = node->mid != NULL ? node->mid->value.intVal : 0;
+		members = MakeCompMember(node->value.strVal, members, node->type, node->cType, length);
+		members->attributes = node->attributes;
 	}
 	return members;
 }
 
-static SymList*** hashArray;
+static SymbolTable* ordinaryTable;	// Variables, functions, typedefs and enum values
+static SymbolTable* tagTable;		// Names of composites and enums
+static SymList** localTable;	// Locals of every open scope, where a declaration comes before those it shadows in its bucket
+static SymList** undoLog;		// Locals in order of declaration, removed from the table in reverse as their scopes end
+static int undoCount = 0;
+static int undoSize = 0;
+static int* scopeStart;			// Length of the undo log when each scope was entered
 static int* varCount;
 static int* stackSize;
 static int maxScope = 5;
 
 static void CreateScope(int scope){
 	while(maxScope <= scope){
-		hashArray	= realloc(hashArray,	(maxScope + 5) * sizeof(SymList**));
+		scopeStart	= realloc(scopeStart,	(maxScope + 5) * sizeof(int));
 		varCount	= realloc(varCount,		(maxScope + 5) * sizeof(int));
 		stackSize	= realloc(stackSize,	(maxScope + 5) * sizeof(int));
 		stackIndex	= realloc(stackIndex,	(maxScope + 5) * sizeof(int));
-		for(int i = 0; i < 5; i++){
-			hashArray[maxScope+i]	= NULL;
-			varCount[maxScope+i]	= 0;
-			stackSize[maxScope+i]	= 0;
-			stackIndex[maxScope+i]	= 0;
-		}
 		maxScope += 5;
 	}
-	hashArray[scope] = malloc(sizeof(SymList*) * CAPACITY);
+	scopeStart[scope] = undoCount;
+	varCount[scope] = 0;
+	stackSize[scope] = 0;
 	stackIndex[scope] = scope ? stackIndex[scope - 1] : 0;
-	for(int i = 0; i < CAPACITY; i++)
-		hashArray[scope][i] = NULL;
 }
 
 void InitVarTable(){
 	// Allocate with the assumption of a maximum scope depth of 5
-	hashArray	= malloc(sizeof(SymList**) * 5);
+	scopeStart	= malloc(sizeof(int) * 5);
 	varCount	= malloc(sizeof(int) * 5);
 	stackSize	= malloc(sizeof(int) * 5);
 	stackIndex	= malloc(sizeof(int) * 5);
-	for (int i = 0; i < 5; i++){
-		hashArray[i] = NULL;
-		varCount[i] = 0;
-		stackSize[i] = 0;
-		stackIndex[i] = 0;
-	}
+	ordinaryTable = MakeSymbolTable(GLOBAL_CAPACITY);
+	tagTable = MakeSymbolTable(GLOBAL_CAPACITY);
+	localTable = calloc(LOCAL_CAPACITY, sizeof(SymList*));
+	undoSize = 64;
+	undoLog = malloc(sizeof(SymList*) * undoSize);
+	undoCount = 0;
 	CreateScope(0);
-	for(int i = 0; i < CAPACITY; i++)
-		hashArray[0][i] = NULL;
 }
 
-void DestroyVarTable(int scope){
-	for(int i = 0; i < CAPACITY; i++)
-		free(hashArray[scope][i]);
-	free(hashArray[scope]);
-	hashArray[scope] = NULL;
+/// @brief Remove the locals declared since a scope was entered, uncovering any declarations they shadowed.
+static void UnwindScope(int scope){
+	while(undoCount > scopeStart[scope]){
+		SymList* entry = undoLog[--undoCount];
+		unsigned int hash = hash_oaat(entry->item->key, strlen(entry->item->key)) & (LOCAL_CAPACITY - 1);
+		localTable[hash] = entry->next;
+		free(entry);
+	}
 	varCount[scope] = 0;
 	stackSize[scope] = 0;
 }
 
+void DestroyVarTable(int scope){
+	if(scope){
+		UnwindScope(scope);
+		return;
+	}
+	UnwindScope(0);
+	DestroySymbolTable(ordinaryTable);
+	DestroySymbolTable(tagTable);
+	ordinaryTable = NULL;
+	tagTable = NULL;
+}
+
 void ResetVarTable(int scope) {
 	DestroyVarTable(scope);
+	if(!scope){
+		ordinaryTable = MakeSymbolTable(GLOBAL_CAPACITY);
+		tagTable = MakeSymbolTable(GLOBAL_CAPACITY);
+	}
 	CreateScope(scope);
-	for (int i = 0; i < CAPACITY; i++)
-		hashArray[scope][i] = NULL;
 }
 
 SymEntry* FindVar(const char* key, int scope);
@@ -197,186 +404,198 @@ static unsigned int hash_oaat(const char* key, int length){
 }
 int collisions = 0;
 
-static SymEntry* FindVarPosition(const char* key, int scope, bool strict){
-	if(hashArray[scope] == NULL)
-		return NULL;
-	unsigned int hash = hash_oaat(key, strlen(key)) % CAPACITY;
-	SymList* list = hashArray[scope][hash];
-	if (list == NULL)
-		if (scope < 1 || strict)	return NULL;
-		else		return FindVar(key, scope - 1);
-	while((list->item->sType != S_Variable || !streq(list->item->key, key)) && list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_Variable || !streq(list->item->key, key))
-		if(scope < 1 || strict)	return NULL;
-		else		return FindVar(key, scope - 1);
-	return list->item;
+/// @brief Tags of composites and enums are a separate namespace from ordinary identifiers.
+static SymbolTable* GetNamespace(StructuralType sType){
+	return sType == S_Composite || sType == S_EnumName ? tagTable : ordinaryTable;
+}
+
+static SymEntry* FindGlobalVar(const char* key){
+	return FindSymbol(ordinaryTable, key, S_Variable);
+}
+
+/// @brief Find the innermost declaration of a local visible from a scope.
+static SymList* FindLocalEntry(const char* key, int scope){
+	unsigned int hash = hash_oaat(key, strlen(key)) & (LOCAL_CAPACITY - 1);
+	for(SymList* list = localTable[hash]; list != NULL; list = list->next)
+		if(list->item->scope <= scope && streq(list->item->key, key))
+			return list;
+	return NULL;
 }
 
 SymEntry* FindVar(const char* key, int scope){
-	return FindVarPosition(key, scope, false);
+	if(scope){
+		SymList* local = FindLocalEntry(key, scope);
+		if(local != NULL)
+			return local->item;
+	}
+	return FindGlobalVar(key);
 }
 
 SymEntry* FindLocalVar(const char* key, int scope){
-	return FindVarPosition(key, scope, true);
+	if(!scope)
+		return FindGlobalVar(key);
+	SymList* local = FindLocalEntry(key, scope);
+	if(local == NULL || local->item->scope != scope)
+		return NULL;
+	return local->item;
 }
 
 SymList* InsertEnumName(const char* name){
 	if(name == NULL)	FatalM("No name supplied to InsertEnumName!", Line);
-	unsigned int hash = hash_oaat(name, strlen(name)) % CAPACITY;
-	if(hashArray[0] == NULL)
+	if(tagTable == NULL)
 		return NULL;
-	SymList* list = hashArray[0][hash];
-	if(list == NULL)
-		return hashArray[0][hash] = MakeSymList(MakeSymEntry(name, FlexNULL(), S_EnumName), NULL);
-	while((list->item->sType != S_EnumName || !streq(list->item->key, name)) && list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_EnumName || !streq(list->item->key, name))
-		return list->next = MakeSymList(MakeSymEntry(name, FlexNULL(), S_EnumName), NULL);
-	FatalM("Redeclaration of enums is strictly forbidden!", Line);
+	SymList** slot = FindSlot(tagTable, name, S_EnumName);
+	if(*slot != NULL)	FatalM("Redeclaration of enums is strictly forbidden!", Line);
+	return AddSymbol(tagTable, slot, MakeSymEntry(name, FlexNULL(), S_EnumName));
 }
 
 SymList* InsertEnumValue(const char* name, int value){
 	if(name == NULL)	FatalM("No name supplied to InsertEnumValue!", Line);
-	unsigned int hash = hash_oaat(name, strlen(name)) % CAPACITY;
-	if(hashArray[0] == NULL)
-		return NULL;
-	SymList* list = hashArray[0][hash];
-	if(list == NULL)
-		return hashArray[0][hash] = MakeSymList(MakeSymEntry(name, FlexInt(value), S_EnumValue), NULL);
-	while((list->item->sType != S_EnumValue || !streq(list->item->key, name)) && list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_EnumValue || !streq(list->item->key, name))
-		return list->next = MakeSymList(MakeSymEntry(name, FlexInt(value), S_EnumValue), NULL);
-	FatalM("Redeclaration of enum values is strictly forbidden!", Line);
-}
-
-SymList* InsertVar(const char* key, const char* value, PrimordialType type, SymEntry* cType, StorageClass sc, int scope){
-	unsigned int hash = hash_oaat(key, strlen(key)) % CAPACITY;
-	if(hashArray[scope] == NULL)
+	if(ordinaryTable == NULL)
 		return NULL;
-	SymList* list = hashArray[scope][hash];
-	if(list == NULL){
-		varCount[scope]++;
-		stackSize[scope] += align(GetTypeSize(type, cType), 16);
-		return hashArray[scope][hash] = MakeSymList(MakeVarEntry(key, value, type, cType, sc), NULL);
+	SymList** slot = FindSlot(ordinaryTable, name, S_EnumValue);
+	if(*slot != NULL)	FatalM("Redeclaration of enum values is strictly forbidden!", Line);
+	return AddSymbol(ordinaryTable, slot, MakeSymEntry(name, FlexInt(value), S_EnumValue));
+}
+
+/// @brief Account for the stack taken by a local in the scope it's declared in.
+static void CountLocalVar(SymEntry* var, int scope){
+	varCount[scope]++;
+	// Static locals are placed with the globals, so they take no stack
+	if(!(var->sValue.intVal & C_Static))
+		stackSize[scope] += align(GetSymbolSize(var), 16);
+}
+
+/// @brief Declare a variable in the innermost scope, or update its declaration there.
+static SymList* InsertLocalVar(const char* key, const Location* location, PrimordialType type, SymEntry* cType, StorageClass sc, int length, int scope){
+	SymList* list = FindLocalEntry(key, scope);
+	if(list != NULL && list->item->scope == scope){
+		SetLocation(list->item, location);
+		if(length)
+			list->item->length = length;
+		return list;
+	}
+	unsigned int hash = hash_oaat(key, strlen(key)) & (LOCAL_CAPACITY - 1);
+	list = MakeSymList(MakeVarEntry(key, location, type, cType, sc), localTable[hash]);
+	list->item->length = length;
+	list->item->scope = scope;
+	localTable[hash] = list;
+	if(undoCount == undoSize){
+		undoSize *= 2;
+		undoLog = realloc(undoLog, sizeof(SymList*) * undoSize);
 	}
-	while((list->item->sType != S_Variable || !streq(list->item->key, key))&& list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_Variable || !streq(list->item->key, key)){
+	undoLog[undoCount++] = list;
+	CountLocalVar(list->item, scope);
+	return list;
+}
+
+SymList* InsertVar(const char* key, const Location* location, PrimordialType type, SymEntry* cType, StorageClass sc, int length, int scope){
+	if(scope)
+		return InsertLocalVar(key, location, type, cType, sc, length, scope);
+	if(ordinaryTable == NULL)
+		return NULL;
+	SymList** slot = FindSlot(ordinaryTable, key, S_Variable);
+	if(*slot == NULL){
 		varCount[scope]++;
-		stackSize[scope] += align(GetTypeSize(type, cType), 16);
-		return list->next = MakeSymList(MakeVarEntry(key, value, type, cType, sc), NULL);
+		SymList* list = AddSymbol(ordinaryTable, slot, MakeVarEntry(key, location, type, cType, sc));
+		list->item->length = length;
+		return list;
 	}
-	list->item->value = FlexStr(value);
+	SymList* list = *slot;
+	SetLocation(list->item, location);
+	if(length)
+		list->item->length = length;
 	return list;
 }
 
+/// @brief Give a variable bound by the parser its storage, as it's generated in a scope.
+void PlaceVar(SymEntry* var, const Location* location, int scope){
+	SetLocation(var, location);
+	if(scope)
+		CountLocalVar(var, scope);
+}
+
 SymList* InsertFunc(const char* key, FlexibleValue params, PrimordialType type, SymEntry* cType){
-	unsigned int hash = hash_oaat(key, strlen(key)) % CAPACITY;
-	if(hashArray[0] == NULL)
+	if(ordinaryTable == NULL)
 		return NULL;
-	SymList* list = hashArray[0][hash];
-	if(list == NULL)
-		return hashArray[0][hash] = MakeSymList(MakeFuncEntry(key, params, type, cType), NULL);
-	while((list->item->sType != S_Function || !streq(list->item->key, key)) && list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_Function || !streq(list->item->key, key))
-		return list->next = MakeSymList(MakeFuncEntry(key, params, type, cType), NULL);
-	return list;
+	SymList** slot = FindSlot(ordinaryTable, key, S_Function);
+	if(*slot != NULL)
+		return *slot;
+	return AddSymbol(ordinaryTable, slot, MakeFuncEntry(key, params, type, cType));
 }
 
-SymList* InsertStruct(const char* name, SymEntry* members){
+SymList* InsertStruct(const char* name, SymEntry* members, Attribute attributes){
 	if(name == NULL)
-		return MakeSymList(MakeStructEntry(NULL, members), NULL);
-	unsigned int hash = hash_oaat(name, strlen(name)) % CAPACITY;
-	if(hashArray[0] == NULL)
+		return MakeSymList(MakeStructEntry(NULL, members, attributes), NULL);
+	if(tagTable == NULL)
 		return NULL;
-	SymList* list = hashArray[0][hash];
-	if(list == NULL)
-		return hashArray[0][hash] = MakeSymList(MakeStructEntry(name, members), NULL);
-	while((list->item->sType != S_Composite || !streq(list->item->key, name)) && list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_Composite || !streq(list->item->key, name))
-		return list->next = MakeSymList(MakeStructEntry(name, members), NULL);
-	if(list->item->value.ptrVal != NULL)	WarnM("Overriding previous composite declaration!", Line);
-	return UpdateStruct(list, name, members);
-}
-
-SymList* InsertUnion(const char* name, SymEntry* members){
+	SymList** slot = FindSlot(tagTable, name, S_Composite);
+	if(*slot == NULL)
+		return AddSymbol(tagTable, slot, MakeStructEntry(name, members, attributes));
+	if((*slot)->item->value.ptrVal != NULL)	WarnM("Overriding previous composite declaration!", Line);
+	return UpdateStruct(*slot, name, members, attributes);
+}
+
+SymList* InsertUnion(const char* name, SymEntry* members, Attribute attributes){
 	if(name == NULL)
-		return MakeSymList(MakeUnionEntry(NULL, members), NULL);
-	unsigned int hash = hash_oaat(name, strlen(name)) % CAPACITY;
-	if(hashArray[0] == NULL)
+		return MakeSymList(MakeUnionEntry(NULL, members, attributes), NULL);
+	if(tagTable == NULL)
 		return NULL;
-	SymList* list = hashArray[0][hash];
-	if(list == NULL)
-		return hashArray[0][hash] = MakeSymList(MakeUnionEntry(name, members), NULL);
-	while((list->item->sType != S_Composite || !streq(list->item->key, name)) && list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_Composite || !streq(list->item->key, name))
-		return list->next = MakeSymList(MakeUnionEntry(name, members), NULL);
-	if(list->item->value.ptrVal != NULL)	WarnM("Overriding previous composite declaration!", Line);
-	return UpdateUnion(list, name, members);
+	SymList** slot = FindSlot(tagTable, name, S_Composite);
+	if(*slot == NULL)
+		return AddSymbol(tagTable, slot, MakeUnionEntry(name, members, attributes));
+	if((*slot)->item->value.ptrVal != NULL)	WarnM("Overriding previous composite declaration!", Line);
+	return UpdateUnion(*slot, name, members, attributes);
 }
 
 SymList* InsertTypedef(const char* alias, PrimordialType type, SymEntry* cType){
 	if(alias == NULL)	FatalM("No alias supplied to InsertTypeDef! (Internal @ symTable.h)", __LINE__);
 	SymEntry* entry = MakeTypedSymEntry(alias, type, cType, S_Typedef);
-	unsigned int hash = hash_oaat(alias, strlen(alias)) % CAPACITY;
-	if(hashArray[0] == NULL)
+	if(ordinaryTable == NULL)
 		FatalM("Failed to get base hash table! (Internal @ symTable.h)", __LINE__);
-	SymList* list = hashArray[0][hash];
-	if(list == NULL)
-		return hashArray[0][hash] = MakeSymList(entry, NULL);
-	while((list->item->sType != S_Typedef || !streq(list->item->key, alias)) && list->next != NULL)
-		list = list->next;
-	if(list->item->sType != S_Typedef || !streq(list->item->key, alias))
-		return list->next = MakeSymList(entry, NULL);
-	list->item = entry;
-	return list;
+	SymList** slot = FindSlot(ordinaryTable, alias, S_Typedef);
+	if(*slot == NULL)
+		return AddSymbol(ordinaryTable, slot, entry);
+	(*slot)->item = entry;
+	return *slot;
 }
 
-SymList* UpdateStruct(SymList* list, const char* name, SymEntry* members){
+SymList* UpdateStruct(SymList* list, const char* name, SymEntry* members, Attribute attributes){
 	if(name != NULL){
 		while((!streq(list->item->key, name) || list->item->sType != S_Composite) && list->next != NULL)
 			list = list->next;
 		if(!streq(list->item->key, name))
 			FatalM("Failed to find struct definition! (Internal @ symTable.h)", __LINE__);
 	}
-	SymEntry* proto = MakeStructEntry(name, members);
+	SymEntry* proto = MakeStructEntry(name, members, attributes);
 	list->item->value	= proto->value;
 	list->item->sValue	= proto->sValue;
+	list->item->attributes	= proto->attributes;
+	list->item->members	= proto->members;
+	list->item->isUnion	= proto->isUnion;
 	free(proto);
 	return list;
 }
 
-SymList* UpdateUnion(SymList* list, const char* name, SymEntry* members){
+SymList* UpdateUnion(SymList* list, const char* name, SymEntry* members, Attribute attributes){
 	if(name != NULL){
 		while((!streq(list->item->key, name) || list->item->sType != S_Composite) && list->next != NULL)
 			list = list->next;
 		if(!streq(list->item->key, name))
 			FatalM("Failed to find union definition! (Internal @ symTable.h)", __LINE__);
 	}
-	SymEntry* proto = MakeUnionEntry(name, members);
+	SymEntry* proto = MakeUnionEntry(name, members, attributes);
 	list->item->value	= proto->value;
 	list->item->sValue	= proto->sValue;
+	list->item->attributes	= proto->attributes;
+	list->item->members	= proto->members;
+	list->item->isUnion	= proto->isUnion;
 	free(proto);
 	return list;
 }
 
 SymEntry* FindGlobal(const char* key, StructuralType type){
-	if(hashArray[0] == NULL)
-		return NULL;
-	unsigned int hash = hash_oaat(key, strlen(key)) % CAPACITY;
-	SymList* list = hashArray[0][hash];
-	if(list == NULL)
-		return NULL;
-	while((!streq(list->item->key, key) || list->item->sType != type) && list->next != NULL)
-		list = list->next;
-	if(!streq(list->item->key, key) || list->item->sType != type)
-		return NULL;
-	return list->item;
+	return FindSymbol(GetNamespace(type), key, type);
 }
 
 SymEntry* FindFunc(const char* key){
@@ -399,6 +618,11 @@ int GetLocalStackSize(int scope){
 	return stackSize[scope];
 }
 
+/// @brief Reserve stack space in a scope beyond that of its variables, such as padding used to align them.
+void ReserveLocalStack(int scope, int size){
+	stackSize[scope] += align(size, 16);
+}
+
 int EnterScope(){
 	CreateScope(++scope);
 	return scope;
@@ -406,8 +630,10 @@ int EnterScope(){
 
 int ExitScope(){
 	stackIndex[scope] = 0;
-	DestroyVarTable(scope--);
+	UnwindScope(scope--);
 	return scope;
 }
 
-#undef CAPACITY
\ No newline at end of file
+#undef GLOBAL_CAPACITY
+#undef MEMBER_CAPACITY
+#undef LOCAL_CAPACITY
\ No newline at end of file
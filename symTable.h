@@ -6,18 +6,34 @@
 // static SymList* MakeSymList(SymEntry* entry, SymList* next);
 // static SymEntry* MakeSymEntry(const char* key, FlexibleValue value, StructuralType sType);
 // static SymEntry* MakeTypedSymEntry(const char* key, PrimordialType type, SymEntry* cType, StructuralType sType);
-// static SymEntry* MakeVarEntry(const char* key, const char* val, PrimordialType type, SymEntry* cType, StorageClass sc);
+// static void SetLocation(SymEntry* entry, const Location* location);
+// static SymEntry* MakeVarEntry(const char* key, const Location* location, PrimordialType type, SymEntry* cType, StorageClass sc);
 // static SymEntry* MakeFuncEntry(const char* key, FlexibleValue val, PrimordialType type, SymEntry* cType);
-// static SymEntry* MakeStructEntry(const char* name, SymEntry* members);
-// static SymEntry* MakeUnionEntry(const char* name, SymEntry* members);
-SymEntry* MakeCompMember(const char* name, SymEntry* next, PrimordialType type, SymEntry* cType);
+// static int GetMemberAlignment(SymEntry* member, int packing);
+// static SymEntry* MakeStructEntry(const char* name, SymEntry* members, Attribute attributes);
+// static SymEntry* MakeUnionEntry(const char* name, SymEntry* members, Attribute attributes);
+// static SymbolTable* MakeSymbolTable(int capacity);
+// static SymList** FindSlot(SymbolTable* table, const char* key, StructuralType sType);
+// static void GrowSymbolTable(SymbolTable* table);
+// static SymList* AddSymbol(SymbolTable* table, SymList** slot, SymEntry* entry);
+// static void DestroySymbolTable(SymbolTable* table);
+SymEntry* FindSymbol(SymbolTable* table, const char* key, StructuralType sType);
+// static SymbolTable* IndexMembers(SymEntry* members);
+SymEntry* MakeCompMember(const char* name, SymEntry* next, PrimordialType type, SymEntry* cType, int length);
 SymEntry* MakeCompMembers(ASTNodeList* list);
-// static SymList*** hashArray;
+void AlignComposite(SymEntry* composite, Attribute attributes);
+void DumpCompositeLayout(SymEntry* composite, bool isUnion);
+// static SymbolTable* ordinaryTable;
+// static SymbolTable* tagTable;
+// static SymList** localTable;
+// static SymList** undoLog;
+// static int* scopeStart;
 // static int* varCount;
 // static int* stackSize;
 // static int maxScope = 5;
 
 // static void CreateScope(int scope);
+// static void UnwindScope(int scope);
 
 void InitVarTable();
 void DestroyVarTable(int scope);
@@ -26,24 +42,30 @@ SymEntry* FindVar(const char* key, int scope);
 SymEntry* FindLocalVar(const char* key, int scope);
 // static unsigned int hash_oaat(const char* key, int length);
 extern int collisions;
-// static SymEntry* FindVarPosition(const char* key, int scope, bool strict);
+// static SymbolTable* GetNamespace(StructuralType sType);
+// static SymEntry* FindGlobalVar(const char* key);
+// static SymList* FindLocalEntry(const char* key, int scope);
 SymEntry* FindVar(const char* key, int scope);
 SymEntry* FindLocalVar(const char* key, int scope);
 SymList* InsertEnumName(const char* name);
 SymList* InsertEnumValue(const char* name, int value);
-SymList* InsertVar(const char* key, const char* value, PrimordialType type, SymEntry* cType, StorageClass sc, int scope);
+// static void CountLocalVar(SymEntry* var, int scope);
+// static SymList* InsertLocalVar(const char* key, const Location* location, PrimordialType type, SymEntry* cType, StorageClass sc, int length, int scope);
+SymList* InsertVar(const char* key, const Location* location, PrimordialType type, SymEntry* cType, StorageClass sc, int length, int scope);
+void PlaceVar(SymEntry* var, const Location* location, int scope);
 SymList* InsertFunc(const char* key, FlexibleValue params, PrimordialType type, SymEntry* cType);
-SymList* InsertStruct(const char* name, SymEntry* members);
-SymList* InsertUnion(const char* name, SymEntry* members);
+SymList* InsertStruct(const char* name, SymEntry* members, Attribute attributes);
+SymList* InsertUnion(const char* name, SymEntry* members, Attribute attributes);
 SymList* InsertTypedef(const char* alias, PrimordialType type, SymEntry* cType);
-SymList* UpdateStruct(SymList* list, const char* name, SymEntry* members);
-SymList* UpdateUnion(SymList* list, const char* name, SymEntry* members);
+SymList* UpdateStruct(SymList* list, const char* name, SymEntry* members, Attribute attributes);
+SymList* UpdateUnion(SymList* list, const char* name, SymEntry* members, Attribute attributes);
 SymEntry* FindGlobal(const char* key, StructuralType type);
 SymEntry* FindFunc(const char* key);
 SymEntry* FindStruct(const char* key);
 SymEntry* FindEnumValue(const char* key);
 int GetLocalVarCount(int scope);
 int GetLocalStackSize(int scope);
+void ReserveLocalStack(int scope, int size);
 int EnterScope();
 int ExitScope();
 
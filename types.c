@@ -1,4 +1,7 @@
+#include <ctype.h>
+
 #include "types.h"
+#include "symTable.h"
 
 ASTNodeList* MakeASTNodeList(){
 	ASTNodeList* list = malloc(sizeof(ASTNodeList));
@@ -30,6 +33,10 @@ ASTNode* MakeASTNodeEx(NodeType op, PrimordialType type, ASTNode* lhs, ASTNode*
 	node->secondaryValue = secondValue;
 	node->list = NULL;
 	node->cType = cType;
+	node->symbol = NULL;
+	node->sClass = C_Default;
+	node->qualifiers = Q_None;
+	node->attributes = AT_None;
 	switch(op){
 		case A_FunctionCall:
 			node->lvalue = (type & 0xF) && ((type & 0xF0) == P_Composite);
@@ -98,6 +105,8 @@ int GetPrimSize(PrimordialType prim){
 		case P_Long:		return 4;
 		case P_ULongLong:
 		case P_LongLong:	return 8;
+		case P_Float:		return 4;
+		case P_Double:		return 8;
 		default:			FatalM("Unhandled primordial in GetPrimSize()! (In types.h)", __LINE__);
 	}
 }
@@ -114,6 +123,103 @@ int GetTypeSize(PrimordialType type, SymEntry* compositeType){
 	}
 }
 
+/// @brief Get the size of the storage of a variable or member, accounting for arrays.
+int GetSymbolSize(SymEntry* sym){
+	int size = GetTypeSize(sym->type, sym->cType);
+	return sym->length ? size * sym->length : size;
+}
+
+/// @brief Determine whether a value is a composite which can't be held in a register, as its size isn't 1, 2, 4 or 8 bytes.
+/// Such values are handled by their address, and are passed to and returned from functions by reference.
+bool IsMemoryComposite(PrimordialType type, SymEntry* cType){
+	if((type & 0xF0) != P_Composite || (type & 0x0F))
+		return false;
+	int size = GetTypeSize(type, cType);
+	return size != 1 && size != 2 && size != 4 && size != 8;
+}
+
+/// @brief Get the number of bytes a string literal occupies, excluding its terminator.
+/// Escape sequences are kept verbatim in string literals, and are passed through to the assembler.
+int GetStringLength(const char* str){
+	int length = 0;
+	while(*str){
+		if(*str++ == '\\'){
+			if(*str == 'x'){
+				str++;
+				while(isxdigit(*str))
+					str++;
+			}
+			else if(*str >= '0' && *str <= '7')
+				for(int i = 0; i < 3 && *str >= '0' && *str <= '7'; i++)
+					str++;
+			else
+				str++;
+		}
+		length++;
+	}
+	return length;
+}
+
+/// @brief Get the alignment requested by an aligned attribute, or 0 if there is none.
+int GetAttributeAlignment(Attribute attributes){
+	int log = (attributes & AT_Aligned) >> AT_ALIGNED_SHIFT;
+	return log ? 1 << (log - 1) : 0;
+}
+
+/// @param alignment A power of two.
+Attribute MakeAlignedAttribute(int alignment){
+	if(alignment <= 0)
+		return AT_None;
+	int log = 1;
+	while(alignment > 1){
+		alignment >>= 1;
+		log++;
+	}
+	return (log << AT_ALIGNED_SHIFT) & AT_Aligned;
+}
+
+/// @brief Get the largest alignment packing permits the members of a composite, or 0 if they're naturally aligned.
+int GetPackedAlignment(Attribute attributes){
+	int log = (attributes & AT_Packed) >> AT_PACKED_SHIFT;
+	return log ? 1 << (log - 1) : 0;
+}
+
+/// @param alignment A power of two.
+Attribute MakePackedAttribute(int alignment){
+	return ((MakeAlignedAttribute(alignment) >> AT_ALIGNED_SHIFT) << AT_PACKED_SHIFT) & AT_Packed;
+}
+
+/// @brief Combine the attributes of two declarations of the same entity; The stricter alignment, and the tighter packing, are kept.
+Attribute MergeAttributes(Attribute lhs, Attribute rhs){
+	Attribute aligned = (lhs & AT_Aligned) > (rhs & AT_Aligned) ? lhs & AT_Aligned : rhs & AT_Aligned;
+	Attribute packed = lhs & AT_Packed;
+	if(!packed || ((rhs & AT_Packed) && (rhs & AT_Packed) < packed))
+		packed = rhs & AT_Packed;
+	return ((lhs | rhs) & ~(AT_Aligned | AT_Packed)) | aligned | packed;
+}
+
+/// @brief Get the alignment explicitly requested for an object by its own attributes, or by those of its composite type.
+/// @return 0 if no alignment was requested.
+int GetExplicitAlignment(PrimordialType type, SymEntry* cType, Attribute attributes){
+	int alignment = GetAttributeAlignment(attributes);
+	if(!(type & 0x0F) && (type & 0xF0) == P_Composite && cType != NULL){
+		int typeAlignment = GetAttributeAlignment(cType->attributes);
+		if(typeAlignment > alignment)
+			alignment = typeAlignment;
+	}
+	return alignment;
+}
+
+/// @brief Get the alignment of an object: The size of a scalar, or the alignment of a composite, raised by any alignment requested.
+int GetTypeAlignment(PrimordialType type, SymEntry* cType, Attribute attributes){
+	int alignment = GetExplicitAlignment(type, cType, attributes);
+	// Composites are aligned as their most strictly aligned member, which is recorded as their requested alignment
+	int natural = 1;
+	if((type & 0xF0) != P_Composite || (type & 0x0F))
+		natural = GetPrimSize(type);
+	return natural > alignment ? natural : alignment;
+}
+
 bool IsUnsigned(PrimordialType prim){
 	switch(prim){
 		case P_UChar:
@@ -137,10 +243,28 @@ bool IsIntegral(PrimordialType type){
 	}
 }
 
+bool IsFloating(PrimordialType type){
+	return type == P_Float || type == P_Double;
+}
+
+/// @brief Determine whether a type is an integer or floating type, which may be converted to any other arithmetic type.
+bool IsArithmetic(PrimordialType type){
+	if(IsPointer(type))
+		return false;
+	switch(type & 0xF0){
+		case P_Undefined:
+		case P_Void:
+		case P_Composite:	return false;
+		default:			return true;
+	}
+}
+
 int CheckTypeCompatibility(PrimordialType lhs, PrimordialType rhs){
 	if(lhs == P_Void	|| rhs == P_Void)			return TYPES_INCOMPATIBLE;
 	if(lhs == rhs)									return TYPES_COMPATIBLE;
 	if (lhs == P_Composite || rhs == P_Composite)	return TYPES_INCOMPATIBLE;
+	if((IsFloating(lhs) || IsFloating(rhs)) && (!IsArithmetic(lhs) || !IsArithmetic(rhs)))
+		return TYPES_INCOMPATIBLE;
 	char lptr = lhs & 0x0F; // The level of indirection of lhs
 	char rptr = rhs & 0x0F; // The level of indirection of rhs
 	int lbase = lhs & 0xF0; // The base type of lhs
@@ -164,15 +288,15 @@ PrimordialType GetWidestType(PrimordialType lhs, PrimordialType rhs){
 	}
 }
 
-ASTNode* ScaleNode(ASTNode* node, PrimordialType complement){
+ASTNode* ScaleNode(ASTNode* node, PrimordialType complement, SymEntry* cType){
 	if(!IsPointer(complement))	return node;
 	if(IsPointer(node->type))	FatalM("Cannot scale pointers! (In types.h)", __LINE__);
 	complement -= 0x01; // Decrement level of indirection
-	return MakeASTBinary(A_Multiply, node->type, node, MakeASTLeaf(A_LitInt, P_Int, FlexInt(GetPrimSize(complement))), FlexNULL());
+	return MakeASTBinary(A_Multiply, node->type, node, MakeASTLeaf(A_LitInt, P_Int, FlexInt(GetTypeSize(complement, cType))), FlexNULL());
 }
 
 ASTNode* WidenNode(ASTNode* node, PrimordialType complement, NodeType op){
-	if(IsPointer(complement))	return ScaleNode(node, complement);
+	if(IsPointer(complement))	return ScaleNode(node, complement, NULL);
 	PrimordialType widest = GetWidestType(node->type, complement);
 	if(widest == P_Undefined)	FatalM("Types incompatible!", Line);
 	if(widest == node->type)	return node;
@@ -185,6 +309,8 @@ Parameter* MakeParam(const char* id, PrimordialType type, SymEntry* cType, Param
 	p->id = id;
 	p->type = type;
 	p->cType = cType;
+	p->qualifiers = Q_None;
+	p->symbol = NULL;
 	p->prev = prev;
 	if (prev != NULL) {
 		p->next = prev->next;
@@ -203,11 +329,76 @@ DbLnkList* MakeDbLnkList(void* val, DbLnkList* prev, DbLnkList* next){
 	return l;
 }
 
+/// @brief Determine whether a statement defines a label, through which it may be entered other than from its start.
+bool ContainsLabel(ASTNode* node){
+	if(node == NULL)
+		return false;
+	if(node->op == A_Label)
+		return true;
+	if(ContainsLabel(node->lhs) || ContainsLabel(node->mid) || ContainsLabel(node->rhs))
+		return true;
+	if(node->list != NULL)
+		for(int i = 0; i < node->list->count; i++)
+			if(ContainsLabel(node->list->nodes[i]))
+				return true;
+	return false;
+}
+
+/// @brief Determine whether a declaration is of an array whose size is only known at runtime.
+/// The dimension of such a declaration is the expression computing its size in bytes, rather than a literal element count.
+bool IsVariableLengthArray(ASTNode* node){
+	return node->op == A_Declare && node->mid != NULL && node->mid->op != A_LitInt;
+}
+
+/// @brief Get the name of the hidden variable holding the size in bytes of a variable-length array.
+const char* VariableLengthSizeName(const char* id){
+	const char* format = "%s@size";
+	return sngenf(strlen(format) + strlen(id) + 1, format, id);
+}
+
+/// @brief Determine whether a statement allocates stack at runtime, with the alloca built-in function or, if arrays is set, a variable-length array.
+bool ContainsDynamicAllocation(ASTNode* node, bool arrays){
+	if(node == NULL)
+		return false;
+	if(node->op == A_BuiltinCall && streq(node->value.strVal, "__SCC_BUILTIN__alloca"))
+		return true;
+	if(arrays && IsVariableLengthArray(node))
+		return true;
+	if(ContainsDynamicAllocation(node->lhs, arrays) || ContainsDynamicAllocation(node->mid, arrays) || ContainsDynamicAllocation(node->rhs, arrays))
+		return true;
+	ASTNodeList* list = node->list;
+	if(node->op == A_FunctionCall || node->op == A_BuiltinCall)
+		list = node->secondaryValue.ptrVal;
+	if(list != NULL)
+		for(int i = 0; i < list->count; i++)
+			if(ContainsDynamicAllocation(list->nodes[i], arrays))
+				return true;
+	return false;
+}
+
+bool IsAtomicBuiltin(ASTNode* node){
+	return node->op == A_BuiltinCall && strbeg(node->value.strVal, "__SCC_BUILTIN__atomic_");
+}
+
+/// @brief Determine whether a built-in function only computes a value from its arguments.
+bool IsPureBuiltin(ASTNode* node){
+	if(node->op != A_BuiltinCall || !strbeg(node->value.strVal, "__SCC_BUILTIN__"))
+		return false;
+	const char* id = node->value.strVal + 15;
+	return streq(id, "popcount") || streq(id, "clz") || streq(id, "ctz") || strbeg(id, "bswap")
+		|| streq(id, "rotl") || streq(id, "rotr") || streq(id, "expect") || streq(id, "assume_aligned");
+}
+
+/// @brief Get the memory order of a call of an atomic built-in function, which is its last argument.
+/// The parser has already reduced it to a literal.
+MemoryOrder GetAtomicOrder(ASTNode* node){
+	ASTNodeList* args = node->secondaryValue.ptrVal;
+	return args->nodes[args->count - 1]->value.intVal;
+}
+
 SymEntry* GetMember(SymEntry* structDef, const char* member){
-	SymEntry* members = structDef->value.ptrVal;
-	if(members == NULL)		FatalM("Struct definition contained no members! (Internal @ types.h)", __LINE__);
-	while(!streq(members->key, member) && members->sValue.ptrVal != NULL)
-		members = members->sValue.ptrVal;
-	if(!streq(members->key, member))	FatalM("Undefined composite member!", Line);
-	return members;
+	if(structDef->value.ptrVal == NULL)	FatalM("Struct definition contained no members! (Internal @ types.h)", __LINE__);
+	SymEntry* entry = FindSymbol(structDef->members, member, S_Member);
+	if(entry == NULL)					FatalM("Undefined composite member!", Line);
+	return entry;
 }
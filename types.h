@@ -14,6 +14,10 @@ typedef enum ePrimordialType PrimordialType;
 typedef enum eTokenCategory TokenType;
 typedef enum eNodeType NodeType;
 typedef enum eStorageClass StorageClass;
+typedef enum eLocationKind LocationKind;
+typedef enum eTypeQualifier TypeQualifier;
+typedef enum eAttribute Attribute;
+typedef enum eMemoryOrder MemoryOrder;
 typedef union flexible_value FlexibleValue;
 typedef struct doubly_linked_list DbLnkList;
 typedef struct param Parameter;
@@ -23,6 +27,8 @@ typedef struct ast_node_list ASTNodeList;
 typedef enum eStructuralType StructuralType;
 typedef struct SymEntry SymEntry;
 typedef struct SymList SymList;
+typedef struct SymbolTable SymbolTable;
+typedef struct Location Location;
 
 
 // Bottom nibble stores level of reference
@@ -42,6 +48,8 @@ enum ePrimordialType {
 	P_UInt		= 0x80,
 	P_ULong		= 0x90,
 	P_ULongLong	= 0xA0,
+	P_Float		= 0xB0,
+	P_Double	= 0xC0,
 };
 #define P_UNSIGNED_DIFF (P_UChar - P_Char)
 enum eTokenCategory {
@@ -120,6 +128,18 @@ enum eTokenCategory {
 	T_Static,
 	T_Unsigned,
 	T_EqualDoublePipe,
+	T_Const,
+	T_Restrict,
+	T_Inline,
+	T_Attribute,
+	T_Asm,
+	T_Volatile,
+	T_Goto,
+	T_Float,
+	T_Double,
+	T_LitFloat,
+	T_LitDouble,
+	T_ThreadLocal,
 };
 
 enum eNodeType {
@@ -188,12 +208,68 @@ enum eNodeType {
 	A_BuiltinCall,
 	A_RawASM,
 	A_Logicize,
+	A_Initializer,
+	A_InitField,
+	A_Inline,
+	A_Asm,
+	A_AsmOperand,
+	A_Label,
+	A_Goto,
+	A_LabelAddress,
+	A_LitFloat,
 };
 
+// Thread-local may be combined with either of the other storage classes
 enum eStorageClass{
-	C_Default	= 0,
-	C_Extern,
-	C_Static,
+	C_Default		= 0,
+	C_Extern		= 0x1,
+	C_Static		= 0x2,
+	C_ThreadLocal	= 0x4,
+};
+
+enum eLocationKind{
+	L_None	= 0,
+	L_Frame,		// Offset from the frame pointer
+	L_Symbol,		// Displacement from a symbol, addressed relative to the instruction pointer
+	L_ThreadLocal,	// Displacement from a symbol in the TLS section
+	L_Register,
+};
+
+// Flags; may be combined
+enum eTypeQualifier{
+	Q_None		= 0,
+	Q_Const		= 0x1,
+	Q_Restrict	= 0x2,
+};
+
+// Flags; may be combined
+// An explicit alignment is stored in the AT_Aligned bits, as the base 2 logarithm of the alignment plus one
+// The largest alignment of the members of a packed composite is stored in the AT_Packed bits likewise
+enum eAttribute{
+	AT_None			= 0,
+	AT_Inline		= 0x1,
+	AT_AlwaysInline	= 0x2,
+	AT_NoInline		= 0x4,
+	AT_Hot			= 0x8,
+	AT_Cold			= 0x10,
+	AT_Pure			= 0x20,
+	AT_Const		= 0x40,
+	AT_NoReturn		= 0x80,
+	AT_Aligned		= 0xF00,
+	AT_Packed		= 0xF000,
+	AT_ReorderFields	= 0x10000,
+};
+#define AT_ALIGNED_SHIFT 8
+#define AT_PACKED_SHIFT 12
+
+// The memory orders of the atomic built-in functions, numbered as in <stdatomic.h>
+enum eMemoryOrder{
+	MO_Relaxed	= 0,
+	MO_Consume,
+	MO_Acquire,
+	MO_Release,
+	MO_AcqRel,
+	MO_SeqCst,
 };
 
 union flexible_value {
@@ -212,6 +288,8 @@ struct param {
 	const char* id;
 	PrimordialType type;
 	SymEntry* cType;
+	TypeQualifier qualifiers;
+	SymEntry* symbol; // Entry the parameter is declared as in the body of a definition
 	Parameter* next;
 	Parameter* prev;
 };
@@ -231,7 +309,10 @@ struct ast_node {
 	FlexibleValue value;
 	FlexibleValue secondaryValue;
 	SymEntry* cType;
+	SymEntry* symbol; // Variable a reference or declaration is bound to when it's parsed
 	StorageClass sClass;
+	TypeQualifier qualifiers; // Qualifiers of the object an lvalue designates, or of a declared variable
+	Attribute attributes; // Function specifiers and attributes of a function or declaration, or of the function a call calls
 	bool lvalue;
 };
 
@@ -252,6 +333,13 @@ enum eStructuralType {
 	S_Typedef,
 };
 
+/// Where a variable is stored; It's only formatted as an operand when an instruction accessing it is generated.
+struct Location {
+	LocationKind kind;
+	const char* name;	// Symbol, or register holding the variable
+	int offset;			// Frame offset, or displacement from the symbol
+};
+
 struct SymEntry {
 	const char* key;
 	FlexibleValue value;
@@ -259,6 +347,14 @@ struct SymEntry {
 	PrimordialType type;
 	StructuralType sType;
 	SymEntry* cType; // Composite Type
+	TypeQualifier qualifiers;
+	ASTNode* init; // Initializer of const variables, if it is a constant expression
+	int length; // Element count of arrays; 0 if not an array
+	Attribute attributes;
+	int scope; // Scope a variable is declared in
+	SymbolTable* members; // Index of the members of a composite by name
+	bool isUnion; // The composite is a union, whose members all start at its beginning
+	Location location; // Storage of a variable, once it's been generated
 };
 
 struct SymList {
@@ -266,6 +362,13 @@ struct SymList {
 	SymList* next;
 };
 
+/// An open-addressing hash table of symbols, which grows to stay at most three quarters full.
+struct SymbolTable {
+	SymList** slots;
+	int capacity; // Always a power of two
+	int count;
+};
+
 ASTNodeList* MakeASTNodeList();
 ASTNodeList* AddNodeToASTList(ASTNodeList* list, ASTNode* node);
 ASTNode* MakeASTNodeEx(NodeType op, PrimordialType type, ASTNode* lhs, ASTNode* mid, ASTNode* rhs, FlexibleValue value, FlexibleValue secondValue, SymEntry* cType);
@@ -280,16 +383,35 @@ FlexibleValue FlexPtr(void* ptr);
 FlexibleValue FlexNULL();
 int GetPrimSize(PrimordialType prim);
 int GetTypeSize(PrimordialType type, SymEntry* compositeType);
+int GetSymbolSize(SymEntry* sym);
+bool IsMemoryComposite(PrimordialType type, SymEntry* cType);
+int GetStringLength(const char* str);
+int GetAttributeAlignment(Attribute attributes);
+Attribute MakeAlignedAttribute(int alignment);
+int GetPackedAlignment(Attribute attributes);
+Attribute MakePackedAttribute(int alignment);
+Attribute MergeAttributes(Attribute lhs, Attribute rhs);
+int GetExplicitAlignment(PrimordialType type, SymEntry* cType, Attribute attributes);
+int GetTypeAlignment(PrimordialType type, SymEntry* cType, Attribute attributes);
 bool IsUnsigned(PrimordialType prim);
 bool IsPointer(PrimordialType prim);
 bool IsIntegral(PrimordialType type);
+bool IsFloating(PrimordialType type);
+bool IsArithmetic(PrimordialType type);
 int CheckTypeCompatibility(PrimordialType lhs, PrimordialType rhs);
 PrimordialType GetWidestType(PrimordialType lhs, PrimordialType rhs);
-ASTNode* ScaleNode(ASTNode* node, PrimordialType complement);
+ASTNode* ScaleNode(ASTNode* node, PrimordialType complement, SymEntry* cType);
 ASTNode* WidenNode(ASTNode* node, PrimordialType complement, NodeType op);
 Parameter* MakeParam(const char* id, PrimordialType type, SymEntry* cType, Parameter* prev);
 DbLnkList* MakeDbLnkList(void* val, DbLnkList* prev, DbLnkList* next);
 SymEntry* GetMember(SymEntry* structDef, const char* member);
+bool ContainsLabel(ASTNode* node);
+bool IsVariableLengthArray(ASTNode* node);
+bool ContainsDynamicAllocation(ASTNode* node, bool arrays);
+const char* VariableLengthSizeName(const char* id);
+bool IsAtomicBuiltin(ASTNode* node);
+bool IsPureBuiltin(ASTNode* node);
+MemoryOrder GetAtomicOrder(ASTNode* node);
 
 
 #define NodeTypesCompatible(lhs, rhs) CheckTypeCompatibility(lhs->type, rhs->type)